@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Standalone benchmark of mob spatial index, see bench/main.cpp
+#
+#-------------------------------------------------
+
+# CSpatialIndex is built against stub node.h of this folder (it goes first in INCLUDEPATH), so no GL context, game resources or mob are needed
+QT       += core gui
+
+TARGET = ei_maper-bench
+TEMPLATE = app
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += . ..
+
+SOURCES += \
+    main.cpp \
+    ../mob/spatial_index.cpp \
+    ../math_utils.cpp
+
+HEADERS += \
+    node.h \
+    ../mob/spatial_index.h \
+    ../math_utils.h
@@ -0,0 +1,236 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector2D>
+#include <algorithm>
+#include <functional>
+
+#include "node.h"
+#include "mob/spatial_index.h"
+#include "math_utils.h"
+
+QVector3D util::getMinValue(const QVector3D& vec1, const QVector3D& vec2)
+{
+    return QVector3D(qMin(vec1.x(), vec2.x()), qMin(vec1.y(), vec2.y()), qMin(vec1.z(), vec2.z()));
+}
+
+QVector3D util::getMaxValue(const QVector3D& vec1, const QVector3D& vec2)
+{
+    return QVector3D(qMax(vec1.x(), vec2.x()), qMax(vec1.y(), vec2.y()), qMax(vec1.z(), vec2.z()));
+}
+
+struct SBox
+{
+    CNode* pNode;
+    QVector3D minPos;
+    QVector3D maxPos;
+};
+
+// the same world boxes as the index builds, for linear scans
+static QVector<SBox> collectBoxes(const QList<CNode*>& arrNode)
+{
+    QVector<SBox> arrBox;
+    arrBox.reserve(arrNode.size());
+    for(auto& pNode : arrNode)
+    {
+        const CBox box = pNode->getBBox();
+        arrBox.append(SBox{pNode, pNode->drawPosition() + box.minPos(), pNode->drawPosition() + box.maxPos()});
+    }
+    return arrBox;
+}
+
+static bool isSame(QVector<CNode*> arrA, QVector<CNode*> arrB)
+{
+    std::sort(arrA.begin(), arrA.end());
+    std::sort(arrB.begin(), arrB.end());
+    return arrA == arrB;
+}
+
+static QVector<CNode*> nodesOfRay(const QVector<QPair<float, CNode*>>& arrHit)
+{
+    QVector<CNode*> arrNode;
+    for(auto& hit : arrHit)
+        arrNode.append(hit.second);
+    return arrNode;
+}
+
+// Runs every query by index and by linear scan of all boxes, prints time of both and checks that results are the same
+class CBench
+{
+public:
+    CBench(QTextStream& out): m_out(out), m_bOk(true) {}
+    bool isOk() const {return m_bOk;}
+
+    template<typename TIndexQuery, typename TLinearQuery>
+    void compare(const QString& name, int nQuery, TIndexQuery indexQuery, TLinearQuery linearQuery)
+    {
+        QVector<QVector<CNode*>> arrIndexResult(nQuery);
+        QVector<QVector<CNode*>> arrLinearResult(nQuery);
+        QElapsedTimer timer;
+        timer.start();
+        for(int i(0); i<nQuery; ++i)
+            arrIndexResult[i] = indexQuery(i);
+        const qint64 indexTime = timer.nsecsElapsed();
+        timer.restart();
+        for(int i(0); i<nQuery; ++i)
+            arrLinearResult[i] = linearQuery(i);
+        const qint64 linearTime = timer.nsecsElapsed();
+
+        int nFound(0);
+        for(int i(0); i<nQuery; ++i)
+        {
+            nFound += arrIndexResult[i].size();
+            if(!isSame(arrIndexResult[i], arrLinearResult[i]))
+            {
+                m_out << name << ": query " << i << " differs from linear scan" << endl;
+                m_bOk = false;
+                break;
+            }
+        }
+        m_out << QString("%1 x%2: index %3 us, linear %4 us, found %5 per query")
+                 .arg(name, -8).arg(nQuery).arg(indexTime/1000/nQuery).arg(linearTime/1000/nQuery).arg(double(nFound)/nQuery, 0, 'f', 1) << endl;
+    }
+
+    void time(const QString& name, const std::function<void()>& func)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        func();
+        m_out << QString("%1: %2 us").arg(name, -8).arg(timer.nsecsElapsed()/1000) << endl;
+    }
+
+private:
+    QTextStream& m_out;
+    bool m_bOk;
+};
+
+// Nodes are random boxes on map of sectors, as mob objects are. Returns 0 if all index queries give the same nodes as linear scan
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ei_maper-bench");
+
+    QCommandLineParser cmd;
+    cmd.setApplicationDescription("Benchmark of mob spatial index against linear scan of nodes");
+    cmd.addHelpOption();
+    QCommandLineOption nodeOption("nodes", "count of nodes, 20000 by default", "count");
+    QCommandLineOption sectorOption("sectors", "map size in sectors, 64 by default", "count");
+    QCommandLineOption seedOption("seed", "seed of random nodes and queries", "number");
+    cmd.addOption(nodeOption);
+    cmd.addOption(sectorOption);
+    cmd.addOption(seedOption);
+    cmd.process(app);
+
+    const int nNode = cmd.isSet(nodeOption) ? cmd.value(nodeOption).toInt() : 20000;
+    const int nSector = cmd.isSet(sectorOption) ? cmd.value(sectorOption).toInt() : 64;
+    const float mapSize = nSector * 32.0f;
+    QRandomGenerator random(cmd.isSet(seedOption) ? cmd.value(seedOption).toUInt() : 1);
+    const auto randomFloat = [&random](float min, float max) {return min + float(random.generateDouble()) * (max - min);};
+
+    QTextStream out(stdout);
+    out << QString("%1 nodes on %2x%2 sectors").arg(nNode).arg(nSector) << endl;
+
+    QList<CNode*> arrNode;
+    for(int i(0); i<nNode; ++i)
+    {
+        // most of objects are small, some are trees and buildings
+        const float halfSize = random.bounded(10) == 0 ? randomFloat(4.0f, 16.0f) : randomFloat(0.5f, 2.0f);
+        const QVector3D pos(randomFloat(0.0f, mapSize), randomFloat(0.0f, mapSize), randomFloat(0.0f, 30.0f));
+        arrNode.append(new CNode(pos, QVector3D(halfSize, halfSize, randomFloat(0.5f, 2.0f) * halfSize)));
+    }
+
+    CBench bench(out);
+    CSpatialIndex index;
+    bench.time("build", [&](){index.refresh(arrNode);});
+    bench.time("refresh unchanged", [&](){index.refresh(arrNode);});
+    for(int i(0); i<nNode/100; ++i)
+    {
+        CNode* pNode = arrNode[random.bounded(nNode)];
+        pNode->setDrawPosition(pNode->drawPosition() + QVector3D(randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f), 0.0f));
+    }
+    bench.time("refresh 1% moved", [&](){index.refresh(arrNode);});
+    const QVector<SBox> arrBox = collectBoxes(arrNode);
+
+    // rays from camera above the map to random ground points, as picking casts them
+    const int nRay = 1000;
+    QVector<QVector3D> arrOrigin, arrDir;
+    for(int i(0); i<nRay; ++i)
+    {
+        const QVector3D target(randomFloat(0.0f, mapSize), randomFloat(0.0f, mapSize), 0.0f);
+        const QVector3D origin = target + QVector3D(randomFloat(-50.0f, 50.0f), randomFloat(-50.0f, 50.0f), randomFloat(30.0f, 100.0f));
+        arrOrigin.append(origin);
+        arrDir.append(target - origin);
+    }
+    bench.compare("ray", nRay, [&](int i){return nodesOfRay(index.queryRay(arrOrigin[i], arrDir[i]));}, [&](int i)
+    {
+        QVector<CNode*> arrResult;
+        float dist(0.0f);
+        for(auto& box : arrBox)
+            if(util::rayToBox(dist, arrOrigin[i], arrDir[i], box.minPos, box.maxPos))
+                arrResult.append(box.pNode);
+        return arrResult;
+    });
+
+    // frame selection and circle filter sizes
+    const int nArea = 1000;
+    QVector<QVector3D> arrMin, arrMax;
+    QVector<QVector2D> arrCenter;
+    QVector<float> arrRadius;
+    for(int i(0); i<nArea; ++i)
+    {
+        const QVector3D center(randomFloat(0.0f, mapSize), randomFloat(0.0f, mapSize), 0.0f);
+        const QVector3D halfSize(randomFloat(5.0f, 60.0f), randomFloat(5.0f, 60.0f), 100.0f);
+        arrMin.append(center - halfSize);
+        arrMax.append(center + halfSize);
+        arrCenter.append(center.toVector2D());
+        arrRadius.append(randomFloat(5.0f, 60.0f));
+    }
+    bench.compare("box", nArea, [&](int i){return index.queryBox(arrMin[i], arrMax[i]);}, [&](int i)
+    {
+        QVector<CNode*> arrResult;
+        for(auto& box : arrBox)
+            if(box.minPos.x() <= arrMax[i].x() && box.maxPos.x() >= arrMin[i].x()
+                    && box.minPos.y() <= arrMax[i].y() && box.maxPos.y() >= arrMin[i].y()
+                    && box.minPos.z() <= arrMax[i].z() && box.maxPos.z() >= arrMin[i].z())
+                arrResult.append(box.pNode);
+        return arrResult;
+    });
+    bench.compare("circle", nArea, [&](int i){return index.queryCircle(arrCenter[i], arrRadius[i]);}, [&](int i)
+    {
+        QVector<CNode*> arrResult;
+        for(auto& box : arrBox)
+        {
+            const float dx = qMax(qMax(box.minPos.x() - arrCenter[i].x(), 0.0f), arrCenter[i].x() - box.maxPos.x());
+            const float dy = qMax(qMax(box.minPos.y() - arrCenter[i].y(), 0.0f), arrCenter[i].y() - box.maxPos.y());
+            if(dx*dx + dy*dy <= arrRadius[i]*arrRadius[i])
+                arrResult.append(box.pNode);
+        }
+        return arrResult;
+    });
+
+    // editor camera views: perspective looking down at random point
+    const int nFrustum = 200;
+    QVector<QMatrix4x4> arrViewProj;
+    for(int i(0); i<nFrustum; ++i)
+    {
+        const QVector3D target(randomFloat(0.0f, mapSize), randomFloat(0.0f, mapSize), 0.0f);
+        QMatrix4x4 viewProj;
+        viewProj.perspective(45.0f, 16.0f/9.0f, 1.0f, 400.0f);
+        viewProj.lookAt(target + QVector3D(0.0f, -60.0f, 80.0f), target, QVector3D(0.0f, 0.0f, 1.0f));
+        arrViewProj.append(viewProj);
+    }
+    bench.compare("frustum", nFrustum, [&](int i){return index.queryFrustum(arrViewProj[i]);}, [&](int i)
+    {
+        const util::CFrustum frustum(arrViewProj[i]);
+        QVector<CNode*> arrResult;
+        for(auto& box : arrBox)
+            if(frustum.isBoxVisible(box.minPos, box.maxPos))
+                arrResult.append(box.pNode);
+        return arrResult;
+    });
+
+    qDeleteAll(arrNode);
+    return bench.isOk() ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+#ifndef NODE_H
+#define NODE_H
+
+#include <QQuaternion>
+#include <QString>
+#include <QVector3D>
+
+// Stub of editor node for ei_maper-bench. It has only what CSpatialIndex reads, editor node.h needs GL and game resources
+
+class CBox
+{
+public:
+    CBox(const QVector3D& minPos, const QVector3D& maxPos): m_minPos(minPos), m_maxPos(maxPos) {}
+    const QVector3D& minPos() const {return m_minPos;}
+    const QVector3D& maxPos() const {return m_maxPos;}
+
+private:
+    QVector3D m_minPos;
+    QVector3D m_maxPos;
+};
+
+namespace util
+{
+QVector3D getMinValue(const QVector3D& vec1, const QVector3D& vec2);
+QVector3D getMaxValue(const QVector3D& vec1, const QVector3D& vec2);
+}
+
+///
+/// \brief The CNode class is box of model at draw position. Box is already rotated, as CObjectBase::getBBox returns it
+///
+class CNode
+{
+public:
+    CNode(const QVector3D& pos, const QVector3D& halfSize): m_drawPosition(pos), m_localMin(-halfSize), m_localMax(halfSize), m_revision(1) {}
+    uint revision() {return m_revision;}
+    QVector3D& drawPosition() {return m_drawPosition;}
+    void setDrawPosition(const QVector3D& pos) {m_drawPosition = pos;}
+    const QQuaternion& rotation() {return m_rotation;}
+    const QVector3D& constitution() {return m_constitution;}
+    QString& modelName() {return m_modelName;}
+    CBox getBBox() {return CBox(m_localMin, m_localMax);}
+
+private:
+    QVector3D m_drawPosition;
+    QVector3D m_localMin;
+    QVector3D m_localMax;
+    QQuaternion m_rotation;
+    QVector3D m_constitution;
+    QString m_modelName;
+    uint m_revision;
+};
+
+#endif // NODE_H
@@ -0,0 +1,393 @@
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QtEndian>
+#include <QtConcurrent/QtConcurrent>
+#include <stdexcept>
+
+#include "batch.h"
+#include "mob_tree.h"
+#include "mob/mob_parser.h"
+#include "mpr_data.h"
+#include "res_file.h"
+
+static QString objectTypeName(uint tag)
+{
+    switch (tag) {
+    case util::eTagObject: return "world objects";
+    case util::eTagUnit: return "units";
+    case util::eTagLever: return "levers";
+    case util::eTagTorch: return "torches";
+    case util::eTagMagicTrap: return "magic traps";
+    case util::eTagLight: return "lights";
+    case util::eTagSound: return "sounds";
+    case util::eTagParticl: return "particles";
+    default: return QString();
+    }
+}
+
+// Walks over all records of tree. Objects can be nested (unit contains object record), so the whole tree is visited
+static void collectObjects(const SMobTreeNode& node, SBatchResult& result, QMap<uint, int>& aIdCount)
+{
+    for(const auto& child : node.arrChild)
+    {
+        if(child.tag == util::eTagNid && child.data.size() == 4)
+            ++aIdCount[qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(child.data.constData()))];
+
+        if(!CMobTree::isRecord(child.tag))
+            continue;
+
+        const QString typeName = objectTypeName(child.tag);
+        if(!typeName.isEmpty())
+            ++result.aObjectCount[typeName];
+
+        collectObjects(child, result, aIdCount);
+    }
+}
+
+// Script is key and encrypted text. Block cipher of CMobParser is compared with the bytewise one on real scripts
+static void checkScripts(const SMobTreeNode& node, SBatchResult& result)
+{
+    for(const auto& child : node.arrChild)
+    {
+        if(child.tag == util::eTagSsText && child.data.size() >= 4)
+        {
+            const uint key = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(child.data.constData()));
+            if(!util::CMobParser::isScriptCipherValid(child.data.mid(4), key))
+                result.arrWarning.append(QString("script cipher round-trip failed (%1 bytes)").arg(child.data.size() - 4));
+        }
+        else if(CMobTree::isRecord(child.tag))
+            checkScripts(child, result);
+    }
+}
+
+// Prototype is decoded and encoded back in game codepage, other strings of file stay raw bytes
+static int renameUnits(SMobTreeNode& node, const QMap<QString, QString>& mapName, SBatchResult& result)
+{
+    int renamed(0);
+    for(auto& child : node.arrChild)
+    {
+        if(child.tag == util::eTagUnitPrototype)
+        {
+            const QString name = CMobTree::decodeText(child.data);
+            if(mapName.contains(name))
+            {
+                child.data = CMobTree::encodeText(mapName[name]);
+                ++renamed;
+            }
+            else
+                result.arrWarning.append("not found: " + name);
+        }
+        else if(CMobTree::isRecord(child.tag))
+            renamed += renameUnits(child, mapName, result);
+    }
+    return renamed;
+}
+
+CBatch::CBatch(const SBatchOptions& options):
+    m_options(options)
+{
+}
+
+QList<SBatchResult> CBatch::run()
+{
+    QStringList arrFile;
+    QStringList arrFilter("*.mob");
+    if(m_options.command == eBatchValidate || m_options.command == eBatchStats)
+        arrFilter << "*.mpr";
+
+    QDirIterator it(m_options.rootDir, arrFilter, QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+        arrFile.append(it.next());
+
+    arrFile.sort();
+    return QtConcurrent::blockingMapped<QList<SBatchResult>>(arrFile, [this](const QString& filePath){return processFile(filePath);});
+}
+
+SBatchResult CBatch::processFile(const QString& filePath) const
+{
+    SBatchResult result;
+    result.filePath = filePath;
+    if(filePath.endsWith(".mpr", Qt::CaseInsensitive))
+        processMpr(filePath, result);
+    else
+        processMob(filePath, result);
+
+    return result;
+}
+
+void CBatch::processMob(const QString& filePath, SBatchResult& result) const
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        result.bOk = false;
+        result.error = file.errorString();
+        return;
+    }
+
+    // tree copies all data it keeps, so file mapping is released right after reading
+    result.size = file.size();
+    CMobTree tree;
+    QByteArray input;
+    uchar* pMap = file.size() > 0 ? file.map(0, file.size()) : nullptr;
+    if(pMap)
+        input = QByteArray::fromRawData(reinterpret_cast<const char*>(pMap), int(file.size()));
+    else
+        input = file.readAll();
+
+    result.bOk = tree.read(input, result.error);
+    // resaved file is the same as editor saves it: strings are re-encoded and lengths are recalculated by CMobParser.
+    // Validation compares it with the file to check two-pass writer on real data
+    QByteArray output;
+    if(result.bOk && (m_options.command == eBatchResave || m_options.command == eBatchValidate))
+        output = tree.write();
+    const bool bSameOutput = output == input;
+    int diffPos(-1);
+    if(!bSameOutput && m_options.command == eBatchValidate)
+    {
+        diffPos = qMin(output.size(), input.size());
+        for(int i(0); i < diffPos; ++i)
+            if(output[i] != input[i])
+            {
+                diffPos = i;
+                break;
+            }
+    }
+    if(pMap)
+        file.unmap(pMap);
+    file.close();
+
+    if(!result.bOk)
+        return;
+
+    switch (m_options.command) {
+    case eBatchValidate:
+    case eBatchStats:
+    {
+        QMap<uint, int> aIdCount;
+        collectObjects(tree.root(), result, aIdCount);
+        if(m_options.command == eBatchStats)
+            break;
+
+        for(auto it = aIdCount.constBegin(); it != aIdCount.constEnd(); ++it)
+            if(it.value() > 1)
+                result.arrWarning.append(QString("duplicated id %1 (%2 objects)").arg(it.key()).arg(it.value()));
+
+        if(tree.root().arrChild.size() != 1 || tree.root().arrChild.first().tag != util::eTagObjectDbFile)
+            result.arrWarning.append("file must contain single OBJECT_DB_FILE node");
+
+        checkScripts(tree.root(), result);
+        if(diffPos >= 0)
+            result.arrWarning.append(QString("written data differs from file at byte %1 (file %2 bytes, written %3)").arg(diffPos).arg(input.size()).arg(output.size()));
+
+        break;
+    }
+    case eBatchRename:
+    {
+        result.renamed = renameUnits(tree.root(), m_options.mapName, result);
+        if(result.renamed > 0)
+            saveFile(filePath, tree.write(), result);
+
+        break;
+    }
+    case eBatchResave:
+    {
+        if(!bSameOutput)
+            saveFile(filePath, output, result);
+
+        break;
+    }
+    case eBatchJson:
+    {
+        const QString relPath = QDir(m_options.rootDir).relativeFilePath(filePath);
+        const QFileInfo jsonFile(QDir(m_options.outDir).filePath(relPath + ".json"));
+        if(!QDir().mkpath(jsonFile.absolutePath()))
+        {
+            result.bOk = false;
+            result.error = "cannot create folder " + jsonFile.absolutePath();
+            break;
+        }
+        saveFile(jsonFile.absoluteFilePath(), QJsonDocument(tree.toJson()).toJson(QJsonDocument::Compact), result);
+        break;
+    }
+    }
+}
+
+// Checks *.mpr by the same header and sector codec as CLandscape reads it. Every sector is packed back and compared with the read one
+void CBatch::processMpr(const QString& filePath, SBatchResult& result) const
+{
+    result.size = QFileInfo(filePath).size();
+    QMap<QString, QByteArray> aComponent;
+    try
+    {
+        CResFile map(filePath);
+        for (auto& file: map.bufferOfFiles().toStdMap())
+            aComponent.insert(file.first.toLower(), file.second);
+    }
+    catch (std::runtime_error* pError)
+    {
+        result.bOk = false;
+        result.error = pError->what();
+        delete pError;
+        return;
+    }
+
+    QString mapName;
+    for(auto it = aComponent.constBegin(); it != aComponent.constEnd(); ++it)
+        if(it.key().endsWith(".mp"))
+            mapName = it.key().left(it.key().length() - 3);
+
+    if(mapName.isEmpty())
+    {
+        result.bOk = false;
+        result.error = "no *.mp inside (not a *.res file or it's empty)";
+        return;
+    }
+
+    QDataStream mpStream(aComponent[mapName + ".mp"]);
+    util::formatStream(mpStream);
+    SMapHeader header;
+    mpStream >> header;
+    if(header.signature != SMapHeader::s_signature)
+    {
+        result.bOk = false;
+        result.error = "incorrect landscape signature";
+        return;
+    }
+
+    SMaterial mat;
+    for(uint i(0); i<header.nMaterial; ++i)
+        mpStream >> mat;
+
+    int type;
+    for(uint i(0); i<header.nTile; ++i)
+    {
+        mpStream >> type;
+        if(type > 15 || type < 0)
+            result.arrWarning.append(QString("incorrect tile type at index: %1").arg(i));
+    }
+
+    SAnimTile animTile;
+    for(uint i(0); i<header.nAnimTile; ++i)
+        mpStream >> animTile;
+
+    if(mpStream.status() != QDataStream::Ok)
+    {
+        result.bOk = false;
+        result.error = "truncated *.mp data";
+        return;
+    }
+
+    result.aObjectCount["sectors"] += int(header.nXSector*header.nYSector);
+    for (uint y(0); y<header.nYSector; ++y)
+        for (uint x(0); x<header.nXSector; ++x)
+        {
+            const QString secName = mapName + genSectorSuffix(int(x), int(y)) + ".sec";
+            const QString secText = QString("sector (%1,%2)").arg(x).arg(y);
+            if(!aComponent.contains(secName))
+            {
+                result.arrWarning.append(secText + " is missing");
+                continue;
+            }
+
+            const QByteArray secData = aComponent.take(secName);
+            SSecData sec;
+            QDataStream secStream(secData);
+            util::formatStream(secStream);
+            if(!SSecData::isSecData(secData) || !sec.read(secStream))
+            {
+                result.arrWarning.append(secText + " has incorrect signature");
+                continue;
+            }
+
+            if(sec.bWater)
+                ++result.aObjectCount["water sectors"];
+
+            if(m_options.command == eBatchStats)
+                continue;
+
+            if(secData.size() != SSecData::dataSize(sec.bWater))
+            {
+                result.arrWarning.append(QString("%1 has wrong size %2, expected %3").arg(secText).arg(secData.size()).arg(SSecData::dataSize(sec.bWater)));
+                continue;
+            }
+
+            // the same bounds as CTile::tileIndex clamps
+            auto checkTiles = [&](const QVector<ushort>& arrTile, const QString& layer)
+            {
+                for(int i(0); i<arrTile.size(); ++i)
+                    if(uint((arrTile[i] >> 6) & 255) >= header.nTexture)
+                    {
+                        result.arrWarning.append(QString("%1 %2 tile %3 uses texture %4 of %5").arg(secText, layer).arg(i).arg((arrTile[i] >> 6) & 255).arg(header.nTexture));
+                        break;
+                    }
+            };
+            checkTiles(sec.arrLandTilePacked, "land");
+            if(sec.bWater)
+                checkTiles(sec.arrWaterTilePacked, "water");
+
+            const QByteArray packedData = sec.write();
+            if(packedData != secData)
+            {
+                int diff(0);
+                while(diff < packedData.size() && packedData[diff] == secData[diff])
+                    ++diff;
+                result.arrWarning.append(QString("%1 is not saved byte-exact, first difference at byte %2").arg(secText).arg(diff));
+            }
+        }
+}
+
+bool CBatch::saveFile(const QString& filePath, const QByteArray& data, SBatchResult& result) const
+{
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+    {
+        result.bOk = false;
+        result.error = file.errorString();
+        return false;
+    }
+    result.bWritten = true;
+    return true;
+}
+
+QString CBatch::report(const QList<SBatchResult>& arrResult)
+{
+    QString text;
+    QMap<QString, int> aTotalCount;
+    int nFailed(0), nWarning(0), nWritten(0), nRenamed(0);
+    qint64 totalSize(0);
+    for(const auto& result : arrResult)
+    {
+        totalSize += result.size;
+        nRenamed += result.renamed;
+        if(result.bWritten)
+            ++nWritten;
+
+        for(auto it = result.aObjectCount.constBegin(); it != result.aObjectCount.constEnd(); ++it)
+            aTotalCount[it.key()] += it.value();
+
+        if(!result.bOk)
+        {
+            ++nFailed;
+            text += QString("%1: error: %2\n").arg(result.filePath, result.error);
+        }
+        for(const auto& warning : result.arrWarning)
+        {
+            ++nWarning;
+            text += QString("%1: warning: %2\n").arg(result.filePath, warning);
+        }
+    }
+
+    text += QString("files: %1, size: %2 bytes, failed: %3, warnings: %4, written: %5\n").arg(arrResult.size()).arg(totalSize).arg(nFailed).arg(nWarning).arg(nWritten);
+    if(nRenamed > 0)
+        text += QString("renamed units: %1\n").arg(nRenamed);
+
+    for(auto it = aTotalCount.constBegin(); it != aTotalCount.constEnd(); ++it)
+        text += QString("%1: %2\n").arg(it.key()).arg(it.value());
+
+    return text;
+}
@@ -0,0 +1,57 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+
+enum EBatchCommand
+{
+    eBatchValidate = 0 // check node lengths, duplicated object ids and rewrite of file, *.mpr header and sectors
+    ,eBatchStats // count objects by type and sectors of *.mpr
+    ,eBatchRename // replace unit prototypes by name map and save changed files
+    ,eBatchResave // write files back the same way as editor saves them
+    ,eBatchJson // export node tree of each file to json
+};
+
+struct SBatchOptions
+{
+    EBatchCommand command;
+    QString rootDir; // processed folder, json files keep paths relative to it
+    QString outDir; // folder for json export
+    QMap<QString, QString> mapName; // old unit prototype -> new one
+};
+
+struct SBatchResult
+{
+    QString filePath;
+    bool bOk = true;
+    QString error;
+    QStringList arrWarning;
+    QMap<QString, int> aObjectCount; // object type -> count
+    int renamed = 0;
+    qint64 size = 0;
+    bool bWritten = false;
+};
+
+///
+/// \brief The CBatch class runs one command for all *.mob (and *.mpr for validate and stats) files of folder tree. Files are independent and processed on global thread pool
+///
+class CBatch
+{
+public:
+    CBatch(const SBatchOptions& options);
+    QList<SBatchResult> run();
+    static QString report(const QList<SBatchResult>& arrResult);
+
+private:
+    SBatchResult processFile(const QString& filePath) const;
+    void processMob(const QString& filePath, SBatchResult& result) const;
+    void processMpr(const QString& filePath, SBatchResult& result) const;
+    bool saveFile(const QString& filePath, const QByteArray& data, SBatchResult& result) const;
+
+private:
+    SBatchOptions m_options;
+};
+
+#endif // BATCH_H
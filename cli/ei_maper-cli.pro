@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Headless batch tool for *.mob and *.mpr files, see cli/main.cpp
+#
+#-------------------------------------------------
+
+# parser and sector codec are shared with the editor. gui module is linked for QVector types of shared headers only, no window or GL context is created
+QT       += core gui concurrent
+
+TARGET = ei_maper-cli
+TEMPLATE = app
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    batch.cpp \
+    mob_tree.cpp \
+    ../mob/mob_parser.cpp \
+    ../mpr_data.cpp \
+    ../res_file.cpp \
+    ../log.cpp
+
+HEADERS += \
+    batch.h \
+    mob_tree.h \
+    ../mob/mob_parser.h \
+    ../mpr_data.h \
+    ../res_file.h \
+    ../log.h
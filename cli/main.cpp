@@ -0,0 +1,92 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include "batch.h"
+
+// Headless batch tool for *.mob and *.mpr files. It uses the editor's *.mob parser (see CMobTree) and sector codec, but doesn't need GL or game resources
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ei_maper-cli");
+
+    QCommandLineParser cmd;
+    cmd.setApplicationDescription("Batch processing of *.mob and *.mpr files in folder tree");
+    cmd.addHelpOption();
+    cmd.addPositionalArgument("command", "validate, stats, rename, resave or json");
+    cmd.addPositionalArgument("folder", "folder with *.mob files (and *.mpr for validate and stats), subfolders are processed too");
+    QCommandLineOption mapOption("map", "file with unit renaming lines 'old;new' for rename command", "file");
+    QCommandLineOption outOption("out", "output folder for json command", "folder");
+    QCommandLineOption jobsOption("jobs", "number of threads, all cores by default", "count");
+    cmd.addOption(mapOption);
+    cmd.addOption(outOption);
+    cmd.addOption(jobsOption);
+    cmd.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QStringList arrArg = cmd.positionalArguments();
+    if(arrArg.size() != 2)
+        cmd.showHelp(1);
+
+    const QMap<QString, EBatchCommand> aCommand{
+        {"validate", eBatchValidate}
+        ,{"stats", eBatchStats}
+        ,{"rename", eBatchRename}
+        ,{"resave", eBatchResave}
+        ,{"json", eBatchJson}};
+
+    if(!aCommand.contains(arrArg[0]))
+    {
+        err << "unknown command: " << arrArg[0] << endl;
+        return 1;
+    }
+
+    SBatchOptions options;
+    options.command = aCommand[arrArg[0]];
+    options.rootDir = arrArg[1];
+    if(options.command == eBatchRename)
+    {
+        // the same format as used by MainWindow::testFunc1
+        QFile mapFile(cmd.value(mapOption));
+        if(!mapFile.open(QIODevice::ReadOnly))
+        {
+            err << "cannot open name map: " << mapFile.fileName() << endl;
+            return 1;
+        }
+        QTextStream in(&mapFile);
+        while(!in.atEnd())
+        {
+            const QStringList list = in.readLine().split(";");
+            if(list.size() >= 2)
+                options.mapName.insert(list[0], list[1]);
+        }
+    }
+    if(options.command == eBatchJson)
+    {
+        options.outDir = cmd.value(outOption);
+        if(options.outDir.isEmpty())
+        {
+            err << "json command needs --out folder" << endl;
+            return 1;
+        }
+    }
+    if(cmd.isSet(jobsOption) && cmd.value(jobsOption).toInt() > 0)
+        QThreadPool::globalInstance()->setMaxThreadCount(cmd.value(jobsOption).toInt());
+
+    QElapsedTimer timer;
+    timer.start();
+    CBatch batch(options);
+    const QList<SBatchResult> arrResult = batch.run();
+    out << CBatch::report(arrResult);
+    out << "time: " << timer.elapsed() << " ms" << endl;
+
+    for(const auto& result : arrResult)
+        if(!result.bOk)
+            return 2;
+
+    return 0;
+}
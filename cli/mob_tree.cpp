@@ -0,0 +1,189 @@
+#include <QBuffer>
+#include <QJsonArray>
+#include <QTextCodec>
+#include <QtEndian>
+
+#include "mob_tree.h"
+#include "mob/mob_parser.h"
+#include "log.h"
+
+CMobTree::CMobTree()
+{
+    m_root.tag = util::eTagRoot;
+}
+
+bool CMobTree::isRecord(uint tag)
+{
+    return util::CMobParser::tagType(tag) == util::eRecord;
+}
+
+// Game texts are in Windows-1251, the same codepage as editor uses for scripts and resources
+QString CMobTree::decodeText(const QByteArray& data)
+{
+    return QTextCodec::codecForName("Windows-1251")->toUnicode(data);
+}
+
+QByteArray CMobTree::encodeText(const QString& text)
+{
+    return QTextCodec::codecForName("Windows-1251")->fromUnicode(text);
+}
+
+// String array is count and string nodes (tag, length with header, text)
+bool CMobTree::splitStringArray(const QByteArray& data, QList<QByteArray>& arrText)
+{
+    if(data.size() < 4)
+        return false;
+
+    const uchar* pData = reinterpret_cast<const uchar*>(data.constData());
+    const uint count = qFromLittleEndian<quint32>(pData);
+    int pos(4);
+    for(uint i(0); i<count; ++i)
+    {
+        if(data.size() - pos < 8)
+            return false;
+
+        const uint len = qFromLittleEndian<quint32>(pData + pos + 4);
+        if(len < 8 || len > uint(data.size() - pos))
+            return false;
+
+        arrText.append(data.mid(pos + 8, int(len) - 8));
+        pos += int(len);
+    }
+    return pos == data.size();
+}
+
+bool CMobTree::read(QByteArray& data, QString& error)
+{
+    m_root.arrChild.clear();
+    util::CMobParser parser(data);
+    return readNodes(parser, data.size(), m_root.arrChild, error);
+}
+
+// Every node length is checked against its parent before going inside, so broken file is reported instead of read out of data.
+// Strings are kept as raw bytes, so unchanged file is written back byte to byte whatever codepage its texts are in
+bool CMobTree::readNodes(util::CMobParser& parser, qint64 end, QVector<SMobTreeNode>& arrNode, QString& error)
+{
+    while(parser.pos() < end)
+    {
+        const qint64 offset = parser.pos();
+        SMobTreeNode node;
+        node.tag = parser.peekTag();
+        if(end - offset < 8 || !parser.isNextNodeInBounds())
+        {
+            error = QString("truncated node %1 at %2").arg(node.tag).arg(offset);
+            return false;
+        }
+
+        parser.readHeader();
+        const qint64 nodeEnd = offset + 8 + parser.nodeLen();
+        if(nodeEnd > end)
+        {
+            error = QString("node %1 at %2 has wrong length %3").arg(node.tag).arg(offset).arg(parser.nodeLen() + 8);
+            return false;
+        }
+
+        switch (util::CMobParser::tagType(node.tag)) {
+        case util::eRecord:
+        {
+            if(!readNodes(parser, nodeEnd, node.arrChild, error))
+                return false;
+            break;
+        }
+        case util::eStringArray:
+        {
+            QList<QByteArray> arrText;
+            parser.readByteArray(node.data, parser.nodeLen());
+            if(!splitStringArray(node.data, arrText))
+            {
+                error = QString("string array %1 at %2 has wrong data").arg(node.tag).arg(offset);
+                return false;
+            }
+            break;
+        }
+        default:
+        {
+            parser.readByteArray(node.data, parser.nodeLen());
+            break;
+        }
+        }
+
+        if(parser.pos() != nodeEnd)
+        {
+            error = QString("node %1 at %2 has wrong data length").arg(node.tag).arg(offset);
+            return false;
+        }
+        arrNode.append(node);
+    }
+    return true;
+}
+
+void CMobTree::writeNodes(util::CMobParser& parser, const QVector<SMobTreeNode>& arrNode)
+{
+    for(const auto& node : arrNode)
+    {
+        parser.startSection(node.tag);
+        switch (util::CMobParser::tagType(node.tag)) {
+        case util::eRecord:
+            writeNodes(parser, node.arrChild);
+            break;
+        default:
+            parser.writeByteArray(node.data, uint(node.data.size()));
+            break;
+        }
+        parser.endSection();
+    }
+}
+
+// Two passes over the tree, the same as CMob::serializeMob does: sizes of sections, then data
+QByteArray CMobTree::write() const
+{
+    QByteArray out;
+    QBuffer buffer(&out);
+    buffer.open(QIODevice::WriteOnly);
+    util::CMobParser parser(&buffer);
+    writeNodes(parser, m_root.arrChild);
+    parser.startWritePass();
+    writeNodes(parser, m_root.arrChild);
+    if(!parser.finishWritePass())
+        ei::log(eLogWarning, "Mob tree is written with wrong section sizes");
+    buffer.close();
+    return out;
+}
+
+QJsonObject CMobTree::nodeToJson(const SMobTreeNode& node)
+{
+    QJsonObject obj;
+    obj.insert("tag", double(node.tag));
+    switch (util::CMobParser::tagType(node.tag)) {
+    case util::eRecord:
+    {
+        QJsonArray arrChild;
+        for(const auto& child : node.arrChild)
+            arrChild.append(nodeToJson(child));
+        obj.insert("nodes", arrChild);
+        break;
+    }
+    case util::eString:
+        obj.insert("text", decodeText(node.data));
+        break;
+    case util::eStringArray:
+    {
+        QList<QByteArray> arrText;
+        QJsonArray arrJson;
+        splitStringArray(node.data, arrText);
+        for(const auto& text : arrText)
+            arrJson.append(decodeText(text));
+        obj.insert("texts", arrJson);
+        break;
+    }
+    default:
+        obj.insert("data", QString::fromLatin1(node.data.toBase64()));
+        break;
+    }
+    return obj;
+}
+
+QJsonObject CMobTree::toJson() const
+{
+    return nodeToJson(m_root);
+}
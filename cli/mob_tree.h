@@ -0,0 +1,51 @@
+#ifndef MOB_TREE_H
+#define MOB_TREE_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+
+namespace util {
+class CMobParser;
+}
+
+///
+/// \brief The SMobTreeNode struct is a node of *.mob file: records keep their child nodes, other nodes (strings too) keep raw data
+///
+struct SMobTreeNode
+{
+    uint tag;
+    QByteArray data; // data of not record node, strings are in game codepage
+    QVector<SMobTreeNode> arrChild;
+};
+
+///
+/// \brief The CMobTree class reads *.mob file into node tree and writes it back by util::CMobParser, the same reader and writer as editor uses.
+/// It doesn't create editor objects (no figures, textures and GL), so it is used for batch processing of many files
+///
+class CMobTree
+{
+public:
+    CMobTree();
+    bool read(QByteArray& data, QString& error);
+    QByteArray write() const;
+    QJsonObject toJson() const;
+    SMobTreeNode& root() {return m_root;}
+    const SMobTreeNode& root() const {return m_root;}
+    static bool isRecord(uint tag);
+    static QString decodeText(const QByteArray& data);
+    static QByteArray encodeText(const QString& text);
+
+private:
+    bool readNodes(util::CMobParser& parser, qint64 end, QVector<SMobTreeNode>& arrNode, QString& error);
+    static void writeNodes(util::CMobParser& parser, const QVector<SMobTreeNode>& arrNode);
+    static QJsonObject nodeToJson(const SMobTreeNode& node);
+    static bool splitStringArray(const QByteArray& data, QList<QByteArray>& arrText);
+
+private:
+    SMobTreeNode m_root; // virtual ROOT node, its children are top level nodes of file
+};
+
+#endif // MOB_TREE_H
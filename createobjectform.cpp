@@ -265,7 +265,7 @@ void CCreateObjectForm::on_buttonCreate_clicked()
     m_pNode->updatePos(posOnLand);
     CLandscape::getInstance()->projectPosition(m_pNode);
 
-    CCreateNodeCommand* pUndo = new CCreateNodeCommand(m_pView, m_pNode->toJson());
+    CCreateNodeCommand* pUndo = new CCreateNodeCommand(m_pView, pMob->serializeNodes(QList<CNode*>() << m_pNode));
     QObject::connect(pUndo, SIGNAL(addNodeSignal(CNode*)), m_pView->objectTree(), SLOT(addNodeToTree(CNode*)));
     QObject::connect(pUndo, SIGNAL(undo_addNodeSignal(uint)), m_pView->objectTree(), SLOT(onNodeDelete(uint)));
     m_pUndoStack->push(pUndo);
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui opengl
+QT       += core gui opengl concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -68,14 +68,24 @@ SOURCES += \
     view.cpp \
     figure.cpp \
     res_file.cpp \
+    mpr_data.cpp \
     node.cpp \
     utils.cpp \
     landscape.cpp \
+    height_tree.cpp \
+    land_renderer.cpp \
+    tile_area.cpp \
     view_keybinding.cpp \
     camera.cpp \
     objects/worldobj.cpp \
     mob/mob_parameters.cpp \
     mob/mob.cpp \
+    mob/mob_parser.cpp \
+    mob/json_stream.cpp \
+    mob/id_allocator.cpp \
+    mob/map_id_index.cpp \
+    mob/select_query.cpp \
+    mob/spatial_index.cpp \
     mob/script_editor.cpp \
     mob/range_dialog.cpp
 
@@ -123,13 +133,23 @@ HEADERS += \
     types.h \
     vectors.h \
     res_file.h \
+    mpr_data.h \
     node.h \
     utils.h \
     landscape.h \
+    height_tree.h \
+    land_renderer.h \
+    tile_area.h \
     camera.h \
     objects/worldobj.h \
     mob/mob_parameters.h \
     mob/mob.h \
+    mob/mob_parser.h \
+    mob/json_stream.h \
+    mob/id_allocator.h \
+    mob/map_id_index.h \
+    mob/select_query.h \
+    mob/spatial_index.h \
     mob/script_editor.h \
     mob/range_dialog.h
 
@@ -0,0 +1,122 @@
+#include "height_tree.h"
+#include "math_utils.h"
+
+static const float offsetTolerance = 0.5f; // maximum x,y offset of heightfield vertex (qint8/254)
+
+CHeightTree::CHeightTree():
+    m_nCell(0)
+{
+}
+
+// Builds the tree from vertex grid. arrPos contains (nCell+1)*(nCell+1) positions row by row, nCell must be power of two
+void CHeightTree::build(const QVector<QVector3D>& arrPos, int nCell)
+{
+    Q_ASSERT(arrPos.size() == (nCell+1)*(nCell+1));
+    Q_ASSERT((nCell & (nCell-1)) == 0);
+    m_nCell = nCell;
+    m_arrPos = arrPos;
+
+    int nLevel(1);
+    for(int size(nCell); size > 1; size /= 2)
+        ++nLevel;
+    m_aLevel.clear();
+    m_aLevel.resize(nLevel);
+
+    // the last level - single cells
+    QVector<QVector2D>& arrCell = m_aLevel.last();
+    arrCell.resize(nCell*nCell);
+    const int nVertex = nCell + 1;
+    for(int y(0); y<nCell; ++y)
+        for(int x(0); x<nCell; ++x)
+        {
+            const float z0 = m_arrPos[y*nVertex + x].z();
+            const float z1 = m_arrPos[y*nVertex + x + 1].z();
+            const float z2 = m_arrPos[(y+1)*nVertex + x].z();
+            const float z3 = m_arrPos[(y+1)*nVertex + x + 1].z();
+            arrCell[y*nCell + x] = QVector2D(qMin(qMin(z0, z1), qMin(z2, z3)), qMax(qMax(z0, z1), qMax(z2, z3)));
+        }
+
+    // parent nodes cover 2x2 child nodes
+    for(int level(nLevel-2); level>=0; --level)
+    {
+        const int nNode = 1 << level;
+        const QVector<QVector2D>& arrChild = m_aLevel[level+1];
+        QVector<QVector2D>& arrNode = m_aLevel[level];
+        arrNode.resize(nNode*nNode);
+        for(int y(0); y<nNode; ++y)
+            for(int x(0); x<nNode; ++x)
+            {
+                const QVector2D& c0 = arrChild[(y*2)*nNode*2 + x*2];
+                const QVector2D& c1 = arrChild[(y*2)*nNode*2 + x*2 + 1];
+                const QVector2D& c2 = arrChild[(y*2+1)*nNode*2 + x*2];
+                const QVector2D& c3 = arrChild[(y*2+1)*nNode*2 + x*2 + 1];
+                arrNode[y*nNode + x] = QVector2D(qMin(qMin(c0.x(), c1.x()), qMin(c2.x(), c3.x()))
+                                                 ,qMax(qMax(c0.y(), c1.y()), qMax(c2.y(), c3.y())));
+            }
+    }
+}
+
+void CHeightTree::clear()
+{
+    m_nCell = 0;
+    m_arrPos.clear();
+    m_aLevel.clear();
+}
+
+// Finds the nearest intersection of ray with heightfield. t is in\out: only hits closer than input t are accepted
+bool CHeightTree::intersect(float& t, int& cellX, int& cellY, const QVector3D& origin, const QVector3D& dir) const
+{
+    if(isEmpty())
+        return false;
+
+    return intersectNode(t, cellX, cellY, origin, dir, 0, 0, 0);
+}
+
+bool CHeightTree::intersectNode(float& t, int& cellX, int& cellY, const QVector3D& origin, const QVector3D& dir, int level, int x, int y) const
+{
+    const int size = m_nCell >> level; // node size in cells
+    const QVector2D& range = m_aLevel[level][y*(1 << level) + x];
+    const QVector3D minPos(x*size - offsetTolerance, y*size - offsetTolerance, range.x());
+    const QVector3D maxPos((x+1)*size + offsetTolerance, (y+1)*size + offsetTolerance, range.y());
+    float tEnter;
+    if(!util::rayToBox(tEnter, origin, dir, minPos, maxPos) || tEnter > t)
+        return false;
+
+    if(level == m_aLevel.size()-1)
+    {
+        if(!intersectCell(t, origin, dir, x, y))
+            return false;
+        cellX = x;
+        cellY = y;
+        return true;
+    }
+
+    bool bHit = false;
+    for(int i(0); i<4; ++i)
+        bHit |= intersectNode(t, cellX, cellY, origin, dir, level+1, x*2 + i%2, y*2 + i/2);
+    return bHit;
+}
+
+// Tests two triangles of the cell, split as CTile::isProjectPoint does
+bool CHeightTree::intersectCell(float& t, const QVector3D& origin, const QVector3D& dir, int x, int y) const
+{
+    const int nVertex = m_nCell + 1;
+    QVector3D rayDir(dir);
+    QVector3D pt0(m_arrPos[y*nVertex + x]);
+    QVector3D pt1(m_arrPos[y*nVertex + x + 1]);
+    QVector3D pt3(m_arrPos[(y+1)*nVertex + x]);
+    QVector3D pt4(m_arrPos[(y+1)*nVertex + x + 1]);
+    float tHit, u, v;
+    bool bHit = false;
+    if(util::ptToTriangle(tHit, u, v, origin, rayDir, pt0, pt1, pt3) && tHit >= 0.0f && tHit < t)
+    {
+        t = tHit;
+        bHit = true;
+    }
+    if(util::ptToTriangle(tHit, u, v, origin, rayDir, pt3, pt1, pt4) && tHit >= 0.0f && tHit < t)
+    {
+        t = tHit;
+        bHit = true;
+    }
+    return bHit;
+}
@@ -0,0 +1,31 @@
+#ifndef HEIGHT_TREE_H
+#define HEIGHT_TREE_H
+
+#include <QVector>
+#include <QVector2D>
+#include <QVector3D>
+
+///
+/// \brief The CHeightTree class is a min/max height quadtree over the cells of sector heightfield. It finds ray intersection with the landscape on CPU without reading back depth buffer
+///
+class CHeightTree
+{
+public:
+    CHeightTree();
+    void build(const QVector<QVector3D>& arrPos, int nCell);
+    void clear();
+    bool isEmpty() const {return m_arrPos.isEmpty();}
+    const QVector3D& pos(int x, int y) const {return m_arrPos[y*(m_nCell+1) + x];}
+    bool intersect(float& t, int& cellX, int& cellY, const QVector3D& origin, const QVector3D& dir) const;
+
+private:
+    bool intersectNode(float& t, int& cellX, int& cellY, const QVector3D& origin, const QVector3D& dir, int level, int x, int y) const;
+    bool intersectCell(float& t, const QVector3D& origin, const QVector3D& dir, int x, int y) const;
+
+private:
+    int m_nCell; // cells by one side, power of two
+    QVector<QVector3D> m_arrPos; // (m_nCell+1)^2 vertices, row by row
+    QVector<QVector<QVector2D>> m_aLevel; // min and max height of nodes. Level 0 is the whole sector, the last level is single cells
+};
+
+#endif // HEIGHT_TREE_H
@@ -0,0 +1,380 @@
+#include <cstddef>
+#include <cstring>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+#include "land_renderer.h"
+#include "sector.h"
+#include "tile.h"
+#include "log.h"
+#include "math_utils.h"
+
+static const float lodDistance = 128.0f; // sectors farther than this distance (by view depth) are drawn with coarse mesh
+static const int tileSide = 16; // tiles count by 1 side of sector
+
+Q_STATIC_ASSERT(sizeof(STerrainVertex) == 16);
+
+CLandRenderer::SLayer::SLayer():
+    vertexBuf(QOpenGLBuffer::VertexBuffer)
+  ,indexBuf(QOpenGLBuffer::IndexBuffer)
+  ,pVaoProgram(nullptr)
+  ,slotCount(0)
+  ,tileMap(0)
+{
+}
+
+CLandRenderer::CLandRenderer():
+    m_bTileMapRG(true)
+  ,m_tileMapWidth(0)
+  ,m_tileMapHeight(0)
+  ,m_maxZ(0.0f)
+  ,m_atlasCount(1)
+  ,m_pProgram(nullptr)
+{
+    for(auto& loc: m_arrAttrLoc)
+        loc = -1;
+}
+
+CLandRenderer::~CLandRenderer()
+{
+    clear();
+}
+
+// terrain.vsh needs GLSL 3.30, older contexts use terrain_legacy.vsh. Context must be current
+bool CLandRenderer::isModernContext()
+{
+    const QOpenGLContext* pContext = QOpenGLContext::currentContext();
+    return pContext && !pContext->isOpenGLES() && pContext->format().version() >= qMakePair(3, 3);
+}
+
+void CLandRenderer::reset(const QVector<QVector<CSector*>>& aSector, float maxZ, int atlasCount)
+{
+    clear();
+    if(aSector.isEmpty())
+        return;
+
+    m_bTileMapRG = isModernContext(); // LUMINANCE_ALPHA is absent in core profile
+    m_maxZ = maxZ;
+    m_atlasCount = qMax(1, atlasCount);
+    m_tileMapWidth = aSector.first().size() * tileSide;
+    m_tileMapHeight = aSector.size() * tileSide;
+
+    QVector<const CSector*> aLand;
+    QVector<const CSector*> aWater;
+    for (auto& xSec: aSector)
+        for(auto& pSector: xSec)
+        {
+            aLand.append(pSector);
+            if(pSector->hasWater())
+                aWater.append(pSector);
+        }
+
+    initLayer(m_land, aLand, false);
+    initLayer(m_water, aWater, true);
+}
+
+void CLandRenderer::clear()
+{
+    clearLayer(m_land);
+    clearLayer(m_water);
+    m_pProgram = nullptr;
+}
+
+void CLandRenderer::clearLayer(SLayer& layer)
+{
+    layer.vao.destroy();
+    layer.vertexBuf.destroy();
+    layer.indexBuf.destroy();
+    if(layer.tileMap != 0 && QOpenGLContext::currentContext())
+        QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &layer.tileMap);
+    layer.tileMap = 0;
+    layer.arrTileMap.clear();
+    layer.pVaoProgram = nullptr;
+    layer.aSlot.clear();
+    layer.aBox.clear();
+    layer.slotCount = 0;
+}
+
+void CLandRenderer::initLayer(SLayer& layer, const QVector<const CSector*>& aSector, bool bWater)
+{
+    if(aSector.isEmpty())
+        return;
+
+    // index buffer contains detailed meshes of all slots followed by coarse meshes of all slots
+    const int slotSize = CSector::drawVertexCount();
+    QVector<uint> arrInd;
+    arrInd.reserve(aSector.size() * (CSector::drawIndexCount(0) + CSector::drawIndexCount(1)));
+    for(int lod(0); lod<2; ++lod)
+        for(int i(0); i<aSector.size(); ++i)
+            CSector::generateIndexData(arrInd, uint(i*slotSize), lod);
+
+    for(int i(0); i<aSector.size(); ++i)
+        layer.aSlot[aSector[i]] = i;
+    layer.slotCount = aSector.size();
+    layer.aBox.resize(aSector.size());
+
+    // geometry of sectors is rarely changed (tile editing touches only tile map), so vertex buffer is static
+    layer.vertexBuf.create();
+    layer.vertexBuf.bind();
+    layer.vertexBuf.allocate(aSector.size() * slotSize * int(sizeof(STerrainVertex)));
+    layer.vertexBuf.release();
+    layer.arrTileMap.fill(0, m_tileMapWidth * m_tileMapHeight * 2);
+    for(int i(0); i<aSector.size(); ++i)
+    {
+        uploadSector(layer, i, aSector[i], bWater);
+        fillTileMap(layer, aSector[i], bWater);
+    }
+
+    layer.indexBuf.create();
+    layer.indexBuf.bind();
+    layer.indexBuf.allocate(arrInd.constData(), arrInd.size() * int(sizeof(uint)));
+    layer.indexBuf.release();
+
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glGenTextures(1, &layer.tileMap);
+    f->glBindTexture(GL_TEXTURE_2D, layer.tileMap);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    f->glTexImage2D(GL_TEXTURE_2D, 0, m_bTileMapRG ? GL_RG8 : GL_LUMINANCE_ALPHA, m_tileMapWidth, m_tileMapHeight, 0, tileMapFormat(), GL_UNSIGNED_BYTE, layer.arrTileMap.constData());
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Writes raw sector vertices to the slot. Each tile has its own 9 vertices (see CSector::generateIndexData)
+void CLandRenderer::uploadSector(SLayer& layer, int slot, const CSector* pSector, bool bWater)
+{
+    const QVector<QVector<CTile>>& arrTile = bWater ? pSector->arrWater() : pSector->arrTile();
+    const STerrainVertex emptyVrt = {};
+    m_arrTmpVrtData.fill(emptyVrt, CSector::drawVertexCount()); // sector with incorrect data is drawn as degenerate triangles
+    if(arrTile.isEmpty())
+        ei::log(eLogWarning, "Sector has no tile data");
+    int minZ(65535), maxZ(0);
+    int curIndex(0);
+    for(int row(0); row<arrTile.size(); ++row)
+        for(int col(0); col<arrTile[row].size(); ++col)
+        {
+            const QVector<QVector<SSecVertex>>& arrVertex = arrTile[row][col].arrVertex();
+            for(int vrtRow(0); vrtRow<3; ++vrtRow)
+                for(int vrtCol(0); vrtCol<3; ++vrtCol)
+                {
+                    const SSecVertex& src = arrVertex[vrtRow][vrtCol];
+                    const uint32_t packedNormal = src.packNormal();
+                    STerrainVertex& vrt = m_arrTmpVrtData[curIndex++];
+                    vrt.tileX = ushort(pSector->index().x * tileSide + col);
+                    vrt.tileY = ushort(pSector->index().y * tileSide + row);
+                    vrt.col = quint8(vrtCol);
+                    vrt.row = quint8(vrtRow);
+                    vrt.xOffset = src.xOffset;
+                    vrt.yOffset = src.yOffset;
+                    vrt.z = src.z;
+                    vrt.normalLow = ushort(packedNormal & 0xFFFF);
+                    vrt.normalHigh = ushort(packedNormal >> 16);
+                    vrt.reserved = 0;
+                    minZ = qMin(minZ, int(src.z));
+                    maxZ = qMax(maxZ, int(src.z));
+                }
+        }
+    Q_ASSERT(curIndex == CSector::drawVertexCount() || arrTile.isEmpty());
+
+    // vertex offsets can move vertices out of the sector on half of unit
+    const QVector3D secPos(pSector->index().x*32.0f, pSector->index().y*32.0f, 0.0f);
+    layer.aBox[slot] = CBox(secPos + QVector3D(-0.5f, -0.5f, minZ*m_maxZ/65535.0f)
+                            ,secPos + QVector3D(32.5f, 32.5f, maxZ*m_maxZ/65535.0f));
+
+    const int slotBytes = CSector::drawVertexCount() * int(sizeof(STerrainVertex));
+    layer.vertexBuf.bind();
+    layer.vertexBuf.write(slot * slotBytes, m_arrTmpVrtData.constData(), slotBytes);
+    layer.vertexBuf.release();
+}
+
+void CLandRenderer::fillTileMap(SLayer& layer, const CSector* pSector, bool bWater)
+{
+    const QVector<QVector<CTile>>& arrTile = bWater ? pSector->arrWater() : pSector->arrTile();
+    for(int row(0); row<arrTile.size(); ++row)
+        for(int col(0); col<arrTile[row].size(); ++col)
+        {
+            const int tileX = int(pSector->index().x) * tileSide + col;
+            const int tileY = int(pSector->index().y) * tileSide + row;
+            const ushort tileWord = arrTile[row][col].packData();
+            layer.arrTileMap[(tileY*m_tileMapWidth + tileX)*2] = uchar(tileWord & 0xFF);
+            layer.arrTileMap[(tileY*m_tileMapWidth + tileX)*2 + 1] = uchar(tileWord >> 8);
+        }
+}
+
+// Re-uploads raw vertices and tile words of the whole sector
+void CLandRenderer::updateSector(const CSector* pSector)
+{
+    if(m_land.aSlot.contains(pSector))
+        uploadSector(m_land, m_land.aSlot[pSector], pSector, false);
+    if(m_water.aSlot.contains(pSector))
+        uploadSector(m_water, m_water.aSlot[pSector], pSector, true);
+    updateSectorTiles(pSector);
+}
+
+// Re-uploads tile words of the whole sector (16x16 texels). Rows are copied to a packed block, there is no GL_UNPACK_ROW_LENGTH in GLES 2
+void CLandRenderer::updateSectorTiles(const CSector* pSector)
+{
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    QVector<uchar> arrBlock(tileSide * tileSide * 2);
+    for(int i(0); i<2; ++i)
+    {
+        SLayer& layer = i == 0 ? m_land : m_water;
+        if(!layer.aSlot.contains(pSector))
+            continue;
+
+        fillTileMap(layer, pSector, i == 1);
+        const int tileX = int(pSector->index().x) * tileSide;
+        const int tileY = int(pSector->index().y) * tileSide;
+        for(int row(0); row<tileSide; ++row)
+            memcpy(arrBlock.data() + row*tileSide*2, layer.arrTileMap.constData() + ((tileY + row)*m_tileMapWidth + tileX)*2, size_t(tileSide*2));
+
+        f->glBindTexture(GL_TEXTURE_2D, layer.tileMap);
+        f->glTexSubImage2D(GL_TEXTURE_2D, 0, tileX, tileY, tileSide, tileSide, tileMapFormat(), GL_UNSIGNED_BYTE, arrBlock.constData());
+    }
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Uploads tile word of one tile (2 bytes)
+void CLandRenderer::updateTile(const CSector* pSector, int row, int col, bool bLand)
+{
+    SLayer& layer = bLand ? m_land : m_water;
+    if(!layer.aSlot.contains(pSector))
+        return;
+
+    const CTile& tile = bLand ? pSector->arrTile()[row][col] : pSector->arrWater()[row][col];
+    const int tileX = int(pSector->index().x) * tileSide + col;
+    const int tileY = int(pSector->index().y) * tileSide + row;
+    const ushort tileWord = tile.packData();
+    uchar* pTexel = layer.arrTileMap.data() + (tileY*m_tileMapWidth + tileX)*2;
+    pTexel[0] = uchar(tileWord & 0xFF);
+    pTexel[1] = uchar(tileWord >> 8);
+
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glBindTexture(GL_TEXTURE_2D, layer.tileMap);
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, tileX, tileY, 1, 1, tileMapFormat(), GL_UNSIGNED_BYTE, pTexel);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void CLandRenderer::bindAttributes(SLayer& layer)
+{
+    // integer attributes are passed as not normalized floats, the shader decodes bits of them
+    struct SAttr {GLint size; GLenum type; int offset;};
+    static const SAttr arrAttr[5] = {
+        {2, GL_UNSIGNED_SHORT, int(offsetof(STerrainVertex, tileX))}
+        ,{2, GL_UNSIGNED_BYTE, int(offsetof(STerrainVertex, col))}
+        ,{2, GL_BYTE, int(offsetof(STerrainVertex, xOffset))}
+        ,{1, GL_UNSIGNED_SHORT, int(offsetof(STerrainVertex, z))}
+        ,{2, GL_UNSIGNED_SHORT, int(offsetof(STerrainVertex, normalLow))}
+    };
+
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    layer.vertexBuf.bind();
+    for(int i(0); i<5; ++i)
+    {
+        if(m_arrAttrLoc[i] < 0)
+            continue;
+        f->glEnableVertexAttribArray(GLuint(m_arrAttrLoc[i]));
+        f->glVertexAttribPointer(GLuint(m_arrAttrLoc[i]), arrAttr[i].size, arrAttr[i].type, GL_FALSE
+                                 ,int(sizeof(STerrainVertex)), reinterpret_cast<const void*>(quintptr(arrAttr[i].offset)));
+    }
+    layer.indexBuf.bind();
+}
+
+void CLandRenderer::draw(QOpenGLShaderProgram* program, const QMatrix4x4& viewProj, bool bWater)
+{
+    SLayer& layer = bWater ? m_water : m_land;
+    if(layer.slotCount == 0)
+        return;
+
+    if(m_pProgram != program)
+    { // resolve attribute names only when program is changed
+        m_pProgram = program;
+        m_arrAttrLoc[0] = program->attributeLocation("a_tile");
+        m_arrAttrLoc[1] = program->attributeLocation("a_corner");
+        m_arrAttrLoc[2] = program->attributeLocation("a_offset");
+        m_arrAttrLoc[3] = program->attributeLocation("a_height");
+        m_arrAttrLoc[4] = program->attributeLocation("a_normal");
+    }
+
+    program->setUniformValue("u_modelMmatrix", QMatrix4x4()); // vertices are built in world coords
+    program->setUniformValue("u_maxZ", m_maxZ);
+    program->setUniformValue("u_atlasCount", float(m_atlasCount));
+    program->setUniformValue("u_tileMapSize", QVector2D(m_tileMapWidth, m_tileMapHeight));
+    program->setUniformValue("u_tileMap", 1);
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glActiveTexture(GL_TEXTURE1);
+    f->glBindTexture(GL_TEXTURE_2D, layer.tileMap);
+    f->glActiveTexture(GL_TEXTURE0);
+
+    if(!layer.vao.isCreated())
+        layer.vao.create(); // can fail on old contexts without VAO support, draw without it in this case
+
+    const bool bVao = layer.vao.isCreated();
+    if(bVao)
+    {
+        layer.vao.bind();
+        if(layer.pVaoProgram != program)
+        { // record buffers and attribute layout once
+            bindAttributes(layer);
+            layer.pVaoProgram = program;
+        }
+    }
+    else
+        bindAttributes(layer);
+
+    // slots are stored row by row, so neighbour visible sectors with the same lod are merged into one draw call
+    const util::CFrustum frustum(viewProj);
+    const QVector4D depthRow = viewProj.row(3); // w of clip coords is the view depth for perspective projection
+    int runLod(-1), runFirst(0), runCount(0);
+    for(int slot(0); slot<layer.slotCount; ++slot)
+    {
+        const CBox& box = layer.aBox[slot];
+        if(!frustum.isBoxVisible(box.minPos(), box.maxPos()))
+            continue;
+
+        const QVector3D center((box.minPos() + box.maxPos())/2.0f);
+        const float depth = QVector4D::dotProduct(depthRow, QVector4D(center, 1.0f));
+        const int lod = depth > lodDistance ? 1 : 0;
+        if(lod == runLod && slot == runFirst + runCount)
+        {
+            ++runCount;
+            continue;
+        }
+        if(runCount > 0)
+            drawSlots(runLod, runFirst, runCount, layer.slotCount);
+        runLod = lod;
+        runFirst = slot;
+        runCount = 1;
+    }
+    if(runCount > 0)
+        drawSlots(runLod, runFirst, runCount, layer.slotCount);
+
+    if(bVao)
+        layer.vao.release();
+    else
+    {
+        for(auto loc: m_arrAttrLoc)
+            if(loc >= 0)
+                f->glDisableVertexAttribArray(GLuint(loc));
+        layer.indexBuf.release();
+    }
+    layer.vertexBuf.release();
+
+    f->glActiveTexture(GL_TEXTURE1);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    f->glActiveTexture(GL_TEXTURE0);
+}
+
+void CLandRenderer::drawSlots(int lod, int firstSlot, int slotCount, int totalSlot)
+{
+    int firstIndex = firstSlot * CSector::drawIndexCount(lod);
+    if(lod > 0)
+        firstIndex += totalSlot * CSector::drawIndexCount(0); // coarse meshes are placed after detailed ones
+
+    const quintptr offset = quintptr(firstIndex) * sizeof(uint);
+    glDrawElements(GL_TRIANGLES, slotCount * CSector::drawIndexCount(lod), GL_UNSIGNED_INT, reinterpret_cast<const void*>(offset));
+}
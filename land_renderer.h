@@ -0,0 +1,82 @@
+#ifndef LAND_RENDERER_H
+#define LAND_RENDERER_H
+
+#include <QVector>
+#include <QHash>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLShaderProgram>
+#include "types.h"
+
+class CSector;
+
+///
+/// \brief The STerrainVertex struct is raw sector vertex data for GPU. Position, normal and texture coords are decoded in terrain.vsh
+///
+struct STerrainVertex
+{
+    ushort tileX; // tile coords on map
+    ushort tileY;
+    quint8 col; // vertex coords inside of tile, 0..2
+    quint8 row;
+    qint8 xOffset;
+    qint8 yOffset;
+    ushort z;
+    ushort normalLow; // packed normal, split to 16 bits parts
+    ushort normalHigh;
+    ushort reserved;
+};
+
+///
+/// \brief The CLandRenderer class keeps raw vertex data of all landscape sectors in one vertex buffer and tile words in a tile map texture, and draws the whole land (or water) layer with few indexed calls
+///
+class CLandRenderer
+{
+public:
+    CLandRenderer();
+    ~CLandRenderer();
+    void reset(const QVector<QVector<CSector*>>& aSector, float maxZ, int atlasCount);
+    void clear();
+    void updateSector(const CSector* pSector);
+    void updateSectorTiles(const CSector* pSector);
+    void updateTile(const CSector* pSector, int row, int col, bool bLand = true);
+    void draw(QOpenGLShaderProgram* program, const QMatrix4x4& viewProj, bool bWater = false);
+    static bool isModernContext();
+
+private:
+    struct SLayer
+    {
+        SLayer();
+        QOpenGLBuffer vertexBuf;
+        QOpenGLBuffer indexBuf;
+        QOpenGLVertexArrayObject vao;
+        QOpenGLShaderProgram* pVaoProgram; // program which attribute locations are recorded in vao
+        QHash<const CSector*, int> aSlot; // sector -> slot of its vertices in vertexBuf
+        QVector<CBox> aBox; // world bounding box of each slot
+        int slotCount;
+        uint tileMap; // texture with tile word for each tile of map (RG8 or LUMINANCE_ALPHA)
+        QVector<uchar> arrTileMap; // copy of tileMap texture data, 2 bytes per tile
+    };
+
+    void initLayer(SLayer& layer, const QVector<const CSector*>& aSector, bool bWater);
+    void uploadSector(SLayer& layer, int slot, const CSector* pSector, bool bWater);
+    void fillTileMap(SLayer& layer, const CSector* pSector, bool bWater);
+    void bindAttributes(SLayer& layer);
+    void clearLayer(SLayer& layer);
+    void drawSlots(int lod, int firstSlot, int slotCount, int totalSlot);
+    GLenum tileMapFormat() const {return m_bTileMapRG ? GL_RG : GL_LUMINANCE_ALPHA;}
+
+private:
+    bool m_bTileMapRG; // tile map format for terrain.vsh, LUMINANCE_ALPHA for terrain_legacy.vsh
+    SLayer m_land;
+    SLayer m_water;
+    int m_tileMapWidth; // tiles number by X
+    int m_tileMapHeight; // tiles number by Y
+    float m_maxZ;
+    int m_atlasCount;
+    QVector<STerrainVertex> m_arrTmpVrtData; // sector vertices before upload
+    QOpenGLShaderProgram* m_pProgram; // program for which attribute locations are cached
+    int m_arrAttrLoc[5]; // a_tile, a_corner, a_offset, a_height, a_normal
+};
+
+#endif // LAND_RENDERER_H
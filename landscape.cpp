@@ -1,5 +1,8 @@
 #include <QFileInfo>
 #include <QRandomGenerator>
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include <limits>
 
 #include "landscape.h"
 #include "res_file.h"
@@ -25,14 +28,20 @@ void CLandscape::unloadMpr()
             delete ySec;
     }
     m_aSector.clear();
+    m_arrSecHash.clear();
+    m_mpHash.clear();
+    m_arrSecGeneration.clear();
     m_aMaterial.clear();
     m_aTileTypes.clear();
     m_aAnimTile.clear();
+    m_render.clear();
     m_bDirty = false;
 }
 
 CLandscape::CLandscape():
-  m_bDirty(false)
+  m_generation(0)
+  ,m_texCount(0)
+  ,m_bDirty(false)
 {
     m_aSector.clear();
     m_aAnimTile.clear();
@@ -47,9 +56,8 @@ CLandscape::~CLandscape()
 
 bool CLandscape::readHeader(QDataStream& stream)
 {
-    const uint mapSignature = 0xce4af672;
     stream >> m_header;
-    if (m_header.signature != mapSignature)
+    if (m_header.signature != SMapHeader::s_signature)
     {
         Q_ASSERT("Incorrect landscape signature" && false);
         return false;
@@ -83,6 +91,11 @@ bool CLandscape::readHeader(QDataStream& stream)
     return true;
 }
 
+static QByteArray serializeSectorData(CSector* pSector)
+{
+    return pSector->serializeSector();
+}
+
 bool CLandscape::serializeMpr(const QString& zoneName, CResFile& mprFile)
 {
     QByteArray mpData;
@@ -110,15 +123,24 @@ bool CLandscape::serializeMpr(const QString& zoneName, CResFile& mprFile)
         mpStream << animTile;
     }
     // end of header data
+    m_mpHash = QCryptographicHash::hash(mpData, QCryptographicHash::Md5);
     mprFile.addFiledata(zoneName + ".mp", mpData);
 
+    // sectors are independent, so they are packed in parallel. Result order is the same as order of sectors
+    QVector<CSector*> arrSector;
+    for(auto& xSec: m_aSector)
+        arrSector.append(xSec);
+    const QVector<QByteArray> arrSecData = QtConcurrent::blockingMapped<QVector<QByteArray>>(arrSector, serializeSectorData);
+
+    m_arrSecHash.resize(arrSecData.size());
+    int secIndex(0);
     for(int row(0); row < m_aSector.size(); ++row)
     {
         for(int col(0); col<m_aSector[row].size(); ++col)
         {
-            QByteArray secData = m_aSector[row][col]->serializeSector();
             QString secName = QString("%1%2%3.sec").arg(zoneName).arg(col, 3, 10, QChar('0')).arg(row, 3, 10, QChar('0'));
-            mprFile.addFiledata(secName, secData);
+            m_arrSecHash[secIndex] = QCryptographicHash::hash(arrSecData[secIndex], QCryptographicHash::Md5); // own save must not be detected as external change
+            mprFile.addFiledata(secName, arrSecData[secIndex++]);
         }
     }
     return true;
@@ -129,31 +151,6 @@ QString CLandscape::mapName() const
     return m_map_name;
 }
 
-// Generates sector suffix by number: 001002 - sector x:1 y:2
-QString genSectorSuffix(int x, int y)
-{
-    QString name;
-    name.append('0');
-    if (x < 10)
-    {
-        name.append('0');
-        name.append(QString::number(x));
-    }
-    else {
-        name.append(QString::number(x));
-    }
-    name.append('0');
-    if (y < 10)
-    {
-        name.append('0');
-        name.append(QString::number(y));
-    }
-    else {
-        name.append(QString::number(y));
-    }
-    return name;
-}
-
 void CLandscape::readMap(const QFileInfo& path)
 {
     if (!path.exists())
@@ -178,8 +175,11 @@ void CLandscape::readMap(const QFileInfo& path)
 
     int texCount;
     m_texture = CTextureList::getInstance()->buildLandTex(innerMapName, texCount);
+    m_texCount = texCount;
 
-    QDataStream mpStream(aComponent[innerMapName + ".mp"]);
+    const QByteArray mpData = aComponent[innerMapName + ".mp"];
+    m_mpHash = QCryptographicHash::hash(mpData, QCryptographicHash::Md5);
+    QDataStream mpStream(mpData);
     util::formatStream(mpStream);
     if (!readHeader(mpStream))
         return;
@@ -192,7 +192,9 @@ void CLandscape::readMap(const QFileInfo& path)
         for (uint x(0); x<m_header.nXSector; ++x)
         {
             secIndex.reset(x, y);
-            QDataStream secStream(aComponent.take(innerMapName + genSectorSuffix(int(x), int(y)) + ".sec"));
+            const QByteArray secData = aComponent.take(innerMapName + genSectorSuffix(int(x), int(y)) + ".sec");
+            m_arrSecHash.append(QCryptographicHash::hash(secData, QCryptographicHash::Md5));
+            QDataStream secStream(secData);
             util::formatStream(secStream);
             CSector* sector = new CSector(secStream, m_header.maxZ, texCount);
             sector->setIndex(secIndex);
@@ -204,10 +206,123 @@ void CLandscape::readMap(const QFileInfo& path)
         }
         m_aSector.append(xSec);
     }
+    // new generation for every sector makes undo commands of previous landscape invalid
+    m_arrSecGeneration.fill(++m_generation, int(m_header.nXSector*m_header.nYSector));
+    m_render.reset(m_aSector, m_header.maxZ, texCount);
 
     ei::log(eLogInfo, "End read terrain");
 }
 
+// Re-reads *.mpr file in worker thread. Only sectors which data differs from the loaded one are decoded
+QFuture<SLandReload> CLandscape::decodeChangedSectorsAsync() const
+{
+    return QtConcurrent::run(&CLandscape::decodeChangedSectors, m_filePath, m_map_name, m_mpHash, m_arrSecHash, m_texCount);
+}
+
+// Runs in worker thread, so it works only with copies of landscape data
+SLandReload CLandscape::decodeChangedSectors(const QFileInfo& path, const QString& mapName, const QByteArray& mpHash, const QVector<QByteArray>& arrSecHash, int texCount)
+{
+    SLandReload reload;
+    CResFile map(path.filePath());
+    QMap<QString, QByteArray> aComponent;
+    for (auto& file: map.bufferOfFiles().toStdMap())
+        aComponent.insert(file.first.toLower(), file.second);
+
+    const QByteArray mpData = aComponent.value(mapName + ".mp");
+    if(mpData.isEmpty())
+    { // file is being written or map is renamed
+        reload.nInvalid = 1;
+        return reload;
+    }
+
+    // any change of header, materials, tile types or anim tiles needs full reload
+    if(QCryptographicHash::hash(mpData, QCryptographicHash::Md5) != mpHash)
+    {
+        reload.bFullReload = true;
+        return reload;
+    }
+
+    // *.mp is the same as loaded one, so header can be taken from file
+    QDataStream mpStream(mpData);
+    util::formatStream(mpStream);
+    SMapHeader header;
+    mpStream >> header;
+
+    UI2 secIndex;
+    for (uint y(0); y<header.nYSector; ++y)
+        for (uint x(0); x<header.nXSector; ++x)
+        {
+            const int index = int(y*header.nXSector + x);
+            const QByteArray secData = aComponent.value(mapName + genSectorSuffix(int(x), int(y)) + ".sec");
+            const QByteArray hash = QCryptographicHash::hash(secData, QCryptographicHash::Md5);
+            if(index < arrSecHash.size() && hash == arrSecHash[index])
+                continue;
+
+            if(!SSecData::isSecData(secData))
+            {
+                ++reload.nInvalid;
+                continue;
+            }
+
+            QDataStream secStream(secData);
+            util::formatStream(secStream);
+            CSector* pSector = new CSector(secStream, header.maxZ, texCount);
+            secIndex.reset(x, y);
+            pSector->setIndex(secIndex);
+            reload.arrIndex.append(index);
+            reload.arrSector.append(pSector);
+            reload.arrHash.append(hash);
+        }
+    return reload;
+}
+
+// Replaces changed sectors by decoded ones and uploads only them. GL context must be current
+void CLandscape::applyReload(SLandReload& reload)
+{
+    if(reload.nInvalid > 0)
+        ei::log(eLogWarning, QString("Landscape reload: %1 sectors are not read").arg(reload.nInvalid));
+
+    if(!isMprLoad() || reload.bFullReload)
+    {
+        qDeleteAll(reload.arrSector);
+        reload.arrSector.clear();
+        return;
+    }
+
+    const int nXSec = m_aSector.first().size();
+    bool bWaterChanged = false;
+    for(int i(0); i<reload.arrIndex.size(); ++i)
+    {
+        const int index = reload.arrIndex[i];
+        CSector* pSector = m_aSector[index/nXSec][index%nXSec];
+        const bool bHadWater = pSector->hasWater();
+        *pSector = *reload.arrSector[i]; // keep sector pointer, it is used as key by renderer
+        delete reload.arrSector[i];
+        m_arrSecHash[index] = reload.arrHash[i];
+        m_arrSecGeneration[index] = ++m_generation;
+        if(bHadWater != pSector->hasWater())
+            bWaterChanged = true; // water layer is built for sectors with water only
+        else
+            m_render.updateSector(pSector);
+    }
+    reload.arrSector.clear();
+
+    if(bWaterChanged)
+        m_render.reset(m_aSector, m_header.maxZ, m_texCount);
+
+    ei::log(eLogInfo, QString("Landscape reload: %1 sectors are updated").arg(reload.arrIndex.size()));
+}
+
+// Tile undo commands remember generations of their sectors. Generation is changed when sector is replaced by file data, so such commands must not be applied
+uint CLandscape::sectorGeneration(int xSec, int ySec) const
+{
+    const int index = ySec*int(m_header.nXSector) + xSec;
+    if(xSec < 0 || ySec < 0 || xSec >= int(m_header.nXSector) || index >= m_arrSecGeneration.size())
+        return 0;
+
+    return m_arrSecGeneration[index];
+}
+
 void CLandscape::save()
 {
     saveMapAs(m_filePath);
@@ -227,22 +342,19 @@ void CLandscape::saveMapAs(const QFileInfo& path)
     m_bDirty = false;
 }
 
-void CLandscape::draw(QOpenGLShaderProgram* program)
+// viewProj is used to skip sectors out of the camera view and to choose detail level of visible ones
+void CLandscape::draw(QOpenGLShaderProgram* program, const QMatrix4x4& viewProj)
 {
     m_texture->bind(0);
     program->setUniformValue("qt_Texture0", 0);
-    for (auto& xSec: m_aSector)
-        for(auto& ySec: xSec)
-            ySec->draw(program);
+    m_render.draw(program, viewProj);
 }
 
-void CLandscape::drawWater(QOpenGLShaderProgram *program)
+void CLandscape::drawWater(QOpenGLShaderProgram *program, const QMatrix4x4& viewProj)
 {
     m_texture->bind(0);
     program->setUniformValue("qt_Texture0", 0);
-    for (auto& xSec: m_aSector)
-        for(auto& ySec: xSec)
-            ySec->drawWater(program);
+    m_render.draw(program, viewProj, true);
 }
 
 bool CLandscape::projectPt(QVector3D& point)
@@ -263,16 +375,45 @@ bool CLandscape::projectPt(QVector3D& point)
     return true;
 }
 
+// Batch projection for many points at once (logic lines, moved selections). Neighbour points are usually in the same sector, so the sector is looked up only when it changes
 bool CLandscape::projectPt(QVector<QVector3D>& aPoint)
 {
-    int projectedPt(0);
-    for(auto& pt: aPoint)
+    return projectPt(aPoint.data(), aPoint.size());
+}
+
+bool CLandscape::projectPt(QVector3D* arrPoint, int count)
+{
+    if(!isMprLoad())
+        return false;
+
+    bool bRes = true;
+    int xLast(0), yLast(0);
+    bool bOutOfMap = false;
+    const CSector* pSector = nullptr;
+    for(int i(0); i<count; ++i)
     {
-        projectPt(pt);
-        ++projectedPt;
+        QVector3D& point = arrPoint[i];
+        const int xIndex = int(point.x()/32.0f);
+        const int yIndex = int(point.y()/32.0f);
+        if(i == 0 || xIndex != xLast || yIndex != yLast)
+        {
+            xLast = xIndex;
+            yLast = yIndex;
+            bOutOfMap = yIndex < 0 || yIndex > m_aSector.size() || xIndex < 0 || xIndex > m_aSector.first().size();
+            pSector = (!bOutOfMap && yIndex < m_aSector.size() && xIndex < m_aSector.first().size()) ? m_aSector[yIndex][xIndex] : nullptr;
+        }
+
+        if(bOutOfMap)
+        { // the same as single point projection does
+            point.setZ(0.0f);
+            bRes = false;
+            continue;
+        }
+        if(nullptr != pSector)
+            pSector->projectPt(point);
     }
 
-    return projectedPt == aPoint.size();
+    return bRes;
 }
 
 void CLandscape::projectPosition(CNode* pNode)
@@ -319,6 +460,26 @@ bool CLandscape::pickTile(QVector3D& point, CTile*& pTileOut, STileLocation& til
     return false;
 }
 
+// Finds the nearest intersection of ray with land (or water) on CPU. dir length is not normalized, hitPoint = origin + dir*t
+bool CLandscape::intersectRay(QVector3D& hitPoint, STileLocation& tileLoc, const QVector3D& origin, const QVector3D& dir, bool bLand)
+{
+    float t = std::numeric_limits<float>::max();
+    bool bHit = false;
+    int row, col;
+    for(int y(0); y<m_aSector.size(); ++y)
+        for(int x(0); x<m_aSector[y].size(); ++x)
+        {
+            if(!m_aSector[y][x]->intersectRay(t, row, col, origin, dir, bLand))
+                continue;
+            tileLoc = STileLocation{x, y, row, col, bLand};
+            bHit = true;
+        }
+
+    if(bHit)
+        hitPoint = origin + dir*t;
+    return bHit;
+}
+
 void CLandscape::setTile(const QMap<STileLocation, STileInfo>& arrTileInfo)
 {
     int xSec(-1), ySec(-1);
@@ -328,14 +489,14 @@ void CLandscape::setTile(const QMap<STileLocation, STileInfo>& arrTileInfo)
         if(xSec != tile.first.xSec)
         {
             if(xSec != -1 && ySec != -1 && !arrSecTileInfo.isEmpty())
-                m_aSector[ySec][xSec]->setTile(arrSecTileInfo);
+                setSectorTiles(xSec, ySec, arrSecTileInfo);
             xSec = tile.first.xSec;
             arrSecTileInfo.clear();
         }
         if(ySec != tile.first.ySec)
         {
             if(xSec != -1 && ySec != -1 && !arrSecTileInfo.isEmpty())
-                m_aSector[ySec][xSec]->setTile(arrSecTileInfo);
+                setSectorTiles(xSec, ySec, arrSecTileInfo);
             ySec = tile.first.ySec;
             arrSecTileInfo.clear();
         }
@@ -344,12 +505,97 @@ void CLandscape::setTile(const QMap<STileLocation, STileInfo>& arrTileInfo)
     }
     //draw last tile data
     if(!arrSecTileInfo.isEmpty())
-        m_aSector[ySec][xSec]->setTile(arrSecTileInfo);
+        setSectorTiles(xSec, ySec, arrSecTileInfo);
+}
+
+void CLandscape::setSectorTiles(int xSec, int ySec, const QMap<STileLocation, STileInfo>& arrTileInfo)
+{
+    CSector* pSector = m_aSector[ySec][xSec];
+    pSector->setTile(arrTileInfo);
+    for(auto it = arrTileInfo.constBegin(); it != arrTileInfo.constEnd(); ++it)
+        m_render.updateTile(pSector, it.key().row, it.key().col, it.key().bLand);
+}
+
+// Size of map in tiles
+QSize CLandscape::tileMapSize() const
+{
+    if(m_aSector.isEmpty())
+        return QSize(0, 0);
+    return QSize(m_aSector.first().size()*16, m_aSector.size()*16);
+}
+
+// Gets tile by tile coords of map. Returns false if there is no such tile (out of map or sector without water)
+bool CLandscape::tileInfo(STileInfo& info, int x, int y, bool bLand) const
+{
+    const QSize mapSize = tileMapSize();
+    if(x < 0 || y < 0 || x >= mapSize.width() || y >= mapSize.height())
+        return false;
+
+    const CSector* pSector = m_aSector[y/16][x/16];
+    if(!bLand && !pSector->hasWater())
+        return false;
+
+    const CTile& tile = bLand ? pSector->arrTile()[y%16][x%16] : pSector->arrWater()[y%16][x%16];
+    info = STileInfo{tile.tileIndex(), tile.tileRotation(), tile.materialIndex()};
+    return true;
+}
+
+// Collects tiles covered by spans, one item per tile in order of spans. Missing water tiles are filled by default values and are never applied
+void CLandscape::tileSpanInfo(QVector<STileInfo>& arrInfo, const QVector<STileSpan>& arrSpan, bool bLand) const
+{
+    int count(0);
+    for(const auto& span: arrSpan)
+        count += span.x1 - span.x0 + 1;
+    arrInfo.clear();
+    arrInfo.reserve(count);
+    for(const auto& span: arrSpan)
+        for(int x(span.x0); x<=span.x1; ++x)
+        {
+            STileInfo info{0, 0, 0};
+            tileInfo(info, x, span.y, bLand);
+            arrInfo.append(info);
+        }
+}
+
+// Applies tiles to spans (one item of arrInfo per tile). Spans are split by sector borders, each sector is updated as a row of tiles and uploaded once at the end
+void CLandscape::setTileSpans(const QVector<STileSpan>& arrSpan, const QVector<STileInfo>& arrInfo, bool bLand)
+{
+    if(m_aSector.isEmpty())
+        return;
+
+    const int nXSec = m_aSector.first().size();
+    QVector<bool> arrChanged(m_aSector.size()*nXSec, false);
+    int infoIndex(0);
+    for(const auto& span: arrSpan)
+    {
+        const int ySec = span.y/16;
+        const int row = span.y%16;
+        for(int x(span.x0); x<=span.x1;)
+        {
+            const int col = x%16;
+            const int count = qMin(span.x1 - x + 1, 16 - col);
+            const int xSec = x/16;
+            CSector* pSector = m_aSector[ySec][xSec];
+            Q_ASSERT(infoIndex + count <= arrInfo.size());
+            if(bLand || pSector->hasWater())
+            {
+                pSector->setTiles(row, col, count, arrInfo.constData() + infoIndex, bLand);
+                arrChanged[ySec*nXSec + xSec] = true;
+            }
+            infoIndex += count;
+            x += count;
+        }
+    }
+
+    for(int i(0); i<arrChanged.size(); ++i)
+        if(arrChanged[i])
+            m_render.updateSectorTiles(m_aSector[i/nXSec][i%nXSec]);
 }
 
 void CLandscape::updateSectorDrawData(int xSec, int ySec)
 {
     m_aSector[ySec][xSec]->updateDrawData();
+    m_render.updateSector(m_aSector[ySec][xSec]);
 }
 
 void CLandscape::projectPositions(QList<CNode*>& aNode)
@@ -10,45 +10,34 @@
 #include <QFile>
 #include <QDataStream>
 #include <QVector>
+#include <QSize>
+#include <QFuture>
 
 //#include "sector.h"
 #include "res_file.h"
+#include "mpr_data.h"
 #include "tile_form.h"
+#include "land_renderer.h"
 
 
 class CSector;
 class CTile;
 
-struct SMapHeader
-{
-    uint   signature;
-    float  maxZ;
-    uint   nXSector;
-    uint   nYSector;
-    uint   nTexture;
-    uint   textureSize;
-    uint   nTile;
-    uint   tileSize;
-    ushort nMaterial;
-    uint   nAnimTile;
-
-    friend QDataStream& operator>> (QDataStream& is, SMapHeader& head)
-    {
-        return is >> head.signature >> head.maxZ >> head.nXSector >> head.nYSector  >>
-                     head.nTexture >> head.textureSize >> head.nTile >> head.tileSize >>
-                     head.nMaterial >> head.nAnimTile;
-    }
+class CNode;
 
-    friend QDataStream& operator<< (QDataStream& os, const SMapHeader& head)
-    {
-        return os << head.signature << head.maxZ  << head.nXSector << head.nYSector <<
-                     head.nTexture << head.textureSize << head.nTile << head.tileSize <<
-                     head.nMaterial << head.nAnimTile;
-    }
+///
+/// \brief The SLandReload struct is a result of background check of changed *.mpr file
+///
+struct SLandReload
+{
+    SLandReload(): bFullReload(false), nInvalid(0) {}
+    bool bFullReload; // *.mp (header, materials, tile types, anim tiles) is changed, the whole landscape must be re-read
+    int nInvalid; // sectors which were not read (file is being written)
+    QVector<int> arrIndex; // changed sectors, y*nXSector + x
+    QVector<CSector*> arrSector; // decoded changed sectors, ownership is passed to CLandscape::applyReload
+    QVector<QByteArray> arrHash;
 };
 
-class CNode;
-
 ///
 /// \brief The CLandscape class provides an implementation of the internal game landscape format (*.mpr)
 ///
@@ -62,15 +51,21 @@ public:
     void readMap(const QFileInfo& path);
     void save();
     void saveMapAs(const QFileInfo& path);
-    void draw(QOpenGLShaderProgram* program);
-    void drawWater(QOpenGLShaderProgram* program);
+    void draw(QOpenGLShaderProgram* program, const QMatrix4x4& viewProj);
+    void drawWater(QOpenGLShaderProgram* program, const QMatrix4x4& viewProj);
     void drawTilePreview(QOpenGLShaderProgram* program);
     bool projectPt(QVector3D& point);
     bool projectPt(QVector<QVector3D>& aPoint);
+    bool projectPt(QVector3D* arrPoint, int count);
     void projectPositions(QList<CNode*>& aNode);
     void projectPosition(CNode* pNode);
     bool pickTile(QVector3D& point, CTile*& pTileOut, STileLocation& tileLoc, bool bLand = true);
+    bool intersectRay(QVector3D& hitPoint, STileLocation& tileLoc, const QVector3D& origin, const QVector3D& dir, bool bLand = true);
     void setTile(const QMap<STileLocation, STileInfo>& arrTileInfo);
+    QSize tileMapSize() const;
+    bool tileInfo(STileInfo& info, int x, int y, bool bLand = true) const;
+    void tileSpanInfo(QVector<STileInfo>& arrInfo, const QVector<STileSpan>& arrSpan, bool bLand = true) const;
+    void setTileSpans(const QVector<STileSpan>& arrSpan, const QVector<STileInfo>& arrInfo, bool bLand = true);
     const QFileInfo& filePath() {return m_filePath;}
     QOpenGLTexture* glTexture() const {return m_texture;}
     uint textureNum() const {return m_header.nTexture;}
@@ -85,12 +80,17 @@ public:
     bool isDirty() const {return m_bDirty;}
 
     QString mapName() const;
+    QFuture<SLandReload> decodeChangedSectorsAsync() const;
+    void applyReload(SLandReload& reload);
+    uint sectorGeneration(int xSec, int ySec) const;
 
 private:
     CLandscape();
     ~CLandscape();
     bool readHeader(QDataStream& stream);
     bool serializeMpr(const QString& zoneName, CResFile& mprFile);
+    void setSectorTiles(int xSec, int ySec, const QMap<STileLocation, STileInfo>& arrTileInfo);
+    static SLandReload decodeChangedSectors(const QFileInfo& path, const QString& mapName, const QByteArray& mpHash, const QVector<QByteArray>& arrSecHash, int texCount);
 
 private:
     static CLandscape* m_pLand;
@@ -99,7 +99,13 @@ private:
     QVector<ETileType> m_aTileTypes; //array using tyle type on current map
     QVector<SAnimTile> m_aAnimTile;
     QVector<QVector<CSector*>> m_aSector;
+    QVector<QByteArray> m_arrSecHash; // hash of *.sec data for each sector as it is in file, y*nXSector + x
+    QByteArray m_mpHash; // hash of *.mp data as it is in file
+    QVector<uint> m_arrSecGeneration; // y*nXSector + x, changed when sector data is replaced by reading of file (see sectorGeneration)
+    uint m_generation; // the last given generation, never decreases
+    int m_texCount;
     QOpenGLTexture* m_texture;
+    CLandRenderer m_render;
     QFileInfo m_filePath;
     QVector<int> m_arrIncorectTiles;
     QString m_map_name;
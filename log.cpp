@@ -4,7 +4,6 @@
 #include <QDateTime>
 #include <QCoreApplication>
 #include <QDebug>
-#include "settings.h"
 
 CLogger* CLogger::m_pLogger = nullptr;
 
@@ -43,6 +42,7 @@ void CLogger::log(ELogMessageType type, const QString msg)
         txt = QString("[   %1\t  %2  ] {%3} \t %4").arg("DATE", "TIME", "TYPE", "MESSAGE"); break;
     }
 
+    QMutexLocker locker(&m_mutex);
     log_file.open(QIODevice::WriteOnly | QIODevice::Append);
     textStream << txt << endl;
     log_file.close();
@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QFile>
+#include <QMutex>
 
 #define LOG_FATAL(msg) ei::log(eLogFatal, msg, Q_FUNC_INFO)
 
@@ -39,6 +40,7 @@ private:
 private:
     static CLogger* m_pLogger;
     QFile log_file;
+    QMutex m_mutex; // objects of mob are loaded by several threads
     CSettings* m_pSettings;
     ELogMessageType m_loglvl;
 };
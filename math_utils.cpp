@@ -1,3 +1,4 @@
+#include <limits>
 #include "math_utils.h"
 
 namespace util
@@ -83,4 +84,105 @@ bool ptToTriangle(float& t, float& u, float& v, const QVector3D& origin, QVector
     return true;
 }
 
+///
+/// \brief calculates height of the triangle at x,y point (projection along Z axis), using barycentric coordinates
+/// \param out. z - height of triangle in the point
+/// \param in. x - X coordinate of point
+/// \param in. y - Y coordinate of point
+/// \param in. vert0 - first point of triagle
+/// \param in. vert1 - second point of triangle
+/// \param in. vert2 - third point of triangle
+/// \return true if x,y point is inside of triangle projection on XY plane
+///
+bool heightOnTriangle(float& z, float x, float y, const QVector3D& vert0, const QVector3D& vert1, const QVector3D& vert2)
+{
+    const float det = (vert1.y() - vert2.y()) * (vert0.x() - vert2.x()) + (vert2.x() - vert1.x()) * (vert0.y() - vert2.y());
+    if(qFuzzyIsNull(det))
+        return false;
+
+    const float l0 = ((vert1.y() - vert2.y()) * (x - vert2.x()) + (vert2.x() - vert1.x()) * (y - vert2.y())) / det;
+    const float l1 = ((vert2.y() - vert0.y()) * (x - vert2.x()) + (vert0.x() - vert2.x()) * (y - vert2.y())) / det;
+    const float l2 = 1.0f - l0 - l1;
+    const float epsilon = -0.00001f; // points on the edge belong to both triangles
+    if(l0 < epsilon || l1 < epsilon || l2 < epsilon)
+        return false;
+
+    z = l0 * vert0.z() + l1 * vert1.z() + l2 * vert2.z();
+    return true;
+}
+
+///
+/// \brief checks intersection of ray with axis aligned box (slab method)
+/// \param out. tEnter - ray parameter of the entry point (0 if origin is inside of the box)
+/// \param in. origin - start point of ray
+/// \param in. dir - direction of ray
+/// \param in. minPos - minimum corner of box
+/// \param in. maxPos - maximum corner of box
+/// \return true if ray (t >= 0) intersects the box
+///
+bool rayToBox(float& tEnter, const QVector3D& origin, const QVector3D& dir, const QVector3D& minPos, const QVector3D& maxPos)
+{
+    float tMin = 0.0f;
+    float tMax = std::numeric_limits<float>::max();
+    for(int i(0); i<3; ++i)
+    {
+        if(qFuzzyIsNull(dir[i]))
+        { // ray is parallel to the slab
+            if(origin[i] < minPos[i] || origin[i] > maxPos[i])
+                return false;
+            continue;
+        }
+        const float invDir = 1.0f / dir[i];
+        float t1 = (minPos[i] - origin[i]) * invDir;
+        float t2 = (maxPos[i] - origin[i]) * invDir;
+        if(t1 > t2)
+            qSwap(t1, t2);
+        tMin = qMax(tMin, t1);
+        tMax = qMin(tMax, t2);
+        if(tMin > tMax)
+            return false;
+    }
+    tEnter = tMin;
+    return true;
+}
+
+///
+/// \brief extracts frustum planes from the combined matrix (projection * view)
+/// \param in. viewProj - view-projection matrix of camera
+///
+CFrustum::CFrustum(const QMatrix4x4& viewProj)
+{
+    const QVector4D row0 = viewProj.row(0);
+    const QVector4D row1 = viewProj.row(1);
+    const QVector4D row2 = viewProj.row(2);
+    const QVector4D row3 = viewProj.row(3);
+    m_arrPlane[0] = row3 + row0;
+    m_arrPlane[1] = row3 - row0;
+    m_arrPlane[2] = row3 + row1;
+    m_arrPlane[3] = row3 - row1;
+    m_arrPlane[4] = row3 + row2;
+    m_arrPlane[5] = row3 - row2;
+}
+
+///
+/// \brief checks if axis aligned box intersects frustum (conservative, can return true for some boxes near frustum corners)
+/// \param in. minPos - minimum corner of box
+/// \param in. maxPos - maximum corner of box
+/// \return false if box is completely outside of any plane
+///
+bool CFrustum::isBoxVisible(const QVector3D& minPos, const QVector3D& maxPos) const
+{
+    for(int i(0); i<6; ++i)
+    {
+        const QVector4D& plane = m_arrPlane[i];
+        // corner of the box which is the farthest along the plane normal
+        const QVector3D pt(plane.x() >= 0.0f ? maxPos.x() : minPos.x()
+                          ,plane.y() >= 0.0f ? maxPos.y() : minPos.y()
+                          ,plane.z() >= 0.0f ? maxPos.z() : minPos.z());
+        if(QVector3D::dotProduct(plane.toVector3D(), pt) + plane.w() < 0.0f)
+            return false;
+    }
+    return true;
+}
+
 }
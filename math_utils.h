@@ -1,11 +1,28 @@
 #ifndef MATH_UTILS_H
 #define MATH_UTILS_H
 #include <QVector3D>
+#include <QVector4D>
+#include <QMatrix4x4>
 
 namespace util
 {
     bool pointIsInTriangle();
     bool ptToTriangle(float& t, float& u, float& v, const QVector3D& origin, QVector3D& dir, QVector3D& vert0, QVector3D& vert1, QVector3D& vert2, bool bTestCull = false);
+    bool heightOnTriangle(float& z, float x, float y, const QVector3D& vert0, const QVector3D& vert1, const QVector3D& vert2);
+    bool rayToBox(float& tEnter, const QVector3D& origin, const QVector3D& dir, const QVector3D& minPos, const QVector3D& maxPos);
+
+    ///
+    /// \brief The CFrustum class holds the clip planes of the camera view volume, extracted from view-projection matrix
+    ///
+    class CFrustum
+    {
+    public:
+        explicit CFrustum(const QMatrix4x4& viewProj);
+        bool isBoxVisible(const QVector3D& minPos, const QVector3D& maxPos) const;
+
+    private:
+        QVector4D m_arrPlane[6]; // left, right, bottom, top, near, far. xyz - normal (pointing inside), w - distance
+    };
 }
 
 
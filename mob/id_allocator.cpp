@@ -0,0 +1,87 @@
+#include "id_allocator.h"
+
+CIdAllocator::CIdAllocator()
+{
+    reset();
+}
+
+// 0 is used as 'no ID' and never allocated
+void CIdAllocator::reset()
+{
+    m_aFree.clear();
+    m_aFree.insert(1, 0xFFFFFFFF);
+}
+
+// returns free interval which contains id or end()
+QMap<uint, uint>::const_iterator CIdAllocator::findInterval(uint id) const
+{
+    auto it = m_aFree.upperBound(id);
+    if(it == m_aFree.constBegin())
+        return m_aFree.constEnd();
+
+    --it;
+    return id < it.value() ? it : m_aFree.constEnd();
+}
+
+bool CIdAllocator::isFree(uint id) const
+{
+    return findInterval(id) != m_aFree.constEnd();
+}
+
+void CIdAllocator::take(uint id)
+{
+    auto it = findInterval(id);
+    if(it == m_aFree.constEnd())
+        return;
+
+    const uint start = it.key();
+    const uint end = it.value();
+    m_aFree.remove(start);
+    if(start < id)
+        m_aFree.insert(start, id);
+    if(id + 1 < end)
+        m_aFree.insert(id + 1, end);
+}
+
+void CIdAllocator::release(uint id)
+{
+    if(id == 0 || id == 0xFFFFFFFF || isFree(id))
+        return;
+
+    uint start = id;
+    uint end = id + 1;
+    auto next = m_aFree.find(end);
+    if(next != m_aFree.end())
+    {
+        end = next.value();
+        m_aFree.erase(next);
+    }
+
+    auto prev = m_aFree.lowerBound(id);
+    if(prev != m_aFree.begin())
+    {
+        --prev;
+        if(prev.value() == id)
+        {
+            start = prev.key();
+            m_aFree.erase(prev);
+        }
+    }
+    m_aFree.insert(start, end);
+}
+
+// returns the lowest free ID of [minId, maxId) or 0 if there is no one
+uint CIdAllocator::firstFree(uint minId, uint maxId) const
+{
+    if(minId >= maxId)
+        return 0;
+
+    if(isFree(minId))
+        return minId;
+
+    auto it = m_aFree.upperBound(minId);
+    if(it != m_aFree.constEnd() && it.key() < maxId)
+        return it.key();
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef ID_ALLOCATOR_H
+#define ID_ALLOCATOR_H
+
+#include <QMap>
+
+///
+/// \brief The CIdAllocator class keeps free map IDs of mob as ordered set of intervals. Search of the first free ID in range, taking and releasing of ID are O(log n)
+///
+class CIdAllocator
+{
+public:
+    CIdAllocator();
+    void reset();
+    void take(uint id);
+    void release(uint id);
+    bool isFree(uint id) const;
+    uint firstFree(uint minId, uint maxId) const;
+
+private:
+    QMap<uint, uint>::const_iterator findInterval(uint id) const;
+
+private:
+    QMap<uint, uint> m_aFree; // start -> end (exclusive) of free interval
+};
+
+#endif // ID_ALLOCATOR_H
@@ -0,0 +1,249 @@
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QtConcurrent>
+
+#include "json_stream.h"
+#include "log.h"
+
+// Values before array key are written at once as QJsonDocument writes them, the others are kept for finish
+CJsonStreamWriter::CJsonStreamWriter(QIODevice* pDevice, const QJsonObject& header, const QString& arrayKey):
+    m_pDevice(pDevice)
+    ,m_count(0)
+{
+    QJsonObject head;
+    for(auto it = header.constBegin(); it != header.constEnd(); ++it)
+    {
+        if(it.key() < arrayKey)
+            head.insert(it.key(), it.value());
+        else
+            m_tail.insert(it.key(), it.value());
+    }
+
+    QByteArray text("{");
+    if(!head.isEmpty())
+    {
+        text = QJsonDocument(head).toJson(QJsonDocument::JsonFormat::Indented);
+        text.truncate(text.lastIndexOf('}'));
+        while(text.endsWith('\n') || text.endsWith(' '))
+            text.chop(1);
+        text += ",";
+    }
+    text += "\n    \"" + arrayKey.toUtf8() + "\": [";
+    m_pDevice->write(text);
+}
+
+// Elements are texts of elementText, they can be prepared in parallel
+void CJsonStreamWriter::writeElements(const QList<QByteArray>& arrElement)
+{
+    for(auto& element : arrElement)
+    {
+        if(m_count > 0)
+            m_pDevice->write(",");
+        m_pDevice->write("\n");
+        m_pDevice->write(element);
+        ++m_count;
+    }
+}
+
+void CJsonStreamWriter::finish()
+{
+    m_pDevice->write("\n    ]");
+    if(m_tail.isEmpty())
+    {
+        m_pDevice->write("\n}\n");
+        return;
+    }
+
+    const QByteArray text = QJsonDocument(m_tail).toJson(QJsonDocument::JsonFormat::Indented);
+    m_pDevice->write(",");
+    m_pDevice->write(text.mid(1)); // without opening brace
+}
+
+// Object as element of top level array: indented by 8 spaces, without new line at the end
+QByteArray CJsonStreamWriter::elementText(const QJsonObject& obj)
+{
+    QByteArray text = QJsonDocument(obj).toJson(QJsonDocument::JsonFormat::Indented);
+    text.chop(1); // new line at the end
+    return "        " + text.replace('\n', "\n        ");
+}
+
+CJsonStreamReader::CJsonStreamReader(QIODevice* pDevice, const QString& arrayKey):
+    m_pDevice(pDevice)
+    ,m_arrayKey(arrayKey.toUtf8())
+    ,m_pos(0)
+    ,m_depth(0)
+    ,m_arrayDepth(0)
+    ,m_bString(false)
+    ,m_bEscape(false)
+    ,m_bKey(false)
+    ,m_bExpectKey(false)
+    ,m_bArrayDone(false)
+    ,m_bEnd(false)
+    ,m_bError(false)
+{
+}
+
+// Appends up to maxCount next elements of array. Returns false when there are no more elements, the header is complete then
+bool CJsonStreamReader::readElements(QList<QByteArray>& arrElement, int maxCount)
+{
+    const int blockSize = 1 << 16;
+    const int count = arrElement.size();
+    while(!m_bEnd && !m_bError && arrElement.size() - count < maxCount)
+    {
+        if(m_pos >= m_buffer.size())
+        {
+            m_buffer = m_pDevice->read(blockSize);
+            m_pos = 0;
+            if(m_buffer.isEmpty())
+            {
+                ei::log(eLogWarning, "Unexpected end of json data");
+                m_bError = true;
+                break;
+            }
+        }
+        scan(m_buffer[m_pos++], arrElement);
+    }
+    return arrElement.size() > count;
+}
+
+// Values of top level object except of array elements. Must be called after readElements returned false
+QJsonObject CJsonStreamReader::header()
+{
+    if(m_bError)
+        return QJsonObject();
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(m_header, &parseError);
+    if(parseError.error != QJsonParseError::NoError)
+    {
+        ei::log(eLogWarning, "Incorrect json: " + parseError.errorString());
+        m_bError = true;
+        return QJsonObject();
+    }
+    return doc.object();
+}
+
+// Elements are independent documents, so they are parsed on thread pool
+QList<QJsonObject> CJsonStreamReader::parseElements(const QList<QByteArray>& arrElement)
+{
+    return QtConcurrent::blockingMapped<QList<QJsonObject>>(arrElement, [](const QByteArray& text)
+    {
+        return QJsonDocument::fromJson(text).object();
+    });
+}
+
+void CJsonStreamReader::finishElement(QList<QByteArray>& arrElement)
+{
+    if(m_element.isEmpty())
+        return;
+
+    arrElement.append(m_element);
+    m_element.clear();
+}
+
+// Tracks strings and nesting only, values are not decoded here
+void CJsonStreamReader::scan(char sym, QList<QByteArray>& arrElement)
+{
+    const bool bInArray = m_arrayDepth > 0;
+    if(m_bString)
+    {
+        (bInArray ? m_element : m_header).append(sym);
+        if(m_bEscape)
+            m_bEscape = false;
+        else if(sym == '\\')
+            m_bEscape = true;
+        else if(sym == '"')
+            m_bString = false;
+        else if(m_bKey)
+            m_key.append(sym);
+        return;
+    }
+
+    if(bInArray)
+    {
+        if(m_depth == m_arrayDepth)
+        { // between elements or inside of not container element
+            switch (sym) {
+            case ']':
+                finishElement(arrElement);
+                m_header.append(sym);
+                --m_depth;
+                m_arrayDepth = 0;
+                m_bArrayDone = true;
+                return;
+            case ',':
+                finishElement(arrElement);
+                return;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                return;
+            default:
+                break;
+            }
+        }
+
+        m_element.append(sym);
+        switch (sym) {
+        case '"':
+            m_bString = true;
+            break;
+        case '{':
+        case '[':
+            ++m_depth;
+            break;
+        case '}':
+        case ']':
+            --m_depth;
+            if(m_depth == m_arrayDepth)
+                finishElement(arrElement);
+            break;
+        default:
+            break;
+        }
+        return;
+    }
+
+    m_header.append(sym);
+    switch (sym) {
+    case '"':
+        m_bString = true;
+        if(m_depth == 1 && m_bExpectKey)
+        {
+            m_bKey = true;
+            m_key.clear();
+        }
+        break;
+    case '{':
+    case '[':
+        ++m_depth;
+        if(m_depth == 1)
+            m_bExpectKey = true;
+        else if(m_depth == 2 && sym == '[' && !m_bKey && !m_bArrayDone && m_key == m_arrayKey)
+            m_arrayDepth = m_depth;
+        break;
+    case '}':
+    case ']':
+        --m_depth;
+        if(m_depth == 0)
+            m_bEnd = true;
+        break;
+    case ':':
+        if(m_depth == 1)
+        {
+            m_bKey = false;
+            m_bExpectKey = false;
+        }
+        break;
+    case ',':
+        if(m_depth == 1)
+        {
+            m_bExpectKey = true;
+            m_key.clear();
+        }
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QJsonObject>
+
+class QIODevice;
+
+///
+/// \brief The CJsonStreamWriter class writes json object with one big array (mob objects) without building document of the whole object.
+/// Other values are written as QJsonDocument does, in the same key order, so the file layout doesn't depend on streaming
+///
+class CJsonStreamWriter
+{
+public:
+    CJsonStreamWriter(QIODevice* pDevice, const QJsonObject& header, const QString& arrayKey);
+    void writeElements(const QList<QByteArray>& arrElement);
+    void finish();
+    static QByteArray elementText(const QJsonObject& obj);
+
+private:
+    QIODevice* m_pDevice;
+    QJsonObject m_tail; // values which keys go after array key
+    int m_count;
+};
+
+///
+/// \brief The CJsonStreamReader class is SAX-style scanner of json object with one big array. The file is read by blocks, elements of array
+/// are returned as raw text by chunks and parsed separately (see parseElements), other values are collected in small header document
+///
+class CJsonStreamReader
+{
+public:
+    CJsonStreamReader(QIODevice* pDevice, const QString& arrayKey);
+    bool readElements(QList<QByteArray>& arrElement, int maxCount);
+    bool hasError() const {return m_bError;}
+    QJsonObject header();
+    static QList<QJsonObject> parseElements(const QList<QByteArray>& arrElement);
+
+private:
+    void scan(char sym, QList<QByteArray>& arrElement);
+    void finishElement(QList<QByteArray>& arrElement);
+
+private:
+    QIODevice* m_pDevice;
+    QByteArray m_arrayKey;
+    QByteArray m_buffer;
+    int m_pos;
+    QByteArray m_header; // document without elements of array
+    QByteArray m_element; // text of current element
+    QByteArray m_key; // key of top level value which is read now
+    int m_depth; // count of opened objects and arrays
+    int m_arrayDepth; // depth inside of streamed array, 0 when outside
+    bool m_bString;
+    bool m_bEscape;
+    bool m_bKey; // top level string is a key
+    bool m_bExpectKey;
+    bool m_bArrayDone;
+    bool m_bEnd;
+    bool m_bError;
+};
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,49 @@
+#include "map_id_index.h"
+#include "node.h"
+
+CMapIdIndex::CMapIdIndex()
+{
+}
+
+void CMapIdIndex::insert(CNode* pNode)
+{
+    m_aNodeById.insert(pNode->mapId(), pNode);
+    m_idAllocator.take(pNode->mapId());
+}
+
+// id is the one node was inserted with, node can already have new one
+void CMapIdIndex::remove(CNode* pNode, uint id)
+{
+    m_aNodeById.remove(id, pNode);
+    if(!m_aNodeById.contains(id)) // duplicated ID is still used by other node
+        m_idAllocator.release(id);
+}
+
+void CMapIdIndex::reindex(CNode* pNode, uint oldId)
+{
+    remove(pNode, oldId);
+    insert(pNode);
+}
+
+// For duplicated IDs the earliest inserted node is returned (QMultiHash keeps the latest insertion first)
+CNode* CMapIdIndex::nodeById(uint id) const
+{
+    CNode* pNode = nullptr;
+    for(auto it = m_aNodeById.constFind(id); it != m_aNodeById.constEnd() && it.key() == id; ++it)
+        pNode = it.value();
+
+    return pNode;
+}
+
+// check of index against node list, every node must be inserted with its current ID
+bool CMapIdIndex::isValid(const QList<CNode*>& arrNode) const
+{
+    if(m_aNodeById.size() != arrNode.size())
+        return false;
+
+    for(auto& pNode : arrNode)
+        if(!m_aNodeById.contains(pNode->mapId(), pNode) || m_idAllocator.isFree(pNode->mapId()))
+            return false;
+
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef MAP_ID_INDEX_H
+#define MAP_ID_INDEX_H
+
+#include <QList>
+#include <QMultiHash>
+
+#include "id_allocator.h"
+
+class CNode;
+
+///
+/// \brief The CMapIdIndex class keeps nodes of mob by map ID and free map IDs in sync: ID is free only while no node has it. Duplicated IDs of read files are allowed, then several nodes are kept for one ID
+///
+class CMapIdIndex
+{
+public:
+    CMapIdIndex();
+    void insert(CNode* pNode);
+    void remove(CNode* pNode, uint id);
+    void reindex(CNode* pNode, uint oldId);
+    CNode* nodeById(uint id) const;
+    bool isFree(uint id) const {return m_idAllocator.isFree(id);}
+    const CIdAllocator& allocator() const {return m_idAllocator;}
+    bool isValid(const QList<CNode*>& arrNode) const;
+
+private:
+    QMultiHash<uint, CNode*> m_aNodeById; // map ID -> node. Several nodes for duplicated IDs only
+    CIdAllocator m_idAllocator; // free map IDs, in sync with m_aNodeById
+};
+
+#endif // MAP_ID_INDEX_H
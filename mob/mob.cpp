@@ -1,5 +1,6 @@
 #include <QDebug>
 #include <QSet>
+#include <QBuffer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -8,6 +9,7 @@
 #include <QDir>
 #include <QMessageBox>
 #include <QHeaderView>
+#include <QtConcurrent>
 
 #include "mob.h"
 #include "utils.h"
@@ -27,10 +29,14 @@
 #include "log.h"
 #include "scene.h"
 #include "layout_components/tree_view.h"
+#include "json_stream.h"
 
 CMob::CMob():
     m_view(nullptr)
   ,m_pProgress(nullptr)
+  ,m_nodeListRevision(1)
+  ,m_selectIndexRevision(0)
+  ,m_spatialIndexRevision(0)
   ,m_bDirty(false)
   ,m_activeRangeId(0)
 {
@@ -82,280 +88,468 @@ const SRange &CMob::activeRange()
     return isQuestMob() ? m_aSecRange[m_activeRangeId] : m_aMainRange[m_activeRangeId];
 }
 
+const QString& CMob::script()
+{
+    if(m_script.isEmpty() && !m_scriptData.isEmpty())
+        util::CMobParser::decryptScript(m_script, m_scriptData, m_scriptKey);
+
+    return m_script;
+}
+
+void CMob::setScript(const QString& script)
+{
+    if(script == CMob::script())
+        return;
+
+    m_script = script;
+    m_scriptData.clear();
+}
+
 void CMob::setActiveRange(uint rangeId)
 {
     m_activeRangeId = rangeId;
 }
 
-bool CMob::deserialize(QByteArray data)
+bool CMob::deserialize(QByteArray& data)
 {
     ei::log(eLogInfo, "Start read mob: " + m_filePath.absoluteFilePath());
     //todo: global check len of nodes
     uint readByte(0);
     util::CMobParser parser(data);
     double step = 50;
-    if (parser.isNextTag("OBJECT_DB_FILE"))
+    if (parser.peekTag() == util::eTagObjectDbFile)
         readByte += parser.skipHeader();
     else
         return false;
 
-    if(parser.isNextTag("SC_OBJECT_DB_FILE"))
+    switch (parser.peekTag()) {
+    case util::eTagScObjectDbFile:
     {
         readByte += parser.skipHeader();
-        //readByte += parser.readHeader();
         m_mobType = eEMobTypeBase;
+        break;
     }
-    else if (parser.isNextTag("PR_OBJECT_DB_FILE"))
+    case util::eTagPrObjectDbFile:
     {
         readByte += parser.skipHeader();
         m_mobType = eEMobTypeQuest;
+        break;
+    }
+    default:
+        break;
     }
 
-    while(true)
+    auto readRanges = [this, &parser, &readByte](bool bMain)
+    {
+        readByte += parser.skipHeader(); // main or secondary range
+        while(parser.peekTag() == util::eTagRange)
+        {
+            SRange range;
+            readByte += parser.skipHeader(); // range
+            if (parser.peekTag() == util::eTagMinId)
+            {
+                readByte += parser.skipHeader();
+                readByte += parser.readDword(range.minRange);
+            }
+            if(parser.peekTag() == util::eTagMaxId)
+            {
+                readByte += parser.skipHeader();
+                readByte += parser.readDword(range.maxRange);
+            }
+            addRange(bMain, range);
+        }
+    };
+
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("SS_TEXT"))
+        switch (parser.peekTag()) {
+        case util::eTagSsText:
         {
+            // script is decoded on first request, see script()
             readByte += parser.readHeader();
-            readByte += parser.readStringEncrypted(m_script, m_scriptKey, parser.nodeLen());
+            readByte += parser.readDword(m_scriptKey);
+            readByte += parser.readByteArray(m_scriptData, parser.nodeLen() - 4);
+            break;
         }
-        else if(parser.isNextTag("SS_TEXT_OLD"))
+        case util::eTagSsTextOld:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_textOld, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("MAIN_RANGE"))
+        case util::eTagMainRange:
         {
-            readByte += parser.skipHeader();
-            while(parser.isNextTag("RANGE"))
-            {
-                SRange range;
-                readByte += parser.skipHeader(); // range
-                if (parser.isNextTag("MIN_ID"))
-                {
-                    readByte += parser.skipHeader();
-                    readByte += parser.readDword(range.minRange);
-                }
-                if(parser.isNextTag("MAX_ID"))
-                {
-                    readByte += parser.skipHeader();
-                    readByte += parser.readDword(range.maxRange);
-                }
-                addRange(true, range);
-            }
+            readRanges(true);
+            break;
         }
-        else if(parser.isNextTag("SEC_RANGE"))
+        case util::eTagSecRange:
         {
-            readByte += parser.skipHeader();
-            while(parser.isNextTag("RANGE"))
-            {
-                SRange range;
-                readByte += parser.skipHeader(); // range
-                if (parser.isNextTag("MIN_ID"))
-                {
-                    readByte += parser.skipHeader();
-                    readByte += parser.readDword(range.minRange);
-                }
-                if(parser.isNextTag("MAX_ID"))
-                {
-                    readByte += parser.skipHeader();
-                    readByte += parser.readDword(range.maxRange);
-                }
-                addRange(false, range);
-            }
+            readRanges(false);
+            break;
         }
-        else if(parser.isNextTag("DIPLOMATION"))
+        case util::eTagDiplomation:
         {
             readByte += parser.skipHeader(); //diplomation
-            while(true)
+            bool bNextDiplomacyTag(true);
+            while(bNextDiplomacyTag)
             {
-                if(parser.isNextTag("DIPLOMATION_FOF"))
+                switch (parser.peekTag()) {
+                case util::eTagDiplomationFof:
                 {
                     readByte += parser.skipHeader();
                     readByte += parser.readDiplomacy(m_diplomacyFoF);
+                    break;
                 }
-                else if(parser.isNextTag("DIPLOMATION_PL_NAMES"))
+                case util::eTagDiplomationPlNames:
                 {
                     readByte += parser.skipHeader();
                     readByte += parser.readStringArray(m_aDiplomacyFieldName);
+                    break;
                 }
-                else {
+                default:
+                {
+                    bNextDiplomacyTag = false;
                     break;
                 }
+                }
             }
+            break;
         }
-        else if(parser.isNextTag("WORLD_SET"))
+        case util::eTagWorldSet:
         {
             readByte += parser.skipHeader(); // world set
-            while(true)
+            bool bNextWorldTag(true);
+            while(bNextWorldTag)
             {
-                if(parser.isNextTag("WS_WIND_DIR"))
+                switch (parser.peekTag()) {
+                case util::eTagWsWindDir:
                 {
                     readByte += parser.skipHeader();
                     QVector3D dir;
                     readByte += parser.readPlot(dir);
                     m_worldSet.setData(eWsTypeWindDir, util::makeString(dir));
+                    break;
                 }
-                else if(parser.isNextTag("WS_WIND_STR"))
+                case util::eTagWsWindStr:
                 {
                     readByte += parser.skipHeader();
                     float str;
                     readByte += parser.readFloat(str);
                     m_worldSet.setData(eWsTypeWindStr, QString::number(str));
+                    break;
                 }
-                else if(parser.isNextTag("WS_TIME"))
+                case util::eTagWsTime:
                 {
                     readByte += parser.skipHeader();
                     float time;
                     readByte += parser.readFloat(time);
                     m_worldSet.setData(eWsTypeTime, QString::number(time));
+                    break;
                 }
-                else if(parser.isNextTag("WS_AMBIENT"))
+                case util::eTagWsAmbient:
                 {
                     readByte += parser.skipHeader();
                     float ambient;
                     readByte += parser.readFloat(ambient);
                     m_worldSet.setData(eWsTypeAmbient, QString::number(ambient));
+                    break;
                 }
-                else if(parser.isNextTag("WS_SUN_LIGHT"))
+                case util::eTagWsSunLight:
                 {
                     readByte += parser.skipHeader();
                     float sunLight;
                     readByte += parser.readFloat(sunLight);
                     m_worldSet.setData(eWsTypeSunLight, QString::number(sunLight));
+                    break;
                 }
-                else {
+                default:
+                {
+                    bNextWorldTag = false;
                     break;
                 }
+                }
             }
+            break;
         }
-
-        //vss section
-        else if(parser.isNextTag("VSS_SECTION"))
+        case util::eTagVssSection:
         {
             readByte += parser.readHeader();
             readByte += parser.readByteArray(m_vss_section, parser.nodeLen());
+            break;
         }
-
-        //dirictory
-        else if(parser.isNextTag("DIRICTORY"))
+        case util::eTagDirictory:
         {
             readByte += parser.readHeader();
             readByte += parser.readByteArray(m_directory, parser.nodeLen());
+            break;
         }
-
-        //dirictory elements
-        else if(parser.isNextTag("DIRICTORY_ELEMENTS"))
+        case util::eTagDirictoryElements:
         {
             readByte += parser.readHeader();
             readByte += parser.readByteArray(m_directoryElements, parser.nodeLen());
+            break;
         }
-        //object section
-        else if(parser.isNextTag("OBJECT_SECTION"))
+        case util::eTagObjectSection:
         {
             step = step/3;
             m_pProgress->update(step);
-            uint objSecLen = parser.nodeLen();
-            uint readSecByte(0);
-            readByte += parser.skipHeader(); // object section
-            while(readSecByte < objSecLen)
-            {
-                if(parser.isNextTag("OBJECT"))
-                {
-                    CWorldObj* obj = new CWorldObj();
-                    readSecByte += parser.skipHeader(); // "OBJECT";
-                    readSecByte += obj->deserialize(parser);
-                    addNode(obj);
-                }
-                else if (parser.isNextTag("LEVER"))
-                {
-                    CLever* lever = new CLever();
-                    readSecByte += parser.skipHeader(); // "LEVER";
-                    readSecByte += lever->deserialize(parser);
-                    addNode(lever);
-                }
-                else if (parser.isNextTag("UNIT"))
-                {
-                    CUnit* unit = new CUnit();
-                    readSecByte += parser.skipHeader(); // "UNIT";
-                    readSecByte += unit->deserialize(parser);
-                    addNode(unit);
-                }
-                else if (parser.isNextTag("TORCH"))
-                {
-                    CTorch* torch = new CTorch();
-                    readSecByte += parser.skipHeader(); // "TORCH";
-                    readSecByte += torch->deserialize(parser);
-                    addNode(torch);
-                }
-                else if (parser.isNextTag("MAGIC_TRAP"))
-                {
-                    CMagicTrap* trap = new CMagicTrap();
-                    readSecByte += parser.skipHeader();  // "MAGIC_TRAP";
-                    readSecByte += trap->deserialize(parser);
-                    addNode(trap);
-                }
-                else if(parser.isNextTag("LIGHT"))
-                {
-                    CLight* light = new CLight();
-                    readByte += parser.skipHeader(); // "LIGHT";
-                    readByte += light->deserialize(parser);
-                    addNode(light);
-                }
-                else if(parser.isNextTag("SOUND"))
-                {
-                    CSound* sound = new CSound();
-                    readByte += parser.skipHeader(); // "SOUND";
-                    readByte += sound->deserialize(parser);
-                    addNode(sound);
-                }
-                else if(parser.isNextTag("PARTICL"))
-                {
-                    CParticle* particle = new CParticle();
-                    readByte += parser.skipHeader(); // "PARTICL";
-                    readByte += particle->deserialize(parser);
-                    addNode(particle);
-                }
-                else {
-                    auto a = parser.nextTag();
-                    break;
-                }
-            }
-            Q_ASSERT(readSecByte <= objSecLen);
-            readByte += readSecByte;
+            readByte += parser.readHeader(); // object section
+            readByte += deserializeObjects(parser, data, parser.nodeLen());
             m_pProgress->update(step);
+            break;
         }
-        else if (parser.isNextTag("LIGHT_SECTION"))
+        case util::eTagLightSection:
         {
             Q_ASSERT("light section" && false);
             readByte += parser.skipTag();
+            break;
         }
-        else if (parser.isNextTag("PARTICL_SECTION"))
+        case util::eTagParticlSection:
         {
             Q_ASSERT("particle section" && false);
             readByte += parser.skipTag();
+            break;
         }
-        else if (parser.isNextTag("SOUND_SECTION"))
+        case util::eTagSoundSection:
         {
             Q_ASSERT("sound section" && false);
             readByte += parser.skipTag();
+            break;
         }
-        else if(parser.isNextTag("AI_GRAPH"))
+        case util::eTagAiGraph:
         {
             readByte += parser.readHeader();
             readByte += parser.readAiGraph(m_aiGraph, parser.nodeLen());
+            break;
         }
-        else
+        default:
         {
-            auto a = parser.nextTag();
-            Q_ASSERT(parser.nextTag() == "ROOT"); // zone3obr.mob has current code
+            Q_ASSERT(parser.peekTag() == util::eTagRoot); // zone3obr.mob has current code
+            bNextTag = false;
             break;
         }
+        }
     }
     m_pProgress->update(step);
     ei::log(eLogInfo, "End read mob");
     return true;
 }
 
+// byte range of one object node inside of OBJECT_SECTION
+struct SObjectRange
+{
+    util::EMobTag tag;
+    int offset;
+    int len;
+    CNode* pNode;
+    QByteArray rawData;
+};
+
+static CNode* createObject(util::EMobTag tag)
+{
+    switch (tag) {
+    case util::eTagObject:
+        return new CWorldObj();
+    case util::eTagLever:
+        return new CLever();
+    case util::eTagUnit:
+        return new CUnit();
+    case util::eTagTorch:
+        return new CTorch();
+    case util::eTagMagicTrap:
+        return new CMagicTrap();
+    case util::eTagLight:
+        return new CLight();
+    case util::eTagSound:
+        return new CSound();
+    case util::eTagParticl:
+        return new CParticle();
+    default:
+        return nullptr;
+    }
+}
+
+// Node of json clipboard (old editor versions). Node type is in base object which is inside of world object for inherited nodes
+static CNode* createObject(const QJsonObject& data)
+{
+    QJsonObject wo = data;
+    if (data.find("World object") != data.end())
+        wo = wo["World object"].toObject();
+
+    const QJsonObject base = wo["Base object"].toObject();
+    switch ((ENodeType)base["Node type"].toInt(0))
+    {
+    case ENodeType::eUnit:
+        return new CUnit(data);
+    case ENodeType::eTorch:
+        return new CTorch(data);
+    case ENodeType::eMagicTrap:
+        return new CMagicTrap(data);
+    case ENodeType::eLever:
+        return new CLever(data);
+    case ENodeType::eLight:
+        return new CLight(data);
+    case ENodeType::eSound:
+        return new CSound(data);
+    case ENodeType::eParticle:
+        return new CParticle(data);
+    case ENodeType::eWorldObject:
+        return new CWorldObj(data);
+    default:
+        return nullptr;
+    }
+}
+
+// Objects are independent length-prefixed nodes. Their ranges are collected first, then nodes are created here,
+// filled from their own ranges in parallel and finished (sub-objects, GL data, signals) on main thread in file order.
+// Nodes read from file keep their original bytes to be saved without re-encoding while they are not modified
+static uint readObjectNodes(util::CMobParser& parser, const QByteArray& data, uint sectionLen, QList<CNode*>& arrNode, bool bKeepRawData)
+{
+    QVector<SObjectRange> arrRange;
+    uint readSecByte(0);
+    while(readSecByte < sectionLen)
+    {
+        SObjectRange range;
+        range.tag = parser.peekTag();
+        if(!parser.isNextNodeInBounds())
+        {
+            ei::log(eLogWarning, QString("Object node at %1 exceeds file size, objects reading stopped").arg(parser.pos()));
+            break;
+        }
+
+        range.pNode = createObject(range.tag);
+        if(!range.pNode)
+            break;
+
+        range.offset = int(parser.pos());
+        range.len = int(parser.skipTag());
+        readSecByte += uint(range.len);
+        arrRange.append(range);
+    }
+    Q_ASSERT(readSecByte <= sectionLen);
+
+    QtConcurrent::blockingMap(arrRange, [&data, bKeepRawData](SObjectRange& range)
+    {
+        QByteArray objData(QByteArray::fromRawData(data.constData() + range.offset, range.len));
+        util::CMobParser objParser(objData);
+        objParser.skipHeader();
+        range.pNode->deserialize(objParser);
+        if(bKeepRawData)
+            range.rawData = QByteArray(objData.constData(), objData.size()); // deep copy, objData refers to file buffer
+    });
+
+    for(auto& range : arrRange)
+    {
+        range.pNode->deserializeChildren();
+        if(bKeepRawData)
+            range.pNode->setRawData(range.rawData); // the node is written back as is until it's changed
+        arrNode.append(range.pNode);
+    }
+    return readSecByte;
+}
+
+uint CMob::deserializeObjects(util::CMobParser& parser, const QByteArray& data, uint sectionLen)
+{
+    QList<CNode*> arrNode;
+    const uint readSecByte = readObjectNodes(parser, data, sectionLen, arrNode, true);
+    addNode(arrNode);
+    return readSecByte;
+}
+
+// Encodes nodes as records of OBJECT_SECTION, used by clipboard
+QByteArray CMob::serializeNodes(const QList<CNode*>& arrNode)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    util::CMobParser parser(&buffer);
+    auto writeNodes = [&parser, &arrNode]()
+    {
+        for(auto& pNode : arrNode)
+        {
+            const QByteArray rawData = pNode->rawData();
+            if(rawData.isEmpty())
+                pNode->serialize(parser);
+            else
+                parser.writeByteArray(rawData, uint(rawData.size()));
+        }
+    };
+    writeNodes();
+    parser.startWritePass();
+    writeNodes();
+    if(!parser.finishWritePass())
+        ei::log(eLogWarning, "Node data is written with wrong section sizes");
+    return data;
+}
+
+// Converts json objects to serializeNodes data by chunks: texts of chunk are parsed in parallel, nodes are created on main thread
+// (units create logic QObjects) and are encoded and deleted at once, so neither the whole json document nor all nodes are kept in memory
+QByteArray CMob::jsonNodesToData(CJsonStreamReader& reader, int& nNode)
+{
+    const int chunkSize = 1024;
+    QByteArray data;
+    nNode = 0;
+    QList<QByteArray> arrText;
+    while(reader.readElements(arrText, chunkSize))
+    {
+        QList<CNode*> arrNode;
+        for(const auto& obj : CJsonStreamReader::parseElements(arrText))
+        {
+            CNode* pNode = createObject(obj);
+            if(pNode)
+                arrNode.append(pNode);
+            else
+                ei::log(eLogWarning, "Unknown node type in json data");
+        }
+        data += serializeNodes(arrNode);
+        nNode += arrNode.size();
+        qDeleteAll(arrNode);
+        arrText.clear();
+    }
+    return data;
+}
+
+// Creates nodes from serializeNodes data. All new nodes get free map IDs at once and become selected
+QList<CNode*> CMob::createNodes(QByteArray& data)
+{
+    QList<CNode*> arrNode;
+    util::CMobParser parser(data);
+    readObjectNodes(parser, data, uint(data.size()), arrNode, false);
+
+    const QVector<uint> arrId = freeMapIds(arrNode.size());
+    for(int i(0); i<arrNode.size(); ++i)
+    {
+        CNode* pNode = arrNode[i];
+        pNode->loadFigure();
+        pNode->loadTexture();
+        pNode->setMapId(arrId[i]);
+        pNode->setState(ENodeState::eSelect);
+    }
+    addNode(arrNode);
+    Q_ASSERT(isNodeIndexValid());
+    Q_ASSERT(isLogicIndexValid());
+    return arrNode;
+}
+
+void CMob::undo_createNodes(const QVector<uint>& arrMapId)
+{
+    const QSet<uint> aId = arrMapId.toList().toSet();
+    QSet<CNode*> aRemoved;
+    for(int i(m_aNode.size()-1); i>=0; --i)
+        if(aId.contains(m_aNode[i]->mapId()))
+        {
+            aRemoved.insert(m_aNode[i]);
+            removeFromIndex(m_aNode[i], m_aNode[i]->mapId());
+            m_aNode.removeAt(i);
+        }
+    removeLogicNodes(aRemoved);
+    qDeleteAll(aRemoved); // redo creates them again from clipboard data
+    Q_ASSERT(isNodeIndexValid());
+    Q_ASSERT(isLogicIndexValid());
+    ei::log(eLogDebug, QString("undo create %1 nodes").arg(arrMapId.size()));
+}
+
 void CMob::updateObjects()
 {
     ei::log(eLogInfo, "Start update " + QString::number(m_aNode.size())+ " objects");
@@ -377,36 +571,95 @@ void CMob::delNodes()
         if(m_aNode[i]->nodeState() & ENodeState::eSelect)
             aInd.append(i);
     }
-    //aInd.
+    QSet<CNode*> aRemoved;
+    for(auto& ind : aInd)
+        aRemoved.insert(m_aNode[ind]);
+
+    removeLogicNodes(aRemoved);
     for (auto i = aInd.crbegin(); i != aInd.crend(); ++i)
     {
+        removeFromIndex(m_aNode[*i], m_aNode[*i]->mapId());
         delete m_aNode[*i];
         m_aNode.removeAt(*i);
     }
-    logicNodesUpdate();
+    Q_ASSERT(isLogicIndexValid());
 }
 
+// For duplicated IDs the earliest added node is returned
 CNode *CMob::nodeByMapId(uint id)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aNode)
+    return m_mapIdIndex.nodeById(id);
+}
+
+bool CMob::isFreeId(const uint id)
+{
+    //todo: add check for ranges (ranges is not necessary property of mob file)
+    return isFreeMapId(id);
+}
+
+void CMob::addNode(QList<CNode*>& aNode)
+{
+    m_aNode.append(aNode);
+    for(auto& pNode : aNode)
     {
-        if(pNode->mapId()==id)
-            break;
+        m_mapIdIndex.insert(pNode);
+        m_selectIndex.invalidate(pNode);
+        m_spatialIndex.invalidate(pNode);
+        collectLogicNodes(pNode, m_aLogicNode, m_aLogicIndex);
     }
-    return pNode;
+    ++m_nodeListRevision;
 }
 
-bool CMob::isFreeId(const uint id)
+void CMob::addNode(CNode* aNode)
 {
-    QVector<uint> arrId;
-    for(auto& node: m_aNode)
+    m_aNode.append(aNode);
+    m_mapIdIndex.insert(aNode);
+    m_selectIndex.invalidate(aNode);
+    m_spatialIndex.invalidate(aNode);
+    collectLogicNodes(aNode, m_aLogicNode, m_aLogicIndex);
+    ++m_nodeListRevision;
+}
+
+// Index is refreshed only if any node was changed (CNode::setModified, setDrawPosition), added or removed since the last query.
+// Refresh re-reads only changed nodes
+const CSelectIndex& CMob::selectIndex()
+{
+    if(m_selectIndexRevision != indexRevision())
     {
-        if(node->mapId() == id)
-            return false;
+        m_selectIndex.refresh(m_aNode);
+        m_selectIndexRevision = indexRevision();
     }
-    //todo: add check for ranges (ranges is not necessary property of mob file)
-    return true;
+    return m_selectIndex;
+}
+
+// call after projecting nodes on landscape, boxes are built by draw position
+const CSpatialIndex& CMob::spatialIndex()
+{
+    if(m_spatialIndexRevision != indexRevision())
+    {
+        m_spatialIndex.refresh(m_aNode);
+        m_spatialIndexRevision = indexRevision();
+    }
+    return m_spatialIndex;
+}
+
+// Map ID index must be updated by everyone who changes ID of node in the mob
+void CMob::reindexNode(CNode* pNode, uint oldId)
+{
+    ++m_nodeListRevision;
+    m_mapIdIndex.reindex(pNode, oldId);
+}
+
+void CMob::removeFromIndex(CNode* pNode, uint id)
+{
+    ++m_nodeListRevision;
+    m_mapIdIndex.remove(pNode, id);
+}
+
+// debug check of map ID index against node list
+bool CMob::isNodeIndexValid()
+{
+    return m_mapIdIndex.isValid(m_aNode);
 }
 
 QString CMob::mobName()
@@ -431,47 +684,62 @@ void CMob::clearRanges(bool bMain)
     bMain ? m_aMainRange.clear() : m_aSecRange.clear();
 }
 
-void CMob::getPatrolHash(int &unitMapIdOut, int &pointIdOut, CPatrolPoint *pPoint)
+// O(1) by index of logic nodes. Index is rebuilt once if logic of unit was changed outside of mob
+SLogicHandle CMob::logicHandle(CNode* pNode)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eUnit)
-        {
-            CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
-            int index = pUnit->getPatrolId(pPoint);
-            if(index >=0)
-            {
-                unitMapIdOut = pUnit->mapId();
-                pointIdOut = index;
-                return;
-            }
-        }
-    }
-    return;
+    if(pNode->nodeType() == eUnit || pNode->nodeType() == eMagicTrap)
+        return SLogicHandle{eLogicHandleObject, pNode->mapId(), -1, -1};
+
+    if(!m_aLogicIndex.contains(pNode))
+        logicNodesUpdate();
+
+    Q_ASSERT(m_aLogicIndex.contains(pNode) && "logic node is not indexed");
+    const SLogicIndex index = m_aLogicIndex.value(pNode);
+    return SLogicHandle{index.type, index.pOwner->mapId(), index.pointId, index.viewId};
 }
 
-void CMob::getViewHash(int &unitMapIdOut, int &pointIdOut, int &viewIdOut, CLookPoint *pPoint)
+CNode* CMob::nodeByLogicHandle(const SLogicHandle& handle)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
+    CNode* pNode = nodeByMapId(handle.mapId);
+    if(!pNode)
     {
-        if(pNode->nodeType() != eUnit)
-            continue;
+        Q_ASSERT(false && "cant find logic owner by map id");
+        return nullptr;
+    }
 
-        int parentPatrol;
-        int parentView;
+    switch (handle.type) {
+    case eLogicHandleObject:
+        return pNode;
+    case eLogicHandlePatrol:
+    {
         CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
-        pUnit->getViewId(parentPatrol, parentView, pPoint);
-        if(parentPatrol >=0)
-        {
-            unitMapIdOut = pUnit->mapId();
-            pointIdOut = parentPatrol;
-            viewIdOut = parentView;
-            return;
-        }
+        Q_ASSERT(pUnit);
+        return pUnit->patrolByIndex(handle.pointId);
     }
-    return;
+    case eLogicHandleView:
+    {
+        CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
+        Q_ASSERT(pUnit);
+        CPatrolPoint* pPatrol = pUnit->patrolByIndex(handle.pointId);
+        if(!pPatrol)
+            return nullptr;
+
+        return pPatrol->viewByIndex(handle.viewId);
+    }
+    case eLogicHandleTrapZone:
+    {
+        CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
+        Q_ASSERT(pTrap);
+        return pTrap->actZoneById(handle.pointId);
+    }
+    case eLogicHandleTrapCast:
+    {
+        CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
+        Q_ASSERT(pTrap);
+        return pTrap->castPointById(handle.pointId);
+    }
+    }
+    return nullptr;
 }
 
 int CMob::getPatrolId(uint unitMapId, CPatrolPoint* pPoint)
@@ -488,368 +756,236 @@ int CMob::getPatrolId(uint unitMapId, CPatrolPoint* pPoint)
     return -1;
 }
 
-void CMob::createPatrolByHash(QString hash)
+void CMob::createPatrolByHandle(const SLogicHandle& handle)
 {
-    QStringList list = hash.split(".");
-    if(list.size()<2)
+    CUnit* pUnit = dynamic_cast<CUnit*>(nodeByMapId(handle.mapId));
+    if(!pUnit)
     {
-        ei::log(eLogWarning, "Creating logic point failed. hash incorrect" + hash);
+        ei::log(eLogWarning, "Creating logic point failed. Unit not found: " + QString::number(handle.mapId));
+        return;
     }
 
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eUnit && pNode->mapId() == list[0].toUInt())
-        {
-            CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
-            if(list.size()==2)
-                pUnit->createPatrolByIndex(list[1].toInt());
-            else if(list.size()==3)
-                pUnit->createViewByIndex(list[1].toInt(), list[2].toInt());
+    if(handle.type == eLogicHandlePatrol)
+        pUnit->createPatrolByIndex(handle.pointId);
+    else if(handle.type == eLogicHandleView)
+        pUnit->createViewByIndex(handle.pointId, handle.viewId);
 
-            break;
-        }
-    }
-
-    logicNodesUpdate();
+    logicNodesUpdate(pUnit);
 }
 
-void CMob::undo_createPatrolByHash(QString hash)
+void CMob::undo_createPatrolByHandle(const SLogicHandle& handle)
 {
-    QStringList list = hash.split(".");
-    if(list.size()==2) // patrol point
-    {
-        CNode* pNode = nullptr;
-        foreach(pNode, m_aLogicNode)
-        {
-            if(pNode->nodeType() == eUnit && pNode->mapId() == list[0].toUInt())
-            {
-                CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
-                pUnit->undo_createPatrolByIndex(list[1].toInt());
-                break;
-            }
-        }
-    }
-    else if(list.size()==3)
-    {
-        CNode* pNode = nullptr;
-        foreach(pNode, m_aLogicNode)
-        {
-            if(pNode->nodeType() == eUnit && pNode->mapId() == list[0].toUInt())
-            {
-                CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
-                pUnit->undo_createViewByIndex(list[1].toInt(), list[2].toInt());
-                break;
-            }
-        }
-    }
-    logicNodesUpdate();
+    CUnit* pUnit = dynamic_cast<CUnit*>(nodeByMapId(handle.mapId));
+    Q_ASSERT(pUnit);
+    if(handle.type == eLogicHandlePatrol)
+        pUnit->undo_createPatrolByIndex(handle.pointId);
+    else if(handle.type == eLogicHandleView)
+        pUnit->undo_createViewByIndex(handle.pointId, handle.viewId);
+
+    logicNodesUpdate(pUnit);
 }
 
-CPatrolPoint *CMob::patrolPointById(int unitId, int patrolId)
+uint CMob::trapIdByPoint(CActivationZone *pZone)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eUnit && pNode->mapId() == (uint)unitId)
-        {
-            CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
-            return pUnit->patrolByIndex(patrolId);
-        }
-    }
-    Q_ASSERT(false && "cant find patrol point by unit map id");
-    return nullptr;
+    return logicHandle(pZone).mapId;
 }
 
-CLookPoint *CMob::viewPointById(int unitId, int patrolId, int viewId)
+uint CMob::trapIdByPoint(CTrapCastPoint *pPoint)
 {
-    CPatrolPoint* pPoint = patrolPointById(unitId, patrolId);
-    return pPoint->viewByIndex(viewId);
+    return logicHandle(pPoint).mapId;
 }
 
-void CMob::getTrapZoneHash(int &unitMapIdOut, int &zoneIdOut, CActivationZone *pZone)
+void CMob::undo_createNode(uint mapId)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eMagicTrap)
-        {
-            CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
-            int index = pTrap->getZoneId(pZone);
-            if(index >=0)
-            {
-                unitMapIdOut = pTrap->mapId();
-                zoneIdOut = index;
-                return;
-            }
-        }
-    }
-    return;
-}
+    CNode* pNode = nodeByMapId(mapId);
+    if(nullptr == pNode)
+        return;
 
-CActivationZone *CMob::actZoneById(int trapId, int zoneId)
-{
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eMagicTrap && pNode->mapId() == (uint)trapId)
-        {
-            CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
-            return pTrap->actZoneById(zoneId);
-        }
-    }
-    Q_ASSERT(false && "cant find act zone by trap map id");
-    return nullptr;
+    // created nodes are at the end of list
+    //m_aDeletedNode.append(pNode);
+    m_aNode.removeAt(m_aNode.lastIndexOf(pNode));
+    removeFromIndex(pNode, mapId);
+    removeLogicNodes(pNode);
+    ei::log(eLogDebug, QString("undo create node with %1 map ID").arg(pNode->mapId()));
+    delete pNode; // redo creates it again from node data
 }
 
-void CMob::getTrapCastHash(int &unitMapIdOut, int &pointIdOut, CTrapCastPoint* pCast)
+QList<CNode*>& CMob::nodes()
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eMagicTrap)
-        {
-            CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
-            int index = pTrap->getCastPointId(pCast);
-            if(index >=0)
-            {
-                unitMapIdOut = pTrap->mapId();
-                pointIdOut = index;
-                return;
-            }
-        }
-    }
-    return;
+    return m_aNode;
 }
 
-CTrapCastPoint *CMob::trapCastById(int trapId, int pointId)
+// Logic nodes are tracked by addNode and removing of nodes. Unit (trap) is followed by its logic points in the list
+QList<CNode *> &CMob::logicNodes()
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eMagicTrap && pNode->mapId() == (uint)trapId)
-        {
-            CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
-            return pTrap->castPointById(pointId);
-        }
-    }
-    Q_ASSERT(false && "cant find cast point by trap map id");
-    return nullptr;
+    return m_aLogicNode;
 }
 
-uint CMob::trapIdByPoint(CActivationZone *pZone)
+// full rebuild, it's needed when logic of units is changed outside of mob
+void CMob::logicNodesUpdate()
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
-    {
-        if(pNode->nodeType() == eMagicTrap)
-        {
-            CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
-            int index = pTrap->actZones().indexOf(pZone);
-            if(index >=0)
-                return pTrap->mapId();
-        }
-    }
-    Q_ASSERT(false);
-    return 0;
+    m_aLogicNode.clear();
+    m_aLogicIndex.clear();
+    for(auto& pNode : m_aNode)
+        collectLogicNodes(pNode, m_aLogicNode, m_aLogicIndex);
 }
 
-uint CMob::trapIdByPoint(CTrapCastPoint *pPoint)
+// rebuilds logic points of single unit (trap) in place
+void CMob::logicNodesUpdate(CNode* pOwner)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aLogicNode)
+    const int pos = removeLogicNodes(pOwner);
+    if(pos < 0)
     {
-        if(pNode->nodeType() == eMagicTrap)
-        {
-            CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
-            int index = pTrap->castPoints().indexOf(pPoint);
-            if(index >=0)
-                return pTrap->mapId();
-        }
+        Q_ASSERT(false && "logic owner is not tracked");
+        return;
     }
-    Q_ASSERT(false);
-    return 0;
-}
-
-CNode* CMob::createNode(QJsonObject data)
-{
-    auto wo = data;
-    if (data.find("World object") != data.end())
-        wo = wo["World object"].toObject();
 
-    auto base = wo["Base object"].toObject();
+    QList<CNode*> arrNode;
+    collectLogicNodes(pOwner, arrNode, m_aLogicIndex);
+    for(int i(0); i<arrNode.size(); ++i)
+        m_aLogicNode.insert(pos + i, arrNode[i]);
 
-    CNode* pNode = nullptr;
-    ENodeType type = (ENodeType)base["Node type"].toInt(0);
-    if (type == ENodeType::eUnknown)
-    {
-        qDebug() << "cant recognize type of obj";
-        return pNode;
-    }
+    Q_ASSERT(isLogicIndexValid());
+}
 
-    switch (type)
+// appends unit (trap) and its logic points. Returns false for nodes without logic
+bool CMob::collectLogicNodes(CNode* pNode, QList<CNode*>& arrNode, QHash<CNode*, SLogicIndex>& aIndex)
+{
+    ENodeType type = pNode->nodeType();
+    switch(type)
     {
     case ENodeType::eUnit:
     {
-        pNode = new CUnit(data);
-        pNode->loadFigure();
-        pNode->loadTexture();
-        break;
-    }
-    case ENodeType::eTorch:
-    {
-        pNode = new CTorch(data);
-        pNode->loadFigure();
-        pNode->loadTexture();
-        break;
+        arrNode.append(pNode);
+        CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
+        Q_ASSERT(pUnit);
+        const int first = arrNode.size();
+        pUnit->collectLogicNodes(arrNode);
+        // patrol point is followed by its look points, see CLogic::collectPatrolNodes
+        int patrolId(-1);
+        int viewId(-1);
+        for(int i(first); i<arrNode.size(); ++i)
+        {
+            if(arrNode[i]->nodeType() == ePatrolPoint)
+            {
+                ++patrolId;
+                viewId = -1;
+                aIndex.insert(arrNode[i], SLogicIndex{pNode, eLogicHandlePatrol, patrolId, -1});
+            }
+            else
+                aIndex.insert(arrNode[i], SLogicIndex{pNode, eLogicHandleView, patrolId, ++viewId});
+        }
+        return true;
     }
     case ENodeType::eMagicTrap:
     {
-        pNode = new CMagicTrap(data);
-        break;
-    }
-    case ENodeType::eLever:
-    {
-        pNode = new CLever(data);
-        pNode->loadFigure();
-        pNode->loadTexture();
-        break;
-    }
-    case ENodeType::eLight:
-    {
-        pNode = new CLight(data);
-        break;
-    }
-    case ENodeType::eSound:
-    {
-        pNode = new CSound(data);
-        break;
-    }
-    case ENodeType::eParticle:
-    {
-        pNode = new CParticle(data);
-        break;
-    }
-    case ENodeType::eWorldObject:
-    {
-        pNode = new CWorldObj(data);
-        pNode->loadFigure();
-        pNode->loadTexture();
-        break;
+        arrNode.append(pNode);
+        CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
+        pTrap->collectLogicNodes(arrNode);
+        for(int i(0); i<pTrap->actZones().size(); ++i)
+            aIndex.insert(pTrap->actZones()[i], SLogicIndex{pNode, eLogicHandleTrapZone, i, -1});
+
+        for(int i(0); i<pTrap->castPoints().size(); ++i)
+            aIndex.insert(pTrap->castPoints()[i], SLogicIndex{pNode, eLogicHandleTrapCast, i, -1});
+
+        return true;
     }
     default:
-    {
-        Q_ASSERT("unknown node type" && false);
         break;
     }
-    }
-
-    if(nullptr == pNode)
-    {
-        Q_ASSERT("Failed to create new node" && false);
-    }
-
-    addNode(pNode);
-    logicNodesUpdate();
+    return false;
+}
 
-    if(nullptr == pNode)
-        return nullptr;
+// removes unit (trap) with its logic points, returns former position in logic list or -1
+int CMob::removeLogicNodes(CNode* pOwner)
+{
+    if(pOwner->nodeType() != eUnit && pOwner->nodeType() != eMagicTrap)
+        return -1;
 
-    pNode->setMapId(freeMapId());
-    pNode->setState(ENodeState::eSelect);
+    const int pos = m_aLogicNode.indexOf(pOwner);
+    if(pos < 0)
+        return -1;
 
+    int end(pos + 1);
+    for(; end < m_aLogicNode.size(); ++end)
+    {
+        auto it = m_aLogicIndex.constFind(m_aLogicNode[end]);
+        if(it == m_aLogicIndex.constEnd() || it->pOwner != pOwner)
+            break;
 
-    return pNode;
+        m_aLogicIndex.remove(m_aLogicNode[end]);
+    }
+    m_aLogicNode.erase(m_aLogicNode.begin() + pos, m_aLogicNode.begin() + end);
+    return pos;
 }
 
-void CMob::undo_createNode(uint mapId)
+// one pass over logic list for removing of several units (traps)
+void CMob::removeLogicNodes(const QSet<CNode*>& aOwner)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aNode)
+    int count(0);
+    for(int i(0); i<m_aLogicNode.size(); ++i)
     {
-        if(pNode->mapId() == mapId)
+        CNode* pNode = m_aLogicNode[i];
+        auto it = m_aLogicIndex.constFind(pNode);
+        CNode* pOwner = it == m_aLogicIndex.constEnd() ? pNode : it->pOwner;
+        if(aOwner.contains(pOwner))
         {
-            //m_aDeletedNode.append(pNode);
-            m_aNode.removeAt(m_aNode.indexOf(pNode));
-            ei::log(eLogDebug, QString("undo create node with %1 map ID").arg(pNode->mapId()));
-            return;
+            if(pOwner != pNode)
+                m_aLogicIndex.remove(pNode);
+            continue;
         }
+        m_aLogicNode[count++] = pNode;
     }
+    m_aLogicNode.erase(m_aLogicNode.begin() + count, m_aLogicNode.end());
 }
 
-QList<CNode*>& CMob::nodes()
+// debug check of incremental logic list against full rebuild
+bool CMob::isLogicIndexValid()
 {
-    return m_aNode;
-}
+    QList<CNode*> arrNode;
+    QHash<CNode*, SLogicIndex> aIndex;
+    for(auto& pNode : m_aNode)
+        collectLogicNodes(pNode, arrNode, aIndex);
 
-QList<CNode *> &CMob::logicNodes()
-{
-    //collect logic nodes
-    if(m_aLogicNode.isEmpty()) //can be optimized but need to control add\delete nodes/patrol points\view
-        logicNodesUpdate();
-
-    return m_aLogicNode;
-}
-
-void CMob::logicNodesUpdate()
-{
-    m_aLogicNode.clear();
+    if(arrNode != m_aLogicNode || aIndex.size() != m_aLogicIndex.size())
+        return false;
 
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aNode)
+    for(auto it = aIndex.constBegin(); it != aIndex.constEnd(); ++it)
     {
-        ENodeType type = pNode->nodeType();
-        switch(type)
-        {
-        case ENodeType::eUnit:
-        {
-            m_aLogicNode.append(pNode);
-            CUnit* pUnit = dynamic_cast<CUnit*>(pNode);
-            Q_ASSERT(pUnit);
-            pUnit->collectLogicNodes(m_aLogicNode);
-            break;
-        }
-        case ENodeType::eMagicTrap:
-        {
-            m_aLogicNode.append(pNode);
-            CMagicTrap* pTrap = dynamic_cast<CMagicTrap*>(pNode);
-            pTrap->collectLogicNodes(m_aLogicNode);
-            break;
-        }
-        default:
-            break;
-        }
+        auto itOwn = m_aLogicIndex.constFind(it.key());
+        if(itOwn == m_aLogicIndex.constEnd() || !(itOwn.value() == it.value()))
+            return false;
     }
+    return true;
 }
 
 void CMob::deleteNode(uint mapId)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aNode)
-    {
-        if(pNode->mapId() == mapId)
-        {
-            pNode->setState(ENodeState::eDraw); // for restoring draw state
-            m_aDeletedNode.append(pNode);
-            m_aNode.removeOne(pNode);
-            ei::log(eLogDebug, QString("delete node with %1").arg(pNode->mapId()));
-            logicNodesUpdate();
-            break;
-        }
-    }
+    CNode* pNode = nodeByMapId(mapId);
+    if(nullptr == pNode)
+        return;
+
+    pNode->setState(ENodeState::eDraw); // for restoring draw state
+    m_aDeletedNode.append(pNode);
+    m_aNode.removeOne(pNode);
+    removeFromIndex(pNode, mapId);
+    removeLogicNodes(pNode);
+    ei::log(eLogDebug, QString("delete node with %1").arg(pNode->mapId()));
+    Q_ASSERT(isLogicIndexValid());
 }
 
 CNode *CMob::undo_deleteNode(uint mapId)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aDeletedNode)
+    // undo restores nodes in reverse order of deleting, so the search starts from the last deleted one
+    for(int i(m_aDeletedNode.size()-1); i>=0; --i)
     {
+        CNode* pNode = m_aDeletedNode[i];
         if(pNode->mapId() == mapId)
         {
-            m_aNode.append(pNode);
-            m_aDeletedNode.removeOne(pNode);
+            addNode(pNode);
+            m_aDeletedNode.removeAt(i);
             ei::log(eLogDebug, QString("node with %1 restored").arg(pNode->mapId()));
-            logicNodesUpdate();
+            Q_ASSERT(isLogicIndexValid());
             return pNode;
         }
     }
@@ -872,7 +1008,19 @@ int CMob::readMob(QFileInfo &path)
             return 2;
         }
 
-        deserialize(file.readAll());
+        // parse directly from file mapping, nodes copy the data they keep. Fall back to reading when mapping is not available
+        uchar* pMap = file.size() > 0 ? file.map(0, file.size()) : nullptr;
+        if(pMap)
+        {
+            QByteArray data(QByteArray::fromRawData(reinterpret_cast<const char*>(pMap), int(file.size())));
+            deserialize(data);
+            file.unmap(pMap);
+        }
+        else
+        {
+            QByteArray data(file.readAll());
+            deserialize(data);
+        }
 
         file.close();
     }
@@ -887,8 +1035,9 @@ int CMob::readMob(QFileInfo &path)
         QMessageBox::warning(nullptr, "Map checker", "Mob file contains objects with duplicate IDs. It's not a valid file. IDs will be generated from available IDs for correct operation. You can see the details in the log.");
         autoFixDuplicateId(arrId);
     }
+    Q_ASSERT(isNodeIndexValid());
+    Q_ASSERT(isLogicIndexValid());
     updateObjects();
-    logicNodesUpdate();
     return 0;
 }
 
@@ -982,74 +1131,44 @@ void CMob::writeData(QJsonObject& mob, const QFileInfo& file, const QString key,
 
 bool CMob::isFreeMapId(uint id)
 {
-    CNode* pNode = nullptr;
-    foreach(pNode, m_aNode)
-    {
-        if(pNode->mapId() == id)
-            return false;
-    }
-    return true;
+    return m_mapIdIndex.isFree(id);
 }
 
 uint CMob::freeMapId()
 {
-    uint id = 0; //future map ID
+    return freeMapId(m_mapIdIndex.allocator());
+}
+
+uint CMob::freeMapId(const CIdAllocator& allocator)
+{
     // try to find suit id from active range
-    const SRange& range = activeRange();
-    for(uint i(range.minRange); i<range.maxRange; ++i)
+    uint id = allocator.firstFree(activeRange().minRange, activeRange().maxRange);
+    if(id > 0)
     {
-        if(isFreeMapId(i))
-        {
-            id = i;
-            ei::log(ELogMessageType::eLogInfo, "Found map ID from active range:" + QString::number(i));
-            break;
-        }
+        ei::log(ELogMessageType::eLogInfo, "Found map ID from active range:" + QString::number(id));
+        return id;
     }
     //TODO: we MUST guarantee setting free id or undo creating object
 
     // try to find suit id from any mob range. TODO: delete this
-    if (id == 0)
-    {
-        QVector<SRange> arrRange;
-        for(auto& range : m_aMainRange)
-            arrRange.append(SRange(range));
-        for(auto& range : m_aSecRange)
-            arrRange.append(SRange(range));
+    QVector<SRange> arrRange;
+    for(auto& range : m_aMainRange)
+        arrRange.append(SRange(range));
+    for(auto& range : m_aSecRange)
+        arrRange.append(SRange(range));
 
-        for(auto& range : arrRange)
+    for(auto& range : arrRange)
+    {
+        id = allocator.firstFree(range.minRange, range.maxRange);
+        if(id > 0)
         {
-            if(id > 0)
-                break;
-
-            for(uint i(range.minRange); i<range.maxRange; ++i)
-                if(isFreeMapId(i))
-                {
-                    id = i;
-                    ei::log(ELogMessageType::eLogWarning, "Found map ID from any mob ranges:" + QString::number(i));
-                    break;
-                }
+            ei::log(ELogMessageType::eLogWarning, "Found map ID from any mob ranges:" + QString::number(id));
+            return id;
         }
     }
 
-
-    if(id == 0)
-    { // try to set any free number
-        uint freeId(1000);
-        QVector<uint> arrId;
-        arrId.resize(m_aNode.size());
-
-        for (int i(0); i<m_aNode.size(); ++i)
-            arrId[i] = m_aNode[i]->mapId();
-
-        for (; freeId<100000; ++freeId)
-        {
-            if(!arrId.contains(freeId))
-            {
-                id = freeId;
-                break;
-            }
-        }
-    }
+    // try to set any free number
+    id = allocator.firstFree(1000, 100000);
     if(id == 0)
     {
         ei::log(ELogMessageType::eLogFatal, "Cant find suit ID for object");
@@ -1058,6 +1177,21 @@ uint CMob::freeMapId()
     return id;
 }
 
+// IDs are taken from a copy of allocator, so they are unique among themselves and the same as sequential freeMapId calls would give
+QVector<uint> CMob::freeMapIds(int count)
+{
+    QVector<uint> arrId;
+    arrId.reserve(count);
+    CIdAllocator allocator(m_mapIdIndex.allocator());
+    for(int i(0); i<count; ++i)
+    {
+        const uint id = freeMapId(allocator);
+        allocator.take(id);
+        arrId.append(id);
+    }
+    return arrId;
+}
+
 QVector<uint> CMob::findIdDuplicate()
 {
     QSet<uint> arrId;
@@ -1092,6 +1226,7 @@ void CMob::autoFixDuplicateId(QVector<uint>& arrId)
         {
             uint freeId = freeMapId();
             pNode->setMapId(freeId);
+            reindexNode(pNode, mapId);
             ei::log(eLogInfo, "duplicate id changed from: " + QString::number(mapId) + " to: " + QString::number(freeId));
             arrId.removeOne(mapId);
             setDirty();
@@ -1125,7 +1260,7 @@ void CMob::serializeJson(const QFileInfo& file)
     mob.insert("Ranges", rangeObj);
 
     //scripts
-    writeData(mob, file, "Script", m_script);
+    writeData(mob, file, "Script", script());
     writeData(mob, file, "Old_script", m_textOld);
 
     QJsonArray aDiplomacyName;
@@ -1156,32 +1291,45 @@ void CMob::serializeJson(const QFileInfo& file)
     writeData(mob, file, "dirElem", m_directoryElements);
     writeData(mob, file, "graph", m_aiGraph);
 
-    //units
-    QJsonArray unitArr;
-    for (auto& node: m_aNode)
-    {
-        QJsonObject unitObj;
-        node->serializeJson(unitObj);
-        unitArr.append(unitObj);
-    }
-
-    mob.insert("Objects", unitArr);
-
-    QJsonDocument doc(mob);
     QFile f(file.absoluteFilePath());
     if (!f.open(QIODevice::WriteOnly)) {
         Q_ASSERT("Couldn't open option file." && false);
         return;
     }
-    f.write(doc.toJson(QJsonDocument::JsonFormat::Indented));
+
+    // Objects are streamed: each chunk is serialized in parallel and written to file, so the whole objects array is never kept in memory
+    CJsonStreamWriter writer(&f, mob, "Objects");
+    const int chunkSize = 1024;
+    const QList<CNode*> arrNode = m_aNode;
+    for(int chunk(0); chunk < arrNode.size(); chunk += chunkSize)
+    {
+        writer.writeElements(QtConcurrent::blockingMapped<QList<QByteArray>>(arrNode.mid(chunk, chunkSize), [](CNode* pNode)
+        {
+            QJsonObject unitObj;
+            pNode->serializeJson(unitObj);
+            return CJsonStreamWriter::elementText(unitObj);
+        }));
+    }
+    writer.finish();
     f.close();
 }
 
-void CMob::serializeMob(QByteArray& data)
+// Sizes of all sections are collected by the first run of writeMob, the second one streams data forward into device
+void CMob::serializeMob(QIODevice* pDevice)
 {
     ei::log(eLogInfo, "Start write mob");
+    util::CMobParser parser(pDevice);
+    writeMob(parser);
+    parser.startWritePass();
+    writeMob(parser);
+    if(!parser.finishWritePass())
+        ei::log(eLogFatal, "Mob data is written with wrong section sizes");
+    ei::log(eLogInfo, "End write mob");
+}
+
+void CMob::writeMob(util::CMobParser& parser)
+{
     uint writeByte(0);
-    util::CMobParser parser(data, true);
     //header "OBJECT_DB_FILE"
     writeByte += parser.startSection("OBJECT_DB_FILE");
 
@@ -1195,7 +1343,14 @@ void CMob::serializeMob(QByteArray& data)
     }
     parser.endSection(); //"PR/SC_OBJECT_DB_FILE"
 
-    if (!m_script.isEmpty())
+    if (!m_scriptData.isEmpty())
+    {// not changed script is written as it was read
+        writeByte += parser.startSection("SS_TEXT");
+        writeByte += parser.writeDword(m_scriptKey);
+        writeByte += parser.writeByteArray(m_scriptData, uint(m_scriptData.size()));
+        parser.endSection(); //SS_TEXT
+    }
+    else if (!m_script.isEmpty())
     {
         writeByte += parser.startSection("SS_TEXT");
         writeByte += parser.writeStringEncrypted(m_script, m_scriptKey);
@@ -1329,7 +1484,11 @@ void CMob::serializeMob(QByteArray& data)
             if (bSaveSelect && (node->nodeState() != ENodeState::eSelect)) //save selected objects only
                 continue;
 
-            writeByte += node->serialize(parser);
+            const QByteArray rawData = node->rawData();
+            if(rawData.isEmpty())
+                writeByte += node->serialize(parser);
+            else
+                writeByte += parser.writeByteArray(rawData, uint(rawData.size()));
         }
         parser.endSection(); // OBJECT_SECTION
     }
@@ -1344,8 +1503,6 @@ void CMob::serializeMob(QByteArray& data)
         writeByte += parser.writeAiGraph(m_aiGraph, m_aiGraph.length());
         parser.endSection();
     }
-    ei::log(eLogInfo, "End write mob");
-    return;
 }
 
 void CMob::createNode(CNode *pNode)
@@ -1416,7 +1573,9 @@ void CMob::createNode(CNode *pNode)
     if(nullptr == pNewNode)
         return;
 
+    const uint oldId = pNewNode->mapId();
     pNewNode->setMapId(freeMapId());
+    reindexNode(pNewNode, oldId);
     pNewNode->setState(ENodeState::eSelect);
 
 
@@ -1431,8 +1590,10 @@ void CMob::deleteNode(CNode *pNode)
         m_aDeletedNode.append(m_aNode.at(ind));
         //m_aNode.at(ind)->setState(ENodeState::eDraw);
         m_aNode.removeAt(ind);
+        removeFromIndex(pNode, pNode->mapId());
+        removeLogicNodes(pNode);
         ei::log(eLogDebug, QString("delete node with %1").arg(pNode->mapId()));
-        logicNodesUpdate();
+        Q_ASSERT(isLogicIndexValid());
     }
 }
 
@@ -1468,9 +1629,7 @@ void CMob::saveAs(const QFileInfo& path)
             ei::log(eLogFatal, QString("Have no access to MOB file:%1").arg(file.fileName()));
             return;
         }
-        QByteArray data;
-        serializeMob(data);
-        file.write(data);
+        serializeMob(&file);
         file.close();
     }
     catch (std::exception ex)
@@ -3,6 +3,7 @@
 
 #include <QFileInfo>
 #include <QMap>
+#include <QHash>
 #include <QDataStream>
 #include <QVector>
 #include <QVector3D>
@@ -10,6 +11,9 @@
 
 #include "types.h"
 #include "node.h"
+#include "map_id_index.h"
+#include "select_query.h"
+#include "spatial_index.h"
 
 class CView;
 class CProgressView;
@@ -17,6 +21,27 @@ class CPatrolPoint;
 class CLookPoint;
 class CActivationZone;
 class CTrapCastPoint;
+class CJsonStreamReader;
+
+enum ELogicHandleType
+{
+    eLogicHandleObject = 0 // unit or magic trap itself
+    ,eLogicHandlePatrol
+    ,eLogicHandleView
+    ,eLogicHandleTrapZone
+    ,eLogicHandleTrapCast
+};
+
+///
+/// \brief The SLogicHandle struct addresses logic node by map ID of its unit (trap) and indexes inside it. It stays valid when undo\redo recreates the object, unlike node pointer
+///
+struct SLogicHandle
+{
+    ELogicHandleType type;
+    uint mapId; // unit or magic trap
+    int pointId; // patrol point, activation zone or cast point index. -1 creates the first one
+    int viewId; // look point index of patrol point. -1 creates the first one
+};
 
 ///
 /// \brief The CMob class provides reading, saving and editing of *.mob file.
@@ -32,12 +57,16 @@ public:
     void saveAs(const QFileInfo& path);
     void save();
     void serializeJson(const QFileInfo& file);
-    void serializeMob(QByteArray& data);
-    void addNode(QList<CNode*>& aNode) {m_aNode.append(aNode); }
-    void addNode(CNode* aNode) {m_aNode.append(aNode); }
+    void serializeMob(QIODevice* pDevice);
+    void addNode(QList<CNode*>& aNode);
+    void addNode(CNode* aNode);
+    void reindexNode(CNode* pNode, uint oldId);
     void createNode(CNode* pNode);
-    CNode* createNode(QJsonObject data);
     void undo_createNode(uint mapId);
+    QByteArray serializeNodes(const QList<CNode*>& arrNode);
+    QList<CNode*> createNodes(QByteArray& data);
+    QByteArray jsonNodesToData(CJsonStreamReader& reader, int& nNode);
+    void undo_createNodes(const QVector<uint>& arrMapId);
     QList<CNode*>& nodes();
     void deleteNode(uint mapId);
     CNode* undo_deleteNode(uint mapId);
@@ -57,8 +86,8 @@ public:
     void setDiplomacyNames(QList<QString>& arrName) {m_aDiplomacyFieldName = arrName;}
     QVector<QVector<uint>>& diplomacyField() {return m_diplomacyFoF;}
     void setDiplomacyField(const QVector<QVector<uint>>& df) {m_diplomacyFoF = df;}
-    const QString& script() {return m_script;}
-    void setScript(const QString& script) {m_script = script;}
+    const QString& script();
+    void setScript(const QString& script);
     void setQuestMob(bool bQuest = true) {m_mobType = bQuest ? eEMobTypeQuest : eEMobTypeBase;}
     bool isQuestMob() {return m_mobType == EMobType::eEMobTypeQuest;}
     void setDirty(bool bDurty = true) {m_bDirty = bDurty;}
@@ -72,32 +101,50 @@ public:
     uint activeRangeId() {return m_activeRangeId;}
     void setActiveRange(uint rangeId);
     uint freeMapId();
+    QVector<uint> freeMapIds(int count);
+    const CSelectIndex& selectIndex();
+    const CSpatialIndex& spatialIndex();
 
     //functions for logic processing
     QList<CNode*>& logicNodes();
     void logicNodesUpdate();
-    void getPatrolHash(int& unitMapIdOut, int& pointIdOut, CPatrolPoint* pPoint);
-    void getViewHash(int& unitMapIdOut, int& pointIdOut, int& viewIdOut, CLookPoint* pPoint);
+    void logicNodesUpdate(CNode* pOwner);
+    SLogicHandle logicHandle(CNode* pNode);
+    CNode* nodeByLogicHandle(const SLogicHandle& handle);
     int getPatrolId(uint unitMapId, CPatrolPoint* pPoint);
-    void createPatrolByHash(QString hash);
-    void undo_createPatrolByHash(QString hash);
-    CPatrolPoint* patrolPointById(int unitId, int patrolId);
-    CLookPoint* viewPointById(int unitId, int patrolId, int viewId);
-    void getTrapZoneHash(int& unitMapIdOut, int& zoneIdOut, CActivationZone* pZone);
-    CActivationZone* actZoneById(int trapId, int zoneId);
-    void getTrapCastHash(int& unitMapIdOut, int& pointIdOut, CTrapCastPoint* pCast);
-    CTrapCastPoint* trapCastById(int trapId, int pointId);
+    void createPatrolByHandle(const SLogicHandle& handle);
+    void undo_createPatrolByHandle(const SLogicHandle& handle);
     uint trapIdByPoint(CActivationZone* pZone);
     uint trapIdByPoint(CTrapCastPoint* pPoint);
     // <== end functions of logic
 
 private:
+    // owner is kept as pointer, so map ID of handle is actual after changing ID of unit
+    struct SLogicIndex
+    {
+        CNode* pOwner;
+        ELogicHandleType type;
+        int pointId;
+        int viewId;
+        bool operator==(const SLogicIndex& other) const {return pOwner == other.pOwner && type == other.type && pointId == other.pointId && viewId == other.viewId;}
+    };
+
     QString getAuxDirName();
-    bool deserialize(QByteArray data);
+    bool deserialize(QByteArray& data);
+    uint deserializeObjects(util::CMobParser& parser, const QByteArray& data, uint sectionLen);
+    void writeMob(util::CMobParser& parser);
     void updateObjects();
     void writeData(QJsonObject& mob, const QFileInfo& file, const QString key, const QString value);
     void writeData(QJsonObject& mob, const QFileInfo& file, const QString key, QByteArray& value);
     bool isFreeMapId(uint id);
+    void removeFromIndex(CNode* pNode, uint id);
+    uint freeMapId(const CIdAllocator& allocator);
+    bool isNodeIndexValid();
+    uint indexRevision() const {return CNode::s_changeCount + m_nodeListRevision;}
+    bool collectLogicNodes(CNode* pNode, QList<CNode*>& arrNode, QHash<CNode*, SLogicIndex>& aIndex);
+    int removeLogicNodes(CNode* pOwner);
+    void removeLogicNodes(const QSet<CNode*>& aOwner);
+    bool isLogicIndexValid();
     void collectTreeView();
     QVector<uint> findIdDuplicate();
     void autoFixDuplicateId(QVector<uint>& arrId);
@@ -109,6 +156,7 @@ private:
     QFileInfo m_filePath;
     uint m_scriptKey;
     QString m_script;
+    QByteArray m_scriptData; // encrypted script as it was read. Cleared when script is changed
     QString m_textOld;
     QVector<SRange> m_aMainRange;
     QVector<SRange> m_aSecRange;
@@ -123,7 +171,14 @@ private:
     //todo: include ALL nodes into these lists, for node assemly use children\parents
     QList<CNode*> m_aNode;
     QList<CNode*> m_aDeletedNode;
+    CMapIdIndex m_mapIdIndex; // nodes of m_aNode by map ID and free map IDs
+    CSelectIndex m_selectIndex; // attributes of m_aNode for select queries, refreshed on demand
+    CSpatialIndex m_spatialIndex; // world boxes of m_aNode, refreshed on demand
+    uint m_nodeListRevision; // counter of adding and removing of m_aNode, see indexRevision
+    uint m_selectIndexRevision; // indexRevision of the last refresh
+    uint m_spatialIndexRevision;
     QList<CNode*> m_aLogicNode;
+    QHash<CNode*, SLogicIndex> m_aLogicIndex; // logic point of m_aLogicNode -> its place in unit (trap), in sync with m_aLogicNode
     EMobType m_mobType;
     bool m_bDirty;
     uint m_activeRangeId;
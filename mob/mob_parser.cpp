@@ -0,0 +1,806 @@
+#include <QtEndian>
+#include <QIODevice>
+#include <cstring>
+
+#include "mob_parser.h"
+
+void util::formatStream(QDataStream& stream)
+{
+    stream.setByteOrder(QDataStream::ByteOrder::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+// Names and data types of *.mob node types. The same table is used by all parsers, see CMobParser::initTypes
+static QMap<uint, util::STypeTable> mobTypeTable()
+{
+    using namespace util;
+    QMap<uint, STypeTable> aType;
+    aType[0]=          {"ROOT", eRecord};
+
+    aType[7680]=       {"VSS_SECTION", eRecord};
+    aType[7681]=       {"VSS_TRIGER", eRecord};
+    aType[7682]=       {"VSS_CHECK", eRecord};
+    aType[7683]=       {"VSS_PATH", eRecord};
+    aType[7684]=       {"VSS_ID", eDword};
+    aType[7685]=       {"VSS_RECT", eRectangle};
+    aType[7686]=       {"VSS_SRC_ID", eDword};
+    aType[7687]=       {"VSS_DST_ID", eDword};
+    aType[7688]=       {"VSS_TITLE", eString};
+    aType[7689]=       {"VSS_COMMANDS", eString};
+    aType[7690]=       {"VSS_ISSTART", eByte};
+    aType[7691]=       {"VSS_LINK", eRecord};
+    aType[7692]=       {"VSS_GROUP", eString};
+    aType[7693]=       {"VSS_IS_USE_GROUP", eByte};
+    aType[7694]=       {"VSS_VARIABLE", eRecord};
+    aType[7695]=       {"VSS_BS_CHECK", eStringArray};
+    aType[7696]=       {"VSS_BS_COMMANDS", eStringArray};
+    aType[7697]=       {"VSS_CUSTOM_SCRIPT", eString};
+
+    aType[40960]=      {"OBJECT_DB_FILE", eRecord};
+
+    aType[43984]=      {"WORLD_SET", eRecord};
+    aType[43985]=      {"WS_WIND_DIR", ePlot};
+    aType[43986]=      {"WS_WIND_STR", eFloat};
+    aType[43987]=      {"WS_TIME", eFloat};
+    aType[43988]=      {"WS_AMBIENT", eFloat};
+    aType[43989]=      {"WS_SUN_LIGHT", eFloat};
+
+    aType[43520]=      {"LIGHT_SECTION", eNull};
+    aType[43521]=      {"LIGHT", eRecord};
+    aType[43522]=      {"LIGHT_RANGE", eFloat};
+    aType[43523]=      {"LIGHT_NAME", eString};
+    aType[43524]=      {"LIGHT_POSITION", ePlot};
+    aType[43525]=      {"LIGHT_ID", eDword};
+    aType[43526]=      {"LIGHT_SHADOW", eByte};
+    aType[43527]=      {"LIGHT_COLOR", ePlot};
+    aType[43528]=      {"LIGHT_COMMENTS", eString};
+
+    aType[45056]=      {"OBJECT_SECTION", eRecord};
+    aType[45057]=      {"OBJECT", eRecord};
+    aType[45058]=      {"NID", eDword};
+    aType[45059]=      {"OBJ_TYPE", eDword};
+    aType[45060]=      {"OBJ_NAME", eString};
+    aType[45061]=      {"OBJ_INDEX", eNull};
+    aType[45062]=      {"OBJ_TEMPLATE", eString};
+    aType[45063]=      {"OBJ_PRIM_TXTR", eString};
+    aType[45064]=      {"OBJ_SEC_TXTR", eString};
+    aType[45065]=      {"OBJ_POSITION", ePlot};
+    aType[45066]=      {"OBJ_ROTATION", eQuaternion};
+    aType[45067]=      {"OBJ_TEXTURE", eNull};
+    aType[45068]=      {"OBJ_COMPLECTION", ePlot};
+    aType[45069]=      {"OBJ_BODYPARTS", eStringArray};
+    aType[45070]=      {"PARENT_TEMPLATE", eString};
+    aType[45071]=      {"OBJ_COMMENTS", eString};
+    aType[45072]=      {"OBJ_DEF_LOGIC", eNull};
+    aType[45073]=      {"OBJ_PLAYER", eByte};
+    aType[45074]=      {"OBJ_PARENT_ID", eDword};
+    aType[45075]=      {"OBJ_USE_IN_SCRIPT", eByte};
+    aType[45076]=      {"OBJ_IS_SHADOW", eByte};
+    aType[45077]=      {"OBJ_R", eNull};
+    aType[45078]=      {"OBJ_QUEST_INFO", eString};
+
+    aType[49152]=      {"SC_OBJECT_DB_FILE", eNull};
+
+    aType[52224]=      {"SOUND_SECTION", eNull};
+    aType[52225]=      {"SOUND", eRecord};
+    aType[52226]=      {"SOUND_ID", eDword};
+    aType[52227]=      {"SOUND_POSITION", ePlot};
+    aType[52228]=      {"SOUND_RANGE", eDword};
+    aType[52229]=      {"SOUND_NAME", eString};
+    aType[52230]=      {"SOUND_MIN", eDword};
+    aType[52231]=      {"SOUND_MAX", eDword};
+    aType[52232]=      {"SOUND_COMMENTS", eString};
+    aType[52233]=      {"SOUND_VOLUME", eNull};
+    aType[52234]=      {"SOUND_RESNAME", eStringArray};
+    aType[52235]=      {"SOUND_RANGE2", eDword};
+    aType[52237]=      {"SOUND_AMBIENT", eByte};
+    aType[52238]=      {"SOUND_IS_MUSIC", eByte};
+
+    aType[53248]=      {"PR_OBJECT_DB_FILE", eNull};
+
+    aType[56576]=      {"PARTICL_SECTION", eNull};
+    aType[56577]=      {"PARTICL", eRecord};
+    aType[56578]=      {"PARTICL_ID", eDword};
+    aType[56579]=      {"PARTICL_POSITION", ePlot};
+    aType[56580]=      {"PARTICL_COMMENTS", eString};
+    aType[56581]=      {"PARTICL_NAME", eString};
+    aType[56582]=      {"PARTICL_TYPE", eDword};
+    aType[56583]=      {"PARTICL_SCALE", eFloat};
+
+    aType[57344]=      {"DIRICTORY", eRecord};
+    aType[57345]=      {"FOLDER", eRecord};
+    aType[57346]=      {"DIR_NAME", eString};
+    aType[57347]=      {"DIR_NINST", eDword};
+    aType[57348]=      {"DIR_PARENT_FOLDER", eDword};
+    aType[57349]=      {"DIR_TYPE", eByte};
+
+    aType[61440]=      {"DIRICTORY_ELEMENTS", eRecord};
+
+    aType[65280]=      {"SEC_RANGE", eRecord};
+    aType[65281]=      {"MAIN_RANGE", eRecord};
+    aType[65282]=      {"RANGE", eRecord};
+    aType[65285]=      {"MIN_ID", eDword};
+    aType[65286]=      {"MAX_ID", eDword};
+
+    aType[826366246]=  {"AI_GRAPH", eAiGraph};
+
+    aType[2899242186]= {"SS_TEXT_OLD", eString};
+    aType[2899242187]= {"SS_TEXT", eStringEncrypted};
+
+    aType[3148611584]= {"LEVER", eRecord};
+    aType[3148611585]= {"LEVER_SCIENCE_STATS", eNull};
+    aType[3148611586]= {"LEVER_CUR_STATE", eByte};
+    aType[3148611587]= {"LEVER_TOTAL_STATE", eByte};
+    aType[3148611588]= {"LEVER_IS_CYCLED", eByte};
+    aType[3148611589]= {"LEVER_CAST_ONCE", eByte};
+    aType[3148611590]= {"LEVER_SCIENCE_STATS_NEW", eLeverStats};
+    aType[3148611591]= {"LEVER_IS_DOOR", eByte};
+    aType[3148611592]= {"LEVER_RECALC_GRAPH", eByte};
+
+    aType[3149594624]= {"UNIT", eRecord};
+    aType[3149594625]= {"UNIT_R", eNull};
+    aType[3149594626]= {"UNIT_PROTOTYPE", eString};
+    aType[3149594627]= {"UNIT_ITEMS", eNull};
+    aType[3149594628]= {"UNIT_STATS", eUnitStats};
+    aType[3149594629]= {"UNIT_QUEST_ITEMS", eStringArray};
+    aType[3149594630]= {"UNIT_QUICK_ITEMS", eStringArray};
+    aType[3149594631]= {"UNIT_SPELLS", eStringArray};
+    aType[3149594632]= {"UNIT_WEAPONS", eStringArray};
+    aType[3149594633]= {"UNIT_ARMORS", eStringArray};
+    aType[3149594634]= {"UNIT_NEED_IMPORT", eByte};
+
+    aType[3149660160]= {"UNIT_LOGIC", eRecord};
+    aType[3149660161]= {"UNIT_LOGIC_AGRESSIV", eNull};
+    aType[3149660162]= {"UNIT_LOGIC_CYCLIC", eByte};
+    aType[3149660163]= {"UNIT_LOGIC_MODEL", eDword};
+    aType[3149660164]= {"UNIT_LOGIC_GUARD_R", eFloat};
+    aType[3149660165]= {"UNIT_LOGIC_GUARD_PT", ePlot};
+    aType[3149660166]= {"UNIT_LOGIC_NALARM", eByte};
+    aType[3149660167]= {"UNIT_LOGIC_USE", eByte};
+    aType[3149660168]= {"UNIT_LOGIC_REVENGE", eNull};
+    aType[3149660169]= {"UNIT_LOGIC_FEAR", eNull};
+    aType[3149660170]= {"UNIT_LOGIC_WAIT", eFloat};
+    aType[3149660171]= {"UNIT_LOGIC_ALARM_CONDITION", eByte};
+    aType[3149660172]= {"UNIT_LOGIC_HELP", eFloat};
+    aType[3149660173]= {"UNIT_LOGIC_ALWAYS_ACTIVE", eByte};
+    aType[3149660174]= {"UNIT_LOGIC_AGRESSION_MODE", eByte};
+
+    aType[3149725696]= {"GUARD_PT", eRecord};
+    aType[3149725697]= {"GUARD_PT_POSITION", ePlot};
+    aType[3149725698]= {"GUARD_PT_ACTION", eNull};
+
+    aType[3149791232]= {"ACTION_PT", eRecord};
+    aType[3149791233]= {"ACTION_PT_LOOK_PT", ePlot};
+    aType[3149791234]= {"ACTION_PT_WAIT_SEG", eDword};
+    aType[3149791235]= {"ACTION_PT_TURN_SPEED", eDword};
+    aType[3149791236]= {"ACTION_PT_FLAGS", eByte};
+
+    aType[3149856768]= {"TORCH", eRecord};
+    aType[3149856769]= {"TORCH_STRENGHT", eFloat};
+    aType[3149856770]= {"TORCH_PTLINK", ePlot};
+    aType[3149856771]= {"TORCH_SOUND", eString};
+
+    aType[3148546048]= {"MAGIC_TRAP", eRecord};
+    aType[3148546049]= {"MT_DIPLOMACY", eDword};
+    aType[3148546050]= {"MT_SPELL", eString};
+    aType[3148546051]= {"MT_AREAS", eAreaArray};
+    aType[3148546052]= {"MT_TARGETS", ePlot2DArray};
+    aType[3148546053]= {"MT_CAST_INTERVAL", eDword};
+
+    aType[3722304977]= {"DIPLOMATION", eRecord};
+    aType[3722304978]= {"DIPLOMATION_FOF", eDiplomacy};
+    aType[3722304979]= {"DIPLOMATION_PL_NAMES", eStringArray};
+
+    aType[4294967295]= {"UNKNOWN", eUnknown};
+    return aType;
+}
+
+static const QMap<uint, util::STypeTable>& mobTypes()
+{
+    // built once and shared, objects of a mob are read by many parsers at once
+    static const QMap<uint, util::STypeTable> s_aType = mobTypeTable();
+    return s_aType;
+}
+
+void util::CMobParser::initTypes()
+{
+    static const QMap<uint, QString> s_aName = [](){
+        QMap<uint, QString> aName;
+        for(auto it = mobTypes().constBegin(); it != mobTypes().constEnd(); ++it)
+            aName.insert(it.key(), it.value().name);
+        return aName;
+    }();
+    static const QHash<QString, uint> s_aTypeKey = [](){
+        QHash<QString, uint> aKey;
+        for(auto it = s_aName.constBegin(); it != s_aName.constEnd(); ++it)
+            aKey.insert(it.value(), it.key());
+        return aKey;
+    }();
+    m_aType = s_aName;
+    m_aTypeKey = s_aTypeKey;
+}
+
+// Data type of node, unknown tags are eUnknown
+util::EType util::CMobParser::tagType(uint tag)
+{
+    return mobTypes().value(tag, STypeTable{QString(), eUnknown}).type;
+}
+
+util::CMobParser::CMobParser(QByteArray& data):
+    m_stream(&data, QIODevice::ReadOnly)
+    ,m_pData(&data)
+    ,m_bWritePass(false)
+    ,m_nextSection(0)
+    ,m_nSizePass(0)
+    ,m_nWritten(0)
+{
+    util::formatStream(m_stream);
+    initTypes();
+}
+
+util::CMobParser::CMobParser(QIODevice* pDevice):
+    m_stream(pDevice)
+    ,m_pData(nullptr)
+    ,m_bWritePass(false)
+    ,m_nextSection(0)
+    ,m_nSizePass(0)
+    ,m_nWritten(0)
+{
+    util::formatStream(m_stream);
+    initTypes();
+}
+
+// EI script cipher: LCG key = key*214013 + 2531011 (the same as ((((key*13)<<4)+key)<<8)-key step), bits 16..23 of key are xored with text.
+// Keystream is generated by blocks and applied 8 bytes at once
+static void applyScriptCipher(char* pData, int len, uint key)
+{
+    const int blockSize = 4096;
+    uchar arrKey[blockSize];
+    for(int offset(0); offset < len; offset += blockSize)
+    {
+        const int blockLen = qMin(blockSize, len - offset);
+        for(int i(0); i < blockLen; ++i)
+        {
+            key = key * 214013u + 2531011u;
+            arrKey[i] = uchar(key >> 16);
+        }
+
+        char* pBlock = pData + offset;
+        int i(0);
+        for(; i + 8 <= blockLen; i += 8)
+        {
+            quint64 text, mask;
+            memcpy(&text, pBlock + i, 8);
+            memcpy(&mask, arrKey + i, 8);
+            text ^= mask;
+            memcpy(pBlock + i, &text, 8);
+        }
+        for(; i < blockLen; ++i)
+            pBlock[i] = char(pBlock[i] ^ char(arrKey[i]));
+    }
+}
+
+// Reference cipher as it was written before keystream blocks: one LCG step by shifts per byte
+static void applyScriptCipherBytewise(char* pData, int len, uint key)
+{
+    uint tmpKey;
+    for (int i(0); i < len; ++i)
+    {
+        tmpKey = ((((key * 13) << 4) + key) << 8) - key;
+        key += (tmpKey << 2) + 2531011;
+        tmpKey = key >> 16;
+        pData[i] = char(pData[i] ^ char(tmpKey));
+    }
+}
+
+// Checks block cipher against the reference one on script data: decrypted texts must be equal and encrypting of the text must give
+// the data back. Prefixes shorter by 1..8 bytes cover every length of the tail which is not xored by 8 bytes
+bool util::CMobParser::isScriptCipherValid(const QByteArray& data, uint key)
+{
+    for(int cut(0); cut <= 8 && cut <= data.size(); ++cut)
+    {
+        const QByteArray encrypted = data.left(data.size() - cut);
+        QByteArray text(encrypted);
+        applyScriptCipher(text.data(), text.size(), key);
+        QByteArray reference(encrypted);
+        applyScriptCipherBytewise(reference.data(), reference.size(), key);
+        if(text != reference)
+            return false;
+
+        QByteArray script;
+        encryptScript(QString::fromLatin1(text), script, key);
+        if(script != encrypted)
+            return false;
+    }
+    return true;
+}
+
+void util::CMobParser::decryptScript(QString& script, const QByteArray& data, uint key)
+{
+    QByteArray text(data);
+    applyScriptCipher(text.data(), text.size(), key);
+    //todo: convert to qstringlist and utf-8? (mob.cpp writing has same code)
+    script += QString::fromLatin1(text);
+}
+
+void util::CMobParser::encryptScript(const QString &script, QByteArray &data, uint key)
+{
+    QByteArray text = script.toLatin1();
+    applyScriptCipher(text.data(), text.size(), key);
+    data.append(text);
+}
+
+// Reads type of the next node directly from buffer. Returns eTagRoot at the end of data, as failed stream read did before
+util::EMobTag util::CMobParser::peekTag() const
+{
+    const qint64 cursor = pos();
+    if(cursor + 4 > m_pData->size())
+        return eTagRoot;
+
+    return EMobTag(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(m_pData->constData()) + cursor));
+}
+
+uint util::CMobParser::nodeLen()
+{
+    return m_node.m_len-8;
+}
+
+//section:
+//header (uint)
+//size(uint)
+//data(size of "size")
+//Size pass only reserves size of section, write pass writes header with the size collected by size pass
+uint util::CMobParser::startSection(const QString& sectionName)
+{
+    Q_ASSERT(m_aTypeKey.contains(sectionName));
+    return startSection(m_aTypeKey.value(sectionName));
+}
+
+uint util::CMobParser::startSection(uint tag)
+{
+    if(m_bWritePass)
+    {
+        // header is counted by the section itself, not by the parent
+        Q_ASSERT(m_nextSection < m_arrSectionSize.size());
+        char header[8];
+        qToLittleEndian<quint32>(tag, header);
+        qToLittleEndian<quint32>(m_arrSectionSize[m_nextSection], header + 4);
+        m_stackWritten.append(m_nWritten);
+        m_nWritten += m_stream.writeRawData(header, 8);
+    }
+    else
+    {
+        m_arrSectionSize.append(0);
+        m_nSizePass += 8;
+    }
+
+    m_stack.append(QPair<int, uint>(m_nextSection, 8)); // 8 - header size
+    ++m_nextSection;
+    return 8; //header size: section type + section len
+}
+
+//size pass stores size of section, write pass checks that the same count of bytes was counted and really written to device
+void util::CMobParser::endSection()
+{
+    const auto section = m_stack.takeLast();
+    if(m_bWritePass)
+    {
+        const qint64 written = m_nWritten - m_stackWritten.takeLast();
+        Q_ASSERT("section size differs from size pass" && m_arrSectionSize[section.first] == section.second);
+        Q_ASSERT("written section bytes differ from size pass" && written == qint64(m_arrSectionSize[section.first]));
+        Q_UNUSED(written);
+    }
+    else
+        m_arrSectionSize[section.first] = section.second;
+
+    if (!m_stack.isEmpty())
+        m_stack.back().second += section.second;
+}
+
+void util::CMobParser::startWritePass()
+{
+    Q_ASSERT(!m_bWritePass && m_stack.isEmpty());
+    m_bWritePass = true;
+    m_nextSection = 0;
+}
+
+// Checks that write pass has written the same sections and the same count of bytes as size pass. Section headers
+// are written before their data, so any difference means broken file
+bool util::CMobParser::finishWritePass()
+{
+    Q_ASSERT(m_bWritePass && m_stack.isEmpty());
+    const bool bOk = m_nextSection == m_arrSectionSize.size() && m_nWritten == m_nSizePass && m_stream.status() == QDataStream::Ok;
+    Q_ASSERT("write pass differs from size pass" && bOk);
+    return bOk;
+}
+
+uint util::CMobParser::putData(const char* data, uint len)
+{
+    if(m_bWritePass)
+        m_nWritten += m_stream.writeRawData(data, int(len));
+    else
+        m_nSizePass += len;
+    if(!m_stack.isEmpty())
+        m_stack.back().second += len;
+    return len;
+}
+
+uint util::CMobParser::putDword(quint32 data)
+{
+    char buf[4];
+    qToLittleEndian(data, buf);
+    return putData(buf, 4);
+}
+
+uint util::CMobParser::putFloat(float data)
+{
+    quint32 raw;
+    memcpy(&raw, &data, 4);
+    return putDword(raw);
+}
+
+// latin1 is written through reusable buffer, size pass does not convert string at all
+uint util::CMobParser::putLatin1(const QString& data)
+{
+    const int len = data.length();
+    if(m_bWritePass)
+    {
+        m_arrTmp.resize(len);
+        const QChar* pChar = data.constData();
+        char* pOut = m_arrTmp.data();
+        for(int i(0); i<len; ++i)
+        {
+            const ushort sym = pChar[i].unicode();
+            pOut[i] = sym < 0x100 ? char(sym) : '?'; // the same as QString::toLatin1
+        }
+    }
+    return putData(m_arrTmp.constData(), uint(len));
+}
+
+// Checks that header of the next node is valid and the node ends inside of data. Data may be a file mapping, so it's checked before slicing
+bool util::CMobParser::isNextNodeInBounds() const
+{
+    const qint64 cursor = pos();
+    if(cursor + 8 > m_pData->size())
+        return false;
+
+    const quint32 len = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(m_pData->constData()) + cursor + 4);
+    return len >= 8 && cursor + len <= m_pData->size();
+}
+
+uint util::CMobParser::skipTag()
+{
+    m_stream >> m_node;
+    m_stream.device()->skip(m_node.m_len-8);
+    return m_node.m_len;
+}
+
+QString util::CMobParser::nextTag()
+{
+    m_stream.startTransaction();
+    m_stream >> m_node;
+    m_stream.rollbackTransaction();
+    return nodeName();
+}
+
+uint util::CMobParser::skipHeader()
+{
+    m_stream.device()->skip(8);
+    return 8;
+}
+
+uint util::CMobParser::readHeader()
+{
+    m_stream >> m_node;
+    return 8;
+}
+
+uint util::CMobParser::readAiGraph(QByteArray& data, uint len)
+{
+    data = m_stream.device()->read(len);
+    return len;
+}
+
+uint util::CMobParser::writeAiGraph(QByteArray& data, uint len)
+{
+    return putData(data.constData(), len);
+}
+
+uint util::CMobParser::readByteArray(QByteArray& data, uint len)
+{
+    data = m_stream.device()->read(len);
+    return len;
+}
+
+uint util::CMobParser::writeByteArray(const QByteArray& data, const uint len)
+{
+    return putData(data.constData(), len);
+}
+
+uint util::CMobParser::readByte(char& data)
+{
+    const auto res = m_stream.device()->getChar(&data);
+    Q_ASSERT(res);
+    return 1;
+}
+
+uint util::CMobParser::writeByte(const char& data)
+{
+    return putData(&data, 1);
+}
+
+uint util::CMobParser::readBool(bool& data)
+{
+    m_stream >> data;
+    return 1;
+}
+
+uint util::CMobParser::writeBool(const bool& data)
+{
+    const char val = data ? 1 : 0;
+    return putData(&val, 1);
+}
+
+uint util::CMobParser::readDiplomacy(QVector<QVector<uint>>& data)
+{
+    uint dipl[32*32];
+    m_stream.readRawData(reinterpret_cast<char*>(&dipl), sizeof(dipl));
+    data.resize(32);
+    for(int i(0); i < 32; ++i)
+        for(int j(0); j < 32;++j)
+            data[i].append(dipl[j+i*32]);
+
+    return 32*32*4;
+}
+
+uint util::CMobParser::writeDiplomacy(const QVector<QVector<uint>>& data)
+{
+    uint len(0);
+    for(int i(0); i < 32; ++i)
+        for(int j(0); j < 32;++j)
+            len += putDword(data[i][j]);
+    return len;
+}
+
+uint util::CMobParser::readDword(uint& data)
+{
+    m_stream >> data;
+    return 4;
+}
+
+uint util::CMobParser::readDword(EBehaviourType &data)
+{
+    m_stream >> (qint32&)data;
+    return 4;
+}
+
+uint util::CMobParser::writeDword(const uint& data)
+{
+    return putDword(data);
+}
+
+uint util::CMobParser::readDword(int& data)
+{
+    m_stream >> data;
+    return 4;
+}
+
+uint util::CMobParser::readFloat(float& data)
+{
+    m_stream >> data;
+    return 4;
+}
+
+uint util::CMobParser::writeFloat(const float& data)
+{
+    return putFloat(data);
+}
+
+uint util::CMobParser::readPlot(QVector3D& data)
+{
+    float val;
+    m_stream >> val;
+    data.setX(val);
+    m_stream >> val;
+    data.setY(val);
+    m_stream >> val;
+    data.setZ(val);
+    return 3*sizeof(float);
+}
+
+uint util::CMobParser::writePlot(const QVector3D& data)
+{
+    uint len(0);
+    len += putFloat(data.x());
+    len += putFloat(data.y());
+    len += putFloat(data.z());
+    return len;
+}
+
+uint util::CMobParser::readAreaArray(QVector<SArea>& data)
+{
+    uint size;
+    m_stream >> size;
+    //Q_ASSERT(size <=1);
+    QVector2D pointTo;
+    float val;
+    for(uint i(0); i<size; ++i)
+    {
+        m_stream >> val; // x
+        pointTo.setX(val);
+        m_stream >> val; // y
+        pointTo.setY(val);
+        m_stream >> val; // radius
+        SArea area{pointTo, val}; //memory leaks? crash? variable delete after functio ends
+        data.append(area);
+    }
+    return 4+12*size;
+}
+
+uint util::CMobParser::writeAreaArray(const QVector<SArea>& data)
+{
+    uint len = putDword(quint32(data.size()));
+    for (const auto& area : data)
+    {
+        len += putFloat(area.m_pointTo.x());
+        len += putFloat(area.m_pointTo.y());
+        len += putFloat(area.m_radius);
+    }
+    return len;
+}
+
+uint util::CMobParser::readPlot2DArray(QVector<QVector2D>& data)
+{
+    uint size;
+    m_stream >> size;
+    Q_ASSERT(size <=1);
+    QVector2D pointTo;
+    float val;
+    for(uint i(0); i<size; ++i)
+    {
+        m_stream >> val;
+        pointTo.setX(val);
+        m_stream >> val;
+        pointTo.setY(val);
+        data.append(pointTo);
+    }
+    //todo: check for multiPoints
+//    for (uint i(0); i<size; ++i)
+//    {
+//        m_stream >> pointTo[0] >> pointTo[1];
+//    }
+    //field size does not match the number of bytes read. Apparently, the error inside the EI read\writer
+    //maped contains rightly field len, but incorrect len of object data
+    //readLen +=4; //wtf? mobreversingtool show 4 bytes over
+    return 4+8*size; // TODO return bytes that read
+}
+
+uint util::CMobParser::writePlot2DArray(const QVector<QVector2D>& data)
+{
+    uint len = putDword(quint32(data.size()));
+    for (const auto& pt : data)
+    {
+        len += putFloat(pt.x());
+        len += putFloat(pt.y());
+    }
+    return len;
+}
+
+uint util::CMobParser::readPlot2D(QVector2D &data)
+{
+    float val;
+    m_stream >> val;
+    data.setX(val);
+    m_stream >> val;
+    data.setY(val);
+
+    return sizeof(float)*2;
+}
+
+uint util::CMobParser::writePlot2D(const QVector2D &data)
+{
+    uint len(0);
+    len += putFloat(data.x());
+    len += putFloat(data.y());
+    return len;
+}
+
+uint util::CMobParser::readQuaternion(QVector4D& data)
+{
+    float val;
+    m_stream >> val;
+    data.setW(val);
+    m_stream >> val;
+    data.setX(val);
+    m_stream >> val;
+    data.setY(val);
+    m_stream >> val;
+    data.setZ(val);
+    return 4*sizeof(float);
+}
+
+uint util::CMobParser::writeQuaternion(const QVector4D data)
+{
+    uint len(0);
+    len += putFloat(data.w());
+    len += putFloat(data.x());
+    len += putFloat(data.y());
+    len += putFloat(data.z());
+    return len;
+}
+
+uint util::CMobParser::readRectangle(SRectangle& data)
+{
+    m_stream >> data.m_minX >> data.m_maxX >> data.m_minY >> data.m_maxY;
+    return 16;
+}
+
+uint util::CMobParser::readString(QString& data, uint len)
+{
+    QByteArray str = m_stream.device()->read(len);
+    data = QString(str);
+    return len;
+}
+
+uint util::CMobParser::writeString(const QString& data)
+{
+    return putLatin1(data);
+}
+
+uint util::CMobParser::readStringArray(QList<QString>& data)
+{
+    uint blockLen(0);
+    uint records;
+    m_stream >> records;
+    blockLen += 4;
+    for(uint i(0); i<records; ++i)
+    {
+        SNode line;
+        m_stream >> line;
+        blockLen += line.m_len;
+        data.append(QString(m_stream.device()->read(line.m_len-8)));
+    }
+    return blockLen;
+}
+
+uint util::CMobParser::writeStringArray(const QList<QString>& data, const QString& keyName)
+{
+    return writeStringArray(data, m_aTypeKey.value(keyName));
+}
+
+uint util::CMobParser::writeStringArray(const QList<QString>& data, uint key)
+{
+    uint len = putDword(quint32(data.size()));
+    for (const auto& str : data)
+    {
+        len += putDword(key);
+        len += putDword(quint32(str.length() + 8));
+        len += putLatin1(str);
+    }
+    return len;
+}
+
+uint util::CMobParser::readStringEncrypted(QString& data,  uint& key, uint len)
+{
+    m_stream >> key;
+    QByteArray str = m_stream.device()->read(len-4);
+    decryptScript(data, str, key);
+    return len + 4;
+}
+
+uint util::CMobParser::writeStringEncrypted(const QString &data, uint key)
+{
+    uint len = putDword(key);
+    m_arrTmp.clear();
+    if(m_bWritePass)
+        encryptScript(data, m_arrTmp, key);
+    else
+        m_arrTmp.resize(data.length());
+    len += putData(m_arrTmp.constData(), uint(data.length()));
+    return len;
+}
+
+uint util::CMobParser::writeUnitStats(const QSharedPointer<SUnitStat>& data)
+{
+    return putData(reinterpret_cast<const char*>(data.get()), sizeof(SUnitStat));
+}
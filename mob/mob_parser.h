@@ -0,0 +1,336 @@
+#ifndef MOB_PARSER_H
+#define MOB_PARSER_H
+#include <QDataStream>
+#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QString>
+#include <QSharedPointer>
+#include "types.h"
+
+// *.mob reader and writer. It doesn't depend on GL and editor objects, so it's shared by editor and ei_maper-cli
+namespace util
+{
+
+void formatStream(QDataStream& stream);
+
+enum EType
+{
+    eUnknown = 0
+    ,eAiGraph //граф проходимости
+    ,eAreaArray
+    ,eByte //(1 byte) 1б беззнаковое целое
+    ,eDiplomacy //(4096 bytes) 32x32 матрица из 2б целых
+    ,eDword // (4 bytes) 4б беззнаковое целое
+    ,eFloat // (4 bytes) 4б вещественное
+    ,eLeverStats // (12 bytes) параметры рычага //TODO: remove?! use plot instead
+    ,eNull // (0 bytes) пустая нода
+    ,ePlot //(12 bytes) 3 floats (vec3)
+    ,ePlot2DArray
+    ,eQuaternion // (16 bytes) 4 floats (vec4)
+    ,eRecord // контейнер нод
+    ,eRectangle
+    ,eString // строка
+    ,eStringArray // массив строк
+    ,eStringEncrypted // зашифрованный скрипт уровня
+    ,eUnitStats // (180 bytes) параметры существа
+    ,eCount
+};
+
+// Node types of *.mob file. Values are raw tags as they are stored in file, names are the same as in CMobParser::initTypes
+enum EMobTag : uint
+{
+    eTagRoot = 0u // eRecord
+
+    ,eTagVssSection = 7680u // eRecord
+    ,eTagVssTriger = 7681u // eRecord
+    ,eTagVssCheck = 7682u // eRecord
+    ,eTagVssPath = 7683u // eRecord
+    ,eTagVssId = 7684u // eDword
+    ,eTagVssRect = 7685u // eRectangle
+    ,eTagVssSrcId = 7686u // eDword
+    ,eTagVssDstId = 7687u // eDword
+    ,eTagVssTitle = 7688u // eString
+    ,eTagVssCommands = 7689u // eString
+    ,eTagVssIsstart = 7690u // eByte
+    ,eTagVssLink = 7691u // eRecord
+    ,eTagVssGroup = 7692u // eString
+    ,eTagVssIsUseGroup = 7693u // eByte
+    ,eTagVssVariable = 7694u // eRecord
+    ,eTagVssBsCheck = 7695u // eStringArray
+    ,eTagVssBsCommands = 7696u // eStringArray
+    ,eTagVssCustomScript = 7697u // eString
+
+    ,eTagObjectDbFile = 40960u // eRecord
+
+    ,eTagWorldSet = 43984u // eRecord
+    ,eTagWsWindDir = 43985u // ePlot
+    ,eTagWsWindStr = 43986u // eFloat
+    ,eTagWsTime = 43987u // eFloat
+    ,eTagWsAmbient = 43988u // eFloat
+    ,eTagWsSunLight = 43989u // eFloat
+
+    ,eTagLightSection = 43520u // eNull
+    ,eTagLight = 43521u // eRecord
+    ,eTagLightRange = 43522u // eFloat
+    ,eTagLightName = 43523u // eString
+    ,eTagLightPosition = 43524u // ePlot
+    ,eTagLightId = 43525u // eDword
+    ,eTagLightShadow = 43526u // eByte
+    ,eTagLightColor = 43527u // ePlot
+    ,eTagLightComments = 43528u // eString
+
+    ,eTagObjectSection = 45056u // eRecord
+    ,eTagObject = 45057u // eRecord
+    ,eTagNid = 45058u // eDword
+    ,eTagObjType = 45059u // eDword
+    ,eTagObjName = 45060u // eString
+    ,eTagObjIndex = 45061u // eNull
+    ,eTagObjTemplate = 45062u // eString
+    ,eTagObjPrimTxtr = 45063u // eString
+    ,eTagObjSecTxtr = 45064u // eString
+    ,eTagObjPosition = 45065u // ePlot
+    ,eTagObjRotation = 45066u // eQuaternion
+    ,eTagObjTexture = 45067u // eNull
+    ,eTagObjComplection = 45068u // ePlot
+    ,eTagObjBodyparts = 45069u // eStringArray
+    ,eTagParentTemplate = 45070u // eString
+    ,eTagObjComments = 45071u // eString
+    ,eTagObjDefLogic = 45072u // eNull
+    ,eTagObjPlayer = 45073u // eByte
+    ,eTagObjParentId = 45074u // eDword
+    ,eTagObjUseInScript = 45075u // eByte
+    ,eTagObjIsShadow = 45076u // eByte
+    ,eTagObjR = 45077u // eNull
+    ,eTagObjQuestInfo = 45078u // eString
+
+    ,eTagScObjectDbFile = 49152u // eNull
+
+    ,eTagSoundSection = 52224u // eNull
+    ,eTagSound = 52225u // eRecord
+    ,eTagSoundId = 52226u // eDword
+    ,eTagSoundPosition = 52227u // ePlot
+    ,eTagSoundRange = 52228u // eDword
+    ,eTagSoundName = 52229u // eString
+    ,eTagSoundMin = 52230u // eDword
+    ,eTagSoundMax = 52231u // eDword
+    ,eTagSoundComments = 52232u // eString
+    ,eTagSoundVolume = 52233u // eNull
+    ,eTagSoundResname = 52234u // eStringArray
+    ,eTagSoundRange2 = 52235u // eDword
+    ,eTagSoundAmbient = 52237u // eByte
+    ,eTagSoundIsMusic = 52238u // eByte
+
+    ,eTagPrObjectDbFile = 53248u // eNull
+
+    ,eTagParticlSection = 56576u // eNull
+    ,eTagParticl = 56577u // eRecord
+    ,eTagParticlId = 56578u // eDword
+    ,eTagParticlPosition = 56579u // ePlot
+    ,eTagParticlComments = 56580u // eString
+    ,eTagParticlName = 56581u // eString
+    ,eTagParticlType = 56582u // eDword
+    ,eTagParticlScale = 56583u // eFloat
+
+    ,eTagDirictory = 57344u // eRecord
+    ,eTagFolder = 57345u // eRecord
+    ,eTagDirName = 57346u // eString
+    ,eTagDirNinst = 57347u // eDword
+    ,eTagDirParentFolder = 57348u // eDword
+    ,eTagDirType = 57349u // eByte
+
+    ,eTagDirictoryElements = 61440u // eRecord
+
+    ,eTagSecRange = 65280u // eRecord
+    ,eTagMainRange = 65281u // eRecord
+    ,eTagRange = 65282u // eRecord
+    ,eTagMinId = 65285u // eDword
+    ,eTagMaxId = 65286u // eDword
+
+    ,eTagAiGraph = 826366246u // eAiGraph
+
+    ,eTagSsTextOld = 2899242186u // eString
+    ,eTagSsText = 2899242187u // eStringEncrypted
+
+    ,eTagLever = 3148611584u // eRecord
+    ,eTagLeverScienceStats = 3148611585u // eNull
+    ,eTagLeverCurState = 3148611586u // eByte
+    ,eTagLeverTotalState = 3148611587u // eByte
+    ,eTagLeverIsCycled = 3148611588u // eByte
+    ,eTagLeverCastOnce = 3148611589u // eByte
+    ,eTagLeverScienceStatsNew = 3148611590u // eLeverStats
+    ,eTagLeverIsDoor = 3148611591u // eByte
+    ,eTagLeverRecalcGraph = 3148611592u // eByte
+
+    ,eTagUnit = 3149594624u // eRecord
+    ,eTagUnitR = 3149594625u // eNull
+    ,eTagUnitPrototype = 3149594626u // eString
+    ,eTagUnitItems = 3149594627u // eNull
+    ,eTagUnitStats = 3149594628u // eUnitStats
+    ,eTagUnitQuestItems = 3149594629u // eStringArray
+    ,eTagUnitQuickItems = 3149594630u // eStringArray
+    ,eTagUnitSpells = 3149594631u // eStringArray
+    ,eTagUnitWeapons = 3149594632u // eStringArray
+    ,eTagUnitArmors = 3149594633u // eStringArray
+    ,eTagUnitNeedImport = 3149594634u // eByte
+
+    ,eTagUnitLogic = 3149660160u // eRecord
+    ,eTagUnitLogicAgressiv = 3149660161u // eNull
+    ,eTagUnitLogicCyclic = 3149660162u // eByte
+    ,eTagUnitLogicModel = 3149660163u // eDword
+    ,eTagUnitLogicGuardR = 3149660164u // eFloat
+    ,eTagUnitLogicGuardPt = 3149660165u // ePlot
+    ,eTagUnitLogicNalarm = 3149660166u // eByte
+    ,eTagUnitLogicUse = 3149660167u // eByte
+    ,eTagUnitLogicRevenge = 3149660168u // eNull
+    ,eTagUnitLogicFear = 3149660169u // eNull
+    ,eTagUnitLogicWait = 3149660170u // eFloat
+    ,eTagUnitLogicAlarmCondition = 3149660171u // eByte
+    ,eTagUnitLogicHelp = 3149660172u // eFloat
+    ,eTagUnitLogicAlwaysActive = 3149660173u // eByte
+    ,eTagUnitLogicAgressionMode = 3149660174u // eByte
+
+    ,eTagGuardPt = 3149725696u // eRecord
+    ,eTagGuardPtPosition = 3149725697u // ePlot
+    ,eTagGuardPtAction = 3149725698u // eNull
+
+    ,eTagActionPt = 3149791232u // eRecord
+    ,eTagActionPtLookPt = 3149791233u // ePlot
+    ,eTagActionPtWaitSeg = 3149791234u // eDword
+    ,eTagActionPtTurnSpeed = 3149791235u // eDword
+    ,eTagActionPtFlags = 3149791236u // eByte
+
+    ,eTagTorch = 3149856768u // eRecord
+    ,eTagTorchStrenght = 3149856769u // eFloat
+    ,eTagTorchPtlink = 3149856770u // ePlot
+    ,eTagTorchSound = 3149856771u // eString
+
+    ,eTagMagicTrap = 3148546048u // eRecord
+    ,eTagMtDiplomacy = 3148546049u // eDword
+    ,eTagMtSpell = 3148546050u // eString
+    ,eTagMtAreas = 3148546051u // eAreaArray
+    ,eTagMtTargets = 3148546052u // ePlot2DArray
+    ,eTagMtCastInterval = 3148546053u // eDword
+
+    ,eTagDiplomation = 3722304977u // eRecord
+    ,eTagDiplomationFof = 3722304978u // eDiplomacy
+    ,eTagDiplomationPlNames = 3722304979u // eStringArray
+
+    ,eTagUnknown = 4294967295u // eUnknown
+};
+
+struct STypeTable
+{
+    QString name;
+    EType type;
+};
+
+struct SNode
+{
+    uint m_type;
+    uint m_len;
+    friend QDataStream& operator>> (QDataStream &st, SNode& pair)
+    {
+        return st >> pair.m_type >> pair.m_len;
+    }
+    friend QDataStream& operator<< (QDataStream &st, SNode& pair)
+    {
+        return st << pair.m_type << pair.m_len;
+    }
+};
+
+class CMobParser
+{
+public:
+    CMobParser(QByteArray& data); // reader
+    CMobParser(QIODevice* pDevice); // writer. Starts with size pass, see startWritePass
+
+    uint readAiGraph(QByteArray& data, uint len);
+    uint writeAiGraph(QByteArray& data, uint len);
+    uint readByteArray(QByteArray& data, uint len);
+    uint writeByteArray(const QByteArray& data, const uint len);
+    uint readByte(char& data);
+    uint writeByte(const char& data);
+    uint readBool(bool& data);
+    uint writeBool(const bool& data);
+    uint readDiplomacy(QVector<QVector<uint>>& data);
+    uint writeDiplomacy(const QVector<QVector<uint>>& data);
+    uint readDword(uint& data);
+    uint readDword(EBehaviourType& data);
+    uint writeDword(const uint& data);
+    uint readDword(int& data);
+    uint readFloat(float& data);
+    uint writeFloat(const float& data);
+    uint readPlot(QVector3D& data);
+    uint writePlot(const QVector3D& data);
+    uint readPlot2DArray(QVector<QVector2D>& data);
+    uint writePlot2DArray(const QVector<QVector2D>& data);
+    uint readPlot2D(QVector2D& data);
+    uint writePlot2D(const QVector2D& data);
+    uint readAreaArray(QVector<SArea>& data);
+    uint writeAreaArray(const QVector<SArea>& data);
+    uint readQuaternion(QVector4D& data);
+    uint writeQuaternion(const QVector4D data);
+    uint readRectangle(SRectangle& data);
+    uint readString(QString& data, uint len);
+    uint writeString(const QString& data);
+    uint readStringArray(QList<QString>& data);
+    uint writeStringArray(const QList<QString>& data, const QString& keyName);
+    uint writeStringArray(const QList<QString>& data, uint key);
+    uint readStringEncrypted(QString& data, uint& key, uint len);
+    uint writeStringEncrypted(const QString& data, uint key);
+    uint readUnitStats(QSharedPointer<SUnitStat>& data, uint len);
+    uint writeUnitStats(const QSharedPointer<SUnitStat>& data);
+
+
+    static void decryptScript(QString& script, const QByteArray& data, uint key);
+    static bool isScriptCipherValid(const QByteArray& data, uint key);
+    static EType tagType(uint tag);
+    EMobTag peekTag() const;
+    bool isNextNodeInBounds() const;
+    qint64 pos() const {return m_stream.device()->pos(); }
+    uint skipTag();
+    QString nextTag();
+    uint skipHeader();
+    uint readHeader();
+    QString nodeName() const {return m_aType.value(m_node.m_type); }
+    uint nodeLen();
+    uint startSection(const QString& sectionName);
+    uint startSection(uint tag);
+    void endSection();
+    void startWritePass();
+    bool finishWritePass();
+
+private:
+    void initTypes();
+    static void encryptScript(const QString& script, QByteArray& data, uint key);
+    uint putData(const char* data, uint len);
+    uint putDword(quint32 data);
+    uint putFloat(float data);
+    uint putLatin1(const QString& data);
+    //EType nodeType() {return m_aType[m_node.m_type].type; }
+    QString nodeName(uint type) const {return m_aType.value(type); }
+
+private:
+    QDataStream m_stream;
+    const QByteArray* m_pData; // raw data for tag peeking without moving cursor
+    QMap<uint, QString> m_aType;
+    QHash<QString, uint> m_aTypeKey; // reverse of m_aType for writing
+    SNode m_node;
+    // Writing is done in two passes over the same serialize code: size pass only counts bytes of each section,
+    // write pass streams data forward with already known section sizes, so the output is never seeked back
+    bool m_bWritePass;
+    QVector<uint> m_arrSectionSize; // sizes of sections in order of startSection calls
+    int m_nextSection;
+    QList<QPair<int, uint>> m_stack; //index of opened section in m_arrSectionSize, size
+    QList<qint64> m_stackWritten; // bytes written to device before header of opened section (write pass)
+    qint64 m_nSizePass; // bytes counted by size pass
+    qint64 m_nWritten; // bytes really written to device by write pass
+    QByteArray m_arrTmp; // reusable buffer for converted strings
+};
+
+}
+
+#endif // MOB_PARSER_H
@@ -0,0 +1,370 @@
+#include <QRegularExpression>
+#include <QVector2D>
+#include <algorithm>
+#include <limits>
+
+#include "select_query.h"
+#include "mob.h"
+#include "node.h"
+#include "log.h"
+#include "property.h"
+#include "objects/worldobj.h"
+#include "objects/unit.h"
+
+// the same names as in object creating dialog
+static QString typeName(ENodeType type)
+{
+    switch (type) {
+    case eWorldObject: return "World object";
+    case eUnit: return "Unit";
+    case eTorch: return "Torch";
+    case eMagicTrap: return "Magic trap";
+    case eLever: return "Lever";
+    case eLight: return "Light source";
+    case eSound: return "Sound source";
+    case eParticle: return "Particle source";
+    default: return QString();
+    }
+}
+
+// point is written as 'x y', 'x;y' or 'x,y'
+static bool readPoint(const QString& text, QVector2D& point)
+{
+    const QStringList arrCoord = text.split(QRegularExpression("[\\s;,]+"), QString::SkipEmptyParts);
+    if(arrCoord.size() != 2)
+        return false;
+
+    bool bOkX(false), bOkY(false);
+    point.setX(arrCoord[0].toFloat(&bOkX));
+    point.setY(arrCoord[1].toFloat(&bOkY));
+    return bOkX && bOkY;
+}
+
+CSelectIndex::CSelectIndex():
+    m_pass(0)
+{
+}
+
+void CSelectIndex::refresh(const QList<CNode*>& arrNode)
+{
+    ++m_pass;
+    for(auto& pNode : arrNode)
+    {
+        auto it = m_aEntry.find(pNode);
+        if(it == m_aEntry.end())
+        {
+            it = m_aEntry.insert(pNode, SEntry());
+            readEntry(pNode, it.value());
+        }
+        else if(it->revision != pNode->revision())
+        {
+            removeEntry(pNode, it.value());
+            readEntry(pNode, it.value());
+        }
+        it->pass = m_pass;
+    }
+
+    // nodes removed from mob since the last refresh
+    for(auto it = m_aEntry.begin(); it != m_aEntry.end();)
+    {
+        if(it->pass == m_pass)
+        {
+            ++it;
+            continue;
+        }
+        removeEntry(it.key(), it.value());
+        it = m_aEntry.erase(it);
+    }
+}
+
+// must be called for node added to mob, new node can get address of deleted one
+void CSelectIndex::invalidate(CNode* pNode)
+{
+    auto it = m_aEntry.find(pNode);
+    if(it == m_aEntry.end())
+        return;
+
+    removeEntry(pNode, it.value());
+    m_aEntry.erase(it);
+}
+
+void CSelectIndex::readEntry(CNode* pNode, SEntry& entry)
+{
+    entry.revision = pNode->revision();
+    for(int i(0); i<eSelectAttrCount; ++i)
+    {
+        entry.aValue[i].clear();
+        entry.aHasValue[i] = false;
+    }
+    const auto setValue = [&entry](ESelectAttr attr, const QString& value)
+    {
+        entry.aValue[attr] = value;
+        entry.aHasValue[attr] = true;
+    };
+
+    setValue(eSelectAttrName, pNode->mapName());
+    setValue(eSelectAttrType, typeName(pNode->nodeType()));
+    if(pNode->nodeType() & ENodeType::eWorldObject)
+    {
+        setValue(eSelectAttrModel, pNode->modelName());
+        setValue(eSelectAttrTexture, pNode->textureName());
+    }
+    if(auto pWo = dynamic_cast<CWorldObj*>(pNode))
+    {
+        QSharedPointer<IPropertyBase> templ;
+        pWo->getParam(templ, eObjParam_PARENT_TEMPLATE);
+        setValue(eSelectAttrTemplate, templ->toString());
+        setValue(eSelectAttrPlayer, QString::number(int(pWo->dipGroup())));
+    }
+    if(auto pUnit = dynamic_cast<CUnit*>(pNode))
+        setValue(eSelectAttrDatabase, pUnit->databaseName());
+
+    for(int i(0); i<eSelectAttrCount; ++i)
+        if(entry.aHasValue[i])
+            m_aBucket[i][entry.aValue[i].toLower()].insert(pNode);
+}
+
+void CSelectIndex::removeEntry(CNode* pNode, const SEntry& entry)
+{
+    for(int i(0); i<eSelectAttrCount; ++i)
+    {
+        if(!entry.aHasValue[i])
+            continue;
+
+        auto it = m_aBucket[i].find(entry.aValue[i].toLower());
+        if(it == m_aBucket[i].end())
+            continue;
+
+        it->remove(pNode);
+        if(it->isEmpty())
+            m_aBucket[i].erase(it);
+    }
+}
+
+// Exact match is case sensitive, otherwise every distinct value is checked for substring once.
+// Only nodes which have the attribute are found: empty exact value gives unnamed objects, empty substring gives all of them
+QSet<CNode*> CSelectIndex::find(ESelectAttr attr, const QString& value, bool bExactMatch) const
+{
+    QSet<CNode*> aNode;
+    const QString lowValue = value.toLower();
+    if(bExactMatch)
+    {
+        for(auto& pNode : m_aBucket[attr].value(lowValue))
+            if(m_aEntry.constFind(pNode)->aValue[attr] == value)
+                aNode.insert(pNode);
+
+        return aNode;
+    }
+
+    for(auto it = m_aBucket[attr].constBegin(); it != m_aBucket[attr].constEnd(); ++it)
+        if(it.key().contains(lowValue))
+            aNode.unite(it.value());
+
+    return aNode;
+}
+
+// for attributes with numeric values
+QSet<CNode*> CSelectIndex::findRange(ESelectAttr attr, int min, int max) const
+{
+    QSet<CNode*> aNode;
+    for(auto it = m_aBucket[attr].constBegin(); it != m_aBucket[attr].constEnd(); ++it)
+    {
+        bool bOk(false);
+        const int value = it.key().toInt(&bOk);
+        if(bOk && value >= min && value <= max)
+            aNode.unite(it.value());
+    }
+    return aNode;
+}
+
+CSelectQuery::CSelectQuery(const SSelect& filter):
+    m_op(eQueryIndex)
+{
+    const QString param1 = filter.param1;
+    const bool bExact = filter.exactMatch;
+    const auto findAttr = [param1, bExact](ESelectAttr attr)
+    {
+        return [attr, param1, bExact](CMob&, const CSelectIndex& index){return index.find(attr, param1, bExact);};
+    };
+
+    switch (filter.type) {
+    case eSelectType_Id_range:
+    {
+        uint id_min = filter.param1.toUInt();
+        uint id_max = filter.param2.toUInt();
+        // set equal value if only one defined
+        if(id_min!=0 && id_max==0)
+            id_max = id_min;
+        else if(id_max!=0 && id_min==0)
+            id_min = id_max;
+
+        if (id_max < id_min)
+            qSwap(id_min, id_max);
+
+        m_op = eQueryPredicate;
+        m_predicate = [id_min, id_max](CNode* pNode){return pNode->mapId() >= id_min && pNode->mapId() <= id_max;};
+        break;
+    }
+    case eSelectType_Map_name:
+        m_find = findAttr(eSelectAttrName);
+        break;
+    case eSelectType_Texture_name:
+        m_find = findAttr(eSelectAttrTexture);
+        break;
+    case eSelectType_Model_name:
+        m_find = findAttr(eSelectAttrModel);
+        break;
+    case eSelectType_Database_name:
+        m_find = findAttr(eSelectAttrDatabase);
+        break;
+    case eSelectType_Template:
+        m_find = findAttr(eSelectAttrTemplate);
+        break;
+    case eSelectType_ObjectType:
+        m_find = findAttr(eSelectAttrType);
+        break;
+    case eSelectType_Position_circle:
+    {
+        // object is selected when its box overlaps the area, see CSpatialIndex
+        QVector2D center;
+        bool bOk(false);
+        const float radius = filter.param2.toFloat(&bOk);
+        if(!readPoint(filter.param1, center) || !bOk)
+        {
+            ei::log(eLogWarning, "Incorrect circle for selection: " + filter.param1 + "; " + filter.param2);
+            m_find = [](CMob&, const CSelectIndex&){return QSet<CNode*>();};
+            break;
+        }
+        m_find = [center, radius](CMob& mob, const CSelectIndex&)
+        {
+            return mob.spatialIndex().queryCircle(center, radius).toList().toSet();
+        };
+        break;
+    }
+    case eSelectType_Position_rectangle:
+    {
+        QVector2D leftDown, rightUp;
+        if(!readPoint(filter.param1, leftDown) || !readPoint(filter.param2, rightUp))
+        {
+            ei::log(eLogWarning, "Incorrect rectangle for selection: " + filter.param1 + "; " + filter.param2);
+            m_find = [](CMob&, const CSelectIndex&){return QSet<CNode*>();};
+            break;
+        }
+        const QVector3D minPos(qMin(leftDown.x(), rightUp.x()), qMin(leftDown.y(), rightUp.y()), -std::numeric_limits<float>::max());
+        const QVector3D maxPos(qMax(leftDown.x(), rightUp.x()), qMax(leftDown.y(), rightUp.y()), std::numeric_limits<float>::max());
+        m_find = [minPos, maxPos](CMob& mob, const CSelectIndex&)
+        {
+            return mob.spatialIndex().queryBox(minPos, maxPos).toList().toSet();
+        };
+        break;
+    }
+    case eSelectType_Diplomacy_group:
+    {
+        int group_min = filter.param1.toInt();
+        int group_max = filter.param2.toInt();
+        if (group_max < group_min)
+            qSwap(group_min, group_max);
+
+        m_find = [group_min, group_max](CMob&, const CSelectIndex& index){return index.findRange(eSelectAttrPlayer, group_min, group_max);};
+        break;
+    }
+    case eSelectType_all:
+    {
+        // units and traps only, their logic points are not mob nodes
+        if(filter.param1.toLower()=="logic")
+            m_find = [](CMob& mob, const CSelectIndex&){return mob.logicNodes().toSet().intersect(mob.nodes().toSet());};
+        else
+            m_find = [](CMob& mob, const CSelectIndex&){return mob.nodes().toSet();};
+        break;
+    }
+    }
+}
+
+CSelectQuery::CSelectQuery(EQueryOp op, const QVector<CSelectQuery>& arrQuery):
+    m_op(op)
+  ,m_arrChild(arrQuery)
+{
+}
+
+// nodes matching every query
+CSelectQuery CSelectQuery::all(const QVector<CSelectQuery>& arrQuery)
+{
+    return CSelectQuery(eQueryAll, arrQuery);
+}
+
+// nodes matching at least one query
+CSelectQuery CSelectQuery::any(const QVector<CSelectQuery>& arrQuery)
+{
+    return CSelectQuery(eQueryAny, arrQuery);
+}
+
+QSet<CNode*> CSelectQuery::run(CMob& mob) const
+{
+    return run(mob, mob.selectIndex());
+}
+
+QSet<CNode*> CSelectQuery::run(CMob& mob, const CSelectIndex& index) const
+{
+    switch (m_op) {
+    case eQueryIndex:
+        return m_find(mob, index);
+    case eQueryPredicate:
+        return filter(mob.nodes());
+    case eQueryAny:
+    {
+        QSet<CNode*> aNode;
+        for(auto& query : m_arrChild)
+            aNode.unite(query.run(mob, index));
+        return aNode;
+    }
+    case eQueryAll:
+    {
+        // candidates from index and compounds first, predicates check only them
+        QVector<QSet<CNode*>> arrFound;
+        for(auto& query : m_arrChild)
+            if(query.m_op != eQueryPredicate)
+                arrFound.append(query.run(mob, index));
+
+        std::sort(arrFound.begin(), arrFound.end(), [](const QSet<CNode*>& a, const QSet<CNode*>& b){return a.size() < b.size();});
+        QSet<CNode*> aNode;
+        bool bAllNodes = arrFound.isEmpty();
+        if(!bAllNodes)
+        {
+            aNode = arrFound.front();
+            for(int i(1); i<arrFound.size() && !aNode.isEmpty(); ++i)
+                aNode.intersect(arrFound[i]);
+        }
+
+        for(auto& query : m_arrChild)
+        {
+            if(query.m_op != eQueryPredicate)
+                continue;
+
+            aNode = bAllNodes ? query.filter(mob.nodes()) : query.filter(aNode);
+            bAllNodes = false;
+        }
+        return bAllNodes ? mob.nodes().toSet() : aNode;
+    }
+    }
+    return QSet<CNode*>();
+}
+
+QSet<CNode*> CSelectQuery::filter(const QList<CNode*>& arrNode) const
+{
+    QSet<CNode*> aNode;
+    for(auto& pNode : arrNode)
+        if(m_predicate(pNode))
+            aNode.insert(pNode);
+
+    return aNode;
+}
+
+QSet<CNode*> CSelectQuery::filter(const QSet<CNode*>& aNode) const
+{
+    QSet<CNode*> aResult;
+    for(auto& pNode : aNode)
+        if(m_predicate(pNode))
+            aResult.insert(pNode);
+
+    return aResult;
+}
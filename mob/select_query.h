@@ -0,0 +1,87 @@
+#ifndef SELECT_QUERY_H
+#define SELECT_QUERY_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+#include "types.h"
+
+class CNode;
+class CMob;
+
+enum ESelectAttr
+{
+    eSelectAttrName = 0
+    ,eSelectAttrModel
+    ,eSelectAttrTexture
+    ,eSelectAttrDatabase
+    ,eSelectAttrTemplate
+    ,eSelectAttrType
+    ,eSelectAttrPlayer
+    ,eSelectAttrCount
+};
+
+///
+/// \brief The CSelectIndex class keeps lower-cased attributes of mob nodes grouped by value. Only nodes changed since the last refresh (see CNode::setModified) are re-read
+///
+class CSelectIndex
+{
+public:
+    CSelectIndex();
+    void refresh(const QList<CNode*>& arrNode);
+    void invalidate(CNode* pNode);
+    QSet<CNode*> find(ESelectAttr attr, const QString& value, bool bExactMatch) const;
+    QSet<CNode*> findRange(ESelectAttr attr, int min, int max) const;
+
+private:
+    struct SEntry
+    {
+        uint revision;
+        uint pass;
+        QString aValue[eSelectAttrCount]; // as is
+        bool aHasValue[eSelectAttrCount]; // attribute exists for node type. Existing empty values are indexed too (unnamed objects)
+    };
+    void readEntry(CNode* pNode, SEntry& entry);
+    void removeEntry(CNode* pNode, const SEntry& entry);
+
+private:
+    QHash<CNode*, SEntry> m_aEntry;
+    QHash<QString, QSet<CNode*>> m_aBucket[eSelectAttrCount]; // lower-cased value -> nodes
+    uint m_pass;
+};
+
+///
+/// \brief The CSelectQuery class compiles select filters (SSelect) into predicate pipeline. Filters on indexed attributes and position give candidates from CSelectIndex and CSpatialIndex, the rest (ID range) check only these candidates. Filters are combined by all() and any()
+///
+class CSelectQuery
+{
+public:
+    CSelectQuery(const SSelect& filter);
+    static CSelectQuery all(const QVector<CSelectQuery>& arrQuery);
+    static CSelectQuery any(const QVector<CSelectQuery>& arrQuery);
+    QSet<CNode*> run(CMob& mob) const;
+
+private:
+    enum EQueryOp
+    {
+        eQueryIndex = 0 // candidates from index
+        ,eQueryPredicate // check of every node
+        ,eQueryAll
+        ,eQueryAny
+    };
+    CSelectQuery(EQueryOp op, const QVector<CSelectQuery>& arrQuery);
+    QSet<CNode*> run(CMob& mob, const CSelectIndex& index) const;
+    QSet<CNode*> filter(const QList<CNode*>& arrNode) const;
+    QSet<CNode*> filter(const QSet<CNode*>& aNode) const;
+
+private:
+    EQueryOp m_op;
+    std::function<QSet<CNode*>(CMob&, const CSelectIndex&)> m_find;
+    std::function<bool(CNode*)> m_predicate;
+    QVector<CSelectQuery> m_arrChild;
+};
+
+#endif // SELECT_QUERY_H
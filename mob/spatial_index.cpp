@@ -0,0 +1,245 @@
+#include <QtMath>
+#include <algorithm>
+#include <limits>
+
+#include "spatial_index.h"
+#include "node.h"
+#include "math_utils.h"
+
+// half size of box for nodes without model (lights, sounds, particles)
+static const float s_markerHalfSize = 0.5f;
+
+static bool isBoxOverlap(const QVector3D& minA, const QVector3D& maxA, const QVector3D& minB, const QVector3D& maxB)
+{
+    return minA.x() <= maxB.x() && maxA.x() >= minB.x()
+            && minA.y() <= maxB.y() && maxA.y() >= minB.y()
+            && minA.z() <= maxB.z() && maxA.z() >= minB.z();
+}
+
+// distance in XY plane from point to box
+static bool isCircleOverlap(const QVector2D& center, float radius, const QVector3D& minPos, const QVector3D& maxPos)
+{
+    const float dx = qMax(qMax(minPos.x() - center.x(), 0.0f), center.x() - maxPos.x());
+    const float dy = qMax(qMax(minPos.y() - center.y(), 0.0f), center.y() - maxPos.y());
+    return dx*dx + dy*dy <= radius*radius;
+}
+
+CSpatialIndex::CSpatialIndex(float cellSize):
+    m_cellSize(cellSize)
+  ,m_maxHalfSize(0.0f)
+  ,m_pass(0)
+{
+}
+
+void CSpatialIndex::clear()
+{
+    m_aEntry.clear();
+    m_aCell.clear();
+    m_maxHalfSize = 0.0f;
+}
+
+// Moved node only shifts its box. Model box is re-read when rotation, constitution or model is changed
+void CSpatialIndex::refresh(const QList<CNode*>& arrNode)
+{
+    ++m_pass;
+    for(auto& pNode : arrNode)
+    {
+        auto it = m_aEntry.find(pNode);
+        if(it == m_aEntry.end())
+        {
+            it = m_aEntry.insert(pNode, SEntry());
+            readEntry(pNode, it.value(), true);
+            insertToCell(pNode, it.value());
+        }
+        else if(it->revision != pNode->revision() || it->drawPos != pNode->drawPosition())
+        {
+            const bool bReadModel = it->rotation != pNode->rotation() || it->constitution != pNode->constitution() || it->modelName != pNode->modelName();
+            removeFromCell(it.value());
+            readEntry(pNode, it.value(), bReadModel);
+            insertToCell(pNode, it.value());
+        }
+        it->pass = m_pass;
+    }
+
+    // nodes removed from mob since the last refresh
+    for(auto it = m_aEntry.begin(); it != m_aEntry.end();)
+    {
+        if(it->pass == m_pass)
+        {
+            ++it;
+            continue;
+        }
+        removeFromCell(it.value());
+        it = m_aEntry.erase(it);
+    }
+}
+
+// must be called for node added to mob, new node can get address of deleted one
+void CSpatialIndex::invalidate(CNode* pNode)
+{
+    auto it = m_aEntry.find(pNode);
+    if(it == m_aEntry.end())
+        return;
+
+    removeFromCell(it.value());
+    m_aEntry.erase(it);
+}
+
+bool CSpatialIndex::bounds(CNode* pNode, QVector3D& minPos, QVector3D& maxPos) const
+{
+    auto it = m_aEntry.constFind(pNode);
+    if(it == m_aEntry.constEnd())
+        return false;
+
+    minPos = it->minPos;
+    maxPos = it->maxPos;
+    return true;
+}
+
+void CSpatialIndex::readEntry(CNode* pNode, SEntry& entry, bool bReadModel)
+{
+    entry.revision = pNode->revision();
+    entry.drawPos = pNode->drawPosition();
+    if(bReadModel)
+    {
+        entry.rotation = pNode->rotation();
+        entry.constitution = pNode->constitution();
+        entry.modelName = pNode->modelName();
+        const CBox box = pNode->getBBox();
+        entry.localMin = box.minPos();
+        entry.localMax = box.maxPos();
+        if(entry.localMin == entry.localMax) // no model
+        {
+            entry.localMin -= QVector3D(s_markerHalfSize, s_markerHalfSize, s_markerHalfSize);
+            entry.localMax += QVector3D(s_markerHalfSize, s_markerHalfSize, s_markerHalfSize);
+        }
+    }
+    entry.minPos = entry.drawPos + entry.localMin;
+    entry.maxPos = entry.drawPos + entry.localMax;
+}
+
+void CSpatialIndex::insertToCell(CNode* pNode, SEntry& entry)
+{
+    const QVector3D center = (entry.minPos + entry.maxPos) / 2;
+    const QVector3D halfSize = (entry.maxPos - entry.minPos) / 2;
+    m_maxHalfSize = qMax(m_maxHalfSize, qMax(halfSize.x(), halfSize.y()));
+
+    entry.cell = cellKey(qFloor(center.x()/m_cellSize), qFloor(center.y()/m_cellSize));
+    SCell& cell = m_aCell[entry.cell];
+    if(cell.arrNode.isEmpty())
+    {
+        cell.minPos = entry.minPos;
+        cell.maxPos = entry.maxPos;
+    }
+    else
+    {
+        cell.minPos = util::getMinValue(cell.minPos, entry.minPos);
+        cell.maxPos = util::getMaxValue(cell.maxPos, entry.maxPos);
+    }
+    entry.indexInCell = cell.arrNode.size();
+    cell.arrNode.append(pNode);
+}
+
+// the last node of cell takes place of removed one
+void CSpatialIndex::removeFromCell(const SEntry& entry)
+{
+    auto itCell = m_aCell.find(entry.cell);
+    Q_ASSERT(itCell != m_aCell.end());
+    QVector<CNode*>& arrNode = itCell->arrNode;
+    CNode* pLast = arrNode.last();
+    arrNode[entry.indexInCell] = pLast;
+    m_aEntry[pLast].indexInCell = entry.indexInCell;
+    arrNode.removeLast();
+    if(arrNode.isEmpty())
+        m_aCell.erase(itCell);
+}
+
+template<typename TCellTest, typename TNodeTest>
+QVector<CNode*> CSpatialIndex::query(TCellTest isCellHit, TNodeTest isNodeHit) const
+{
+    QVector<CNode*> arrResult;
+    for(auto itCell = m_aCell.constBegin(); itCell != m_aCell.constEnd(); ++itCell)
+    {
+        if(!isCellHit(itCell->minPos, itCell->maxPos))
+            continue;
+
+        for(auto& pNode : itCell->arrNode)
+        {
+            const SEntry& entry = *m_aEntry.constFind(pNode);
+            if(isNodeHit(entry.minPos, entry.maxPos))
+                arrResult.append(pNode);
+        }
+    }
+    return arrResult;
+}
+
+// Cells around box are visited directly when there are less of them than non-empty cells
+QVector<CNode*> CSpatialIndex::queryBox(const QVector3D& minPos, const QVector3D& maxPos) const
+{
+    const auto isHit = [&minPos, &maxPos](const QVector3D& minBox, const QVector3D& maxBox){return isBoxOverlap(minPos, maxPos, minBox, maxBox);};
+    const int xMin = qFloor((minPos.x() - m_maxHalfSize)/m_cellSize);
+    const int xMax = qFloor((maxPos.x() + m_maxHalfSize)/m_cellSize);
+    const int yMin = qFloor((minPos.y() - m_maxHalfSize)/m_cellSize);
+    const int yMax = qFloor((maxPos.y() + m_maxHalfSize)/m_cellSize);
+    if(qint64(xMax - xMin + 1) * qint64(yMax - yMin + 1) > m_aCell.size())
+        return query(isHit, isHit);
+
+    QVector<CNode*> arrResult;
+    for(int y(yMin); y<=yMax; ++y)
+        for(int x(xMin); x<=xMax; ++x)
+        {
+            auto itCell = m_aCell.constFind(cellKey(x, y));
+            if(itCell == m_aCell.constEnd() || !isHit(itCell->minPos, itCell->maxPos))
+                continue;
+
+            for(auto& pNode : itCell->arrNode)
+            {
+                const SEntry& entry = *m_aEntry.constFind(pNode);
+                if(isHit(entry.minPos, entry.maxPos))
+                    arrResult.append(pNode);
+            }
+        }
+    return arrResult;
+}
+
+// circle in XY plane, height is not checked
+QVector<CNode*> CSpatialIndex::queryCircle(const QVector2D& center, float radius) const
+{
+    const QVector3D minPos(center.x() - radius, center.y() - radius, -std::numeric_limits<float>::max());
+    const QVector3D maxPos(center.x() + radius, center.y() + radius, std::numeric_limits<float>::max());
+    QVector<CNode*> arrResult = queryBox(minPos, maxPos);
+    arrResult.erase(std::remove_if(arrResult.begin(), arrResult.end(), [this, &center, radius](CNode* pNode)
+    {
+        const SEntry& entry = *m_aEntry.constFind(pNode);
+        return !isCircleOverlap(center, radius, entry.minPos, entry.maxPos);
+    }), arrResult.end());
+    return arrResult;
+}
+
+// returns nodes which boxes are hit by ray, sorted by distance to box (in dir lengths)
+QVector<QPair<float, CNode*>> CSpatialIndex::queryRay(const QVector3D& origin, const QVector3D& dir) const
+{
+    QVector<QPair<float, CNode*>> arrResult;
+    float dist(0.0f);
+    for(auto itCell = m_aCell.constBegin(); itCell != m_aCell.constEnd(); ++itCell)
+    {
+        if(!util::rayToBox(dist, origin, dir, itCell->minPos, itCell->maxPos))
+            continue;
+
+        for(auto& pNode : itCell->arrNode)
+        {
+            const SEntry& entry = *m_aEntry.constFind(pNode);
+            if(util::rayToBox(dist, origin, dir, entry.minPos, entry.maxPos))
+                arrResult.append(qMakePair(dist, pNode));
+        }
+    }
+    std::sort(arrResult.begin(), arrResult.end(), [](const QPair<float, CNode*>& a, const QPair<float, CNode*>& b){return a.first < b.first;});
+    return arrResult;
+}
+
+QVector<CNode*> CSpatialIndex::queryFrustum(const QMatrix4x4& viewProjection) const
+{
+    const util::CFrustum frustum(viewProjection);
+    const auto isHit = [&frustum](const QVector3D& minBox, const QVector3D& maxBox){return frustum.isBoxVisible(minBox, maxBox);};
+    return query(isHit, isHit);
+}
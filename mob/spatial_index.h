@@ -0,0 +1,67 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <QHash>
+#include <QPair>
+#include <QQuaternion>
+#include <QVector>
+#include <QVector2D>
+#include <QVector3D>
+#include <QMatrix4x4>
+
+class CNode;
+
+///
+/// \brief The CSpatialIndex class is loose grid of world bounding boxes of mob nodes. Grid cell is landscape sector, node is put to the cell of its box center and cell bounds grow by boxes of its nodes. Only nodes changed since the last refresh (see CNode::setModified) are re-read
+///
+class CSpatialIndex
+{
+public:
+    CSpatialIndex(float cellSize = 32.0f);
+    void clear();
+    void refresh(const QList<CNode*>& arrNode);
+    void invalidate(CNode* pNode);
+    bool bounds(CNode* pNode, QVector3D& minPos, QVector3D& maxPos) const;
+    QVector<CNode*> queryBox(const QVector3D& minPos, const QVector3D& maxPos) const;
+    QVector<CNode*> queryCircle(const QVector2D& center, float radius) const;
+    QVector<QPair<float, CNode*>> queryRay(const QVector3D& origin, const QVector3D& dir) const;
+    QVector<CNode*> queryFrustum(const QMatrix4x4& viewProjection) const;
+
+private:
+    struct SEntry
+    {
+        uint revision;
+        uint pass;
+        qint64 cell;
+        int indexInCell;
+        QVector3D drawPos;
+        QQuaternion rotation;
+        QVector3D constitution;
+        QString modelName;
+        QVector3D localMin; // box of model, relative to draw position
+        QVector3D localMax;
+        QVector3D minPos;
+        QVector3D maxPos;
+    };
+    struct SCell
+    {
+        QVector<CNode*> arrNode;
+        QVector3D minPos; // loose bounds, they grow only until the cell becomes empty
+        QVector3D maxPos;
+    };
+    void readEntry(CNode* pNode, SEntry& entry, bool bReadModel);
+    void insertToCell(CNode* pNode, SEntry& entry);
+    void removeFromCell(const SEntry& entry);
+    qint64 cellKey(int x, int y) const {return (qint64(x) << 32) | quint32(y);}
+    template<typename TCellTest, typename TNodeTest>
+    QVector<CNode*> query(TCellTest isCellHit, TNodeTest isNodeHit) const;
+
+private:
+    float m_cellSize;
+    float m_maxHalfSize; // the largest half size of node box in XY, it extends searched cells
+    uint m_pass;
+    QHash<CNode*, SEntry> m_aEntry;
+    QHash<qint64, SCell> m_aCell;
+};
+
+#endif // SPATIAL_INDEX_H
@@ -0,0 +1,126 @@
+#include <QtEndian>
+
+#include "mpr_data.h"
+
+// Reads *.sec data after signature check. Incomplete data is read with zeroes, caller checks stream status if it needs
+bool SSecData::read(QDataStream& stream)
+{
+    uint signature;
+    stream >> signature;
+    if(signature != s_signature)
+        return false;
+
+    quint8 secType;
+    stream >> secType;
+    bWater = secType == 3;
+    auto readVertices = [&stream](QVector<SSecVertex>& arr)
+    {
+        arr.resize(s_nVertex*s_nVertex);
+        for(auto& vrt : arr)
+            stream >> vrt;
+    };
+
+    readVertices(arrVrt);
+    if(bWater)
+        readVertices(arrWaterVrt);
+
+    arrLandTilePacked.resize(s_nTile*s_nTile);
+    for(auto& tile : arrLandTilePacked)
+        stream >> tile;
+
+    if(bWater)
+    {
+        arrWaterTilePacked.resize(s_nTile*s_nTile);
+        for(auto& tile : arrWaterTilePacked)
+            stream >> tile;
+
+        arrWaterMaterial.resize(s_nTile*s_nTile);
+        for(auto& mat : arrWaterMaterial)
+            stream >> mat;
+    }
+    return true;
+}
+
+// Packs sector into *.sec format. The buffer is allocated once with exact size and filled by little-endian writes (no QDataStream), so sectors can be serialized in parallel
+QByteArray SSecData::write() const
+{
+    const int secSize = dataSize(bWater);
+    QByteArray secData(secSize, Qt::Uninitialized);
+    uchar* pData = reinterpret_cast<uchar*>(secData.data());
+    qToLittleEndian<quint32>(s_signature, pData);
+    pData += 4;
+    *pData++ = bWater ? quint8(3) : quint8(0);
+
+    auto writeVertices = [&pData](const QVector<SSecVertex>& arr)
+    {
+        for(auto& vrt: arr)
+        {
+            *pData++ = uchar(vrt.xOffset);
+            *pData++ = uchar(vrt.yOffset);
+            qToLittleEndian<quint16>(vrt.z, pData);
+            pData += 2;
+            qToLittleEndian<quint32>(vrt.packNormal(), pData);
+            pData += 4;
+        }
+    };
+
+    auto writeShorts = [&pData](const ushort* pSrc, int count)
+    {
+        for(int i(0); i<count; ++i)
+        {
+            qToLittleEndian<quint16>(pSrc[i], pData);
+            pData += 2;
+        }
+    };
+
+    writeVertices(arrVrt);
+    if(bWater)
+        writeVertices(arrWaterVrt);
+
+    writeShorts(arrLandTilePacked.constData(), arrLandTilePacked.size());
+    if(bWater)
+    {
+        writeShorts(arrWaterTilePacked.constData(), arrWaterTilePacked.size());
+        writeShorts(reinterpret_cast<const ushort*>(arrWaterMaterial.constData()), arrWaterMaterial.size());
+    }
+    Q_ASSERT(pData == reinterpret_cast<uchar*>(secData.data()) + secSize);
+
+    return secData;
+}
+
+// Checks signature of *.sec data (file can be incomplete while it is written by other tool)
+bool SSecData::isSecData(const QByteArray& data)
+{
+    return data.size() > 5 && qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData())) == s_signature;
+}
+
+int SSecData::dataSize(bool bWater)
+{
+    const int vrtSize = 8; // xOffset, yOffset, z, packed normal
+    return 4 + 1 + s_nVertex*s_nVertex*vrtSize*(bWater ? 2 : 1) + s_nTile*s_nTile*2*(bWater ? 3 : 1);
+}
+
+// Generates sector suffix by number: 001002 - sector x:1 y:2
+QString genSectorSuffix(int x, int y)
+{
+    QString name;
+    name.append('0');
+    if (x < 10)
+    {
+        name.append('0');
+        name.append(QString::number(x));
+    }
+    else {
+        name.append(QString::number(x));
+    }
+    name.append('0');
+    if (y < 10)
+    {
+        name.append('0');
+        name.append(QString::number(y));
+    }
+    else {
+        name.append(QString::number(y));
+    }
+    return name;
+}
@@ -0,0 +1,100 @@
+#ifndef MPR_DATA_H
+#define MPR_DATA_H
+
+#include <QByteArray>
+#include <QString>
+#include <QDataStream>
+#include <QVector>
+#include <QVector3D>
+
+// Data of *.mpr parts as it is stored in file. It doesn't depend on GL, so landscape is decoded by the same code in editor and ei_maper-cli
+
+struct SMapHeader
+{
+    static const uint s_signature = 0xce4af672;
+    uint   signature;
+    float  maxZ;
+    uint   nXSector;
+    uint   nYSector;
+    uint   nTexture;
+    uint   textureSize;
+    uint   nTile;
+    uint   tileSize;
+    ushort nMaterial;
+    uint   nAnimTile;
+
+    friend QDataStream& operator>> (QDataStream& is, SMapHeader& head)
+    {
+        return is >> head.signature >> head.maxZ >> head.nXSector >> head.nYSector  >>
+                     head.nTexture >> head.textureSize >> head.nTile >> head.tileSize >>
+                     head.nMaterial >> head.nAnimTile;
+    }
+
+    friend QDataStream& operator<< (QDataStream& os, const SMapHeader& head)
+    {
+        return os << head.signature << head.maxZ  << head.nXSector << head.nYSector <<
+                     head.nTexture << head.textureSize << head.nTile << head.tileSize <<
+                     head.nMaterial << head.nAnimTile;
+    }
+};
+
+struct SSecVertex
+{
+    qint8  xOffset;
+    qint8  yOffset;
+    ushort z;
+    uint32_t packedNormal; // temp var to unpack normal
+    QVector3D normal;
+
+    friend QDataStream& operator>> (QDataStream& st, SSecVertex& vert)
+    {
+        st >> vert.xOffset >> vert.yOffset >> vert.z >> vert.packedNormal;
+        vert.normal.setX((((vert.packedNormal >> 11) & 0x7FF) - 1000.0f) / 1000.0f);
+        vert.normal.setY(((vert.packedNormal & 0x7FF) - 1000.0f) / 1000.0f);
+        vert.normal.setZ((vert.packedNormal >> 22) / 1000.0f);
+        return st;
+    }
+
+    // rounding (not truncation) keeps packed value of unchanged normal byte-exact after unpacking
+    uint32_t packNormal() const
+    {
+        uint32_t packedX = qBound(0, qRound((normal.x() * 1000.0f) + 1000.0f), 2047) & 0x7FF;
+        uint32_t packedY = qBound(0, qRound((normal.y() * 1000.0f) + 1000.0f), 2047) & 0x7FF;
+        uint32_t packedZ = qBound(0, qRound( normal.z() * 1000.0f), 1023) & 0x3FF;
+
+        // Упаковываем компоненты в одно 32-битное число
+        return (packedZ << 22) | (packedX << 11) | packedY;
+    }
+
+    friend QDataStream& operator<< (QDataStream& st, SSecVertex& vert)
+    {
+        vert.packedNormal = vert.packNormal();
+        return st << vert.xOffset << vert.yOffset << vert.z << vert.packedNormal;
+    }
+};
+
+///
+/// \brief The SSecData struct is *.sec data in file order: lines of vertices from left down corner, then packed tiles by rows
+///
+struct SSecData
+{
+    static const uint s_signature = 0xcf4bf774;
+    static const int s_nVertex = 33; // vertices count by 1 side of sector
+    static const int s_nTile = 16;   // tiles count by 1 side of sector
+
+    bool read(QDataStream& stream);
+    QByteArray write() const;
+    static bool isSecData(const QByteArray& data);
+    static int dataSize(bool bWater);
+
+    bool bWater = false;
+    QVector<SSecVertex> arrVrt;
+    QVector<ushort> arrLandTilePacked;
+    QVector<SSecVertex> arrWaterVrt;
+    QVector<ushort> arrWaterTilePacked;
+    QVector<short> arrWaterMaterial;
+};
+
+QString genSectorSuffix(int x, int y);
+
+#endif // MPR_DATA_H
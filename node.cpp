@@ -3,6 +3,7 @@
 #include "node.h"
 
 uint CNode::s_freeId = 0;
+std::atomic<uint> CNode::s_changeCount(0);
 
 // generate color by node ID (for selecting)
 static SColor generateColor(int id)
@@ -18,6 +19,8 @@ void CNode::init()
     m_aChild.clear();
     ++s_freeId;
     m_id = s_freeId;
+    m_revision = 1; // new node is modified comparing with any raw data
+    m_rawRevision = 0;
     m_pickingColor = generateColor(m_id);
     //m_rotation ?
 }
@@ -35,9 +38,8 @@ CNode::CNode():
 
 CNode::CNode(CNode* parent):
     m_position(0.0, 0.0, 0.0)
+    ,m_parent(parent)
 {
-    if (m_parent)
-        m_parent = parent;
     init();
 }
 
@@ -79,4 +81,5 @@ void CNode::move(float x, float y, float z)
     m_position.setX(m_position.x()+x);
     m_position.setY(m_position.y()+y);
     m_position.setZ(m_position.z()+z);
+    setModified();
 }
@@ -3,10 +3,12 @@
 
 #include "QVector"
 #include <QQuaternion>
+#include <QMatrix4x4>
 #include <QGLWidget>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QJsonObject>
+#include <atomic>
 
 #include "types.h"
 #include "utils.h"
@@ -27,11 +29,13 @@ public:
     CNode(CNode* parent);
     CNode(const CNode& node);
     static uint s_freeId;
+    static std::atomic<uint> s_changeCount; // changes of saved data and draw positions of all nodes, mob indexes are refreshed only when it grows. Nodes are deserialized in several threads
     virtual ~CNode();
     virtual void draw(bool isActive, QOpenGLShaderProgram* program = nullptr) = 0;
     virtual void drawSelect(QOpenGLShaderProgram* program = nullptr) = 0;
     virtual ENodeType nodeType() = 0;
     virtual uint deserialize(util::CMobParser& parser) {Q_UNUSED(parser); Q_ASSERT("pure virtual" && false); return 0;} //todo: define this method in CObjectBase
+    virtual void deserializeChildren() {} // creates sub-objects (logic points, trap zones) stored by deserialize. deserialize can be called from worker thread, this one only from main
     virtual QString& modelName() = 0;
     virtual QString textureName() = 0;
     virtual QVector3D& minPosition() = 0;
@@ -53,29 +57,38 @@ public:
     virtual const QVector3D& constitution() = 0;
     virtual QJsonObject toJson() = 0;
     virtual CBox getBBox() = 0;
+    virtual bool intersectRay(float& dist, const QVector3D& origin, const QVector3D& dir) = 0;
+    virtual bool intersectFrustum(const QMatrix4x4& viewProj) = 0;
     virtual void markAsDeleted(bool bDeleted = true) = 0;
     virtual bool isMarkDeleted() = 0;
     virtual bool isOperationAxisAllow(EOperationAxisType type) = 0;
 
-    virtual void setRot(const QQuaternion& quat) {m_rotation = quat;}
-    virtual void setDrawPosition(QVector3D pos) {m_drawPosition = pos;}
+    virtual void setRot(const QQuaternion& quat) {m_rotation = quat; setModified();}
+    virtual void setDrawPosition(QVector3D pos) {m_drawPosition = pos; ++s_changeCount;}
 
     const uint& innerId() {return m_id; }
     const uint& mapId(){return m_mapID;}
-    void setMapId(uint id) {m_mapID = id;}
+    void setMapId(uint id) {m_mapID = id; setModified();}
     const QString& mapName(){return m_name;}
     void addChild(CNode* child) {m_aChild.append(child); child->setParent(this); }
     void setParent(CNode* parent) {m_parent = parent;}
     uchar* color() {return m_pickingColor.rgb; }
     bool isColorSuitable(const SColor& color) {return m_pickingColor == color; }
-    void setPos(QVector3D& pos) {m_position = pos;}
-    void setRot(const QVector4D& quat) {m_rotation = QQuaternion(quat);}
+    void setPos(QVector3D& pos) {m_position = pos; setModified();}
+    void setRot(const QVector4D& quat) {m_rotation = QQuaternion(quat); setModified();}
     QVector3D getEulerRotation();
+    const QQuaternion& rotation() {return m_rotation;}
     void move(float x, float y, float z);
     QVector3D& position() {return m_position; }
     QVector3D& drawPosition() {return m_drawPosition;}
     void setState(ENodeState state) {m_state = state;}
     ENodeState nodeState() {return m_state;}
+    // Every change of saved data must call setModified. Raw data of node is valid while its revision stays the same.
+    // Logic points are saved as part of unit or trap, so their parent is modified too
+    void setModified() {++m_revision; ++s_changeCount; if(m_parent) m_parent->setModified();}
+    uint revision() {return m_revision;}
+    void setRawData(const QByteArray& data) {m_rawData = data; m_rawRevision = revision();}
+    QByteArray rawData() {return revision() == m_rawRevision ? m_rawData : QByteArray();}
 
 private:
     void init();
@@ -95,7 +108,9 @@ protected:
 
 private:
     uint m_id;
-
+    uint m_revision; // counter of changes, see setModified
+    QByteArray m_rawData; // node as it was read from file (with header). It's written on save as is while node is not modified
+    uint m_rawRevision;
 };
 
 #endif // NODE_H
@@ -56,58 +56,70 @@ CLever::CLever(QJsonObject data):
 uint CLever::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("LEVER_SCIENCE_STATS"))
+        switch (parser.peekTag()) {
+        case util::eTagLeverScienceStats:
         {
             Q_ASSERT("unknow_tag" && false);
             readByte += parser.skipTag();//, eNull};
+            break;
         }
-        else if(parser.isNextTag("LEVER_CUR_STATE"))
+        case util::eTagLeverCurState:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_curState);
+            break;
         }
-        else if(parser.isNextTag("LEVER_TOTAL_STATE"))
+        case util::eTagLeverTotalState:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_totalState);
+            break;
         }
-        else if(parser.isNextTag("LEVER_IS_CYCLED"))
+        case util::eTagLeverIsCycled:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bCycled);
+            break;
         }
-        else if(parser.isNextTag("LEVER_CAST_ONCE"))
+        case util::eTagLeverCastOnce:
         { //TODO: not found this field in zone8.mob, delete/skip this?!
             Q_ASSERT("LEVER_CAST_ONCE" && false);
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bCastOnce);
+            break;
         }
-        else if(parser.isNextTag("LEVER_SCIENCE_STATS_NEW"))
+        case util::eTagLeverScienceStatsNew:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_typeOpen); // type open (0 - lever disabled, 1 - enabled, 5 - need hands sleight, 8 - need key)
             readByte += parser.readDword(m_keyID); // key ID for open
             readByte += parser.readDword(m_handsSleight); // sleight
+            break;
         }
-        else if(parser.isNextTag("LEVER_IS_DOOR"))
+        case util::eTagLeverIsDoor:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bDoor);
+            break;
         }
-        else if(parser.isNextTag("LEVER_RECALC_GRAPH"))
+        case util::eTagLeverRecalcGraph:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bRecalcGraph);
+            break;
         }
-        else
+        default:
         {
             uint baseByte = CWorldObj::deserialize(parser);
             if(baseByte > 0)
                 readByte += baseByte;
             else
-                break;
+                bNextTag = false;
+            break;
+        }
         }
     }
     Q_ASSERT(m_type==60);
@@ -196,6 +208,7 @@ void CLever::collectParams(QList<QSharedPointer<IPropertyBase>>& aProp, ENodeTyp
 
 void CLever::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()) {
     case eObjParam_LEVER_SCIENCE_STATS_Type_Open:
     {
@@ -37,47 +37,58 @@ CLight::CLight(QJsonObject data):
 uint CLight::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("LIGHT_RANGE"))
+        switch (parser.peekTag()) {
+        case util::eTagLightRange:
         {
             readByte += parser.skipHeader();
             readByte += parser.readFloat(m_range);
+            break;
         }
-        else if(parser.isNextTag("LIGHT_NAME"))
+        case util::eTagLightName:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_name, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("LIGHT_POSITION"))
+        case util::eTagLightPosition:
         {
             readByte += parser.skipHeader();
             readByte += parser.readPlot(m_position);
+            break;
         }
-        else if(parser.isNextTag("LIGHT_ID"))
+        case util::eTagLightId:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_mapID);
+            break;
         }
-        else if(parser.isNextTag("LIGHT_SHADOW"))
+        case util::eTagLightShadow:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bShadow);
+            break;
         }
-        else if(parser.isNextTag("LIGHT_COLOR"))
+        case util::eTagLightColor:
         {
             readByte += parser.skipHeader();
             readByte += parser.readPlot(m_color);
+            break;
         }
-        else if(parser.isNextTag("LIGHT_COMMENTS"))
+        case util::eTagLightComments:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_comment, parser.nodeLen());
+            break;
         }
-        else
+        default:
         {
+            bNextTag = false;
             break;
         }
+        }
     }
     return readByte;
 }
@@ -177,6 +188,7 @@ void CLight::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propType)
 
 void CLight::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()){
     case eObjParam_LIGHT_SHADOW:
     {
@@ -135,70 +135,94 @@ void CMagicTrap::draw(bool isActive, QOpenGLShaderProgram* program)
 uint CMagicTrap::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("MT_DIPLOMACY"))
+        switch (parser.peekTag()) {
+        case util::eTagMtDiplomacy:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_diplomacy);
+            break;
         }
-        else if(parser.isNextTag("MT_SPELL"))
+        case util::eTagMtSpell:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_spell, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("MT_AREAS"))
+        case util::eTagMtAreas:
         {
             readByte += parser.readHeader();
-            uint num;
-            readByte += parser.readDword(num); // numbers of area
-            for(uint i(0); i<num; ++i)
-            {
-                CActivationZone* pZone = new CActivationZone(this);
-                readByte += pZone->deserialize(parser);
-                QObject::connect(pZone, SIGNAL(changeActZone()), this, SLOT(update()));
-                m_aActZone.append(pZone);
-            }
-            //todo: check len
+            readByte += parser.readByteArray(m_actZoneData, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("MT_TARGETS"))
+        case util::eTagMtTargets:
         {
             readByte += parser.readHeader();
-            uint num;
-            readByte += parser.readDword(num);
-            for(uint i(0); i<num; ++i)
-            {
-                CTrapCastPoint* pCast = new CTrapCastPoint(this);
-                readByte += pCast->deserialize(parser);
-                QObject::connect(pCast, SIGNAL(changeCastPoint()), this, SLOT(update()));
-                m_aCastPoint.append(pCast);
-            }
-            //todo: check len
+            readByte += parser.readByteArray(m_castPointData, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("MT_CAST_INTERVAL"))
+        case util::eTagMtCastInterval:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_castInterval);
+            break;
         }
-        else if(parser.isNextTag("LEVER_CAST_ONCE"))
+        case util::eTagLeverCastOnce:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bCastOnce);
+            break;
         }
-        else
+        default:
         {
             uint baseByte = CWorldObj::deserialize(parser);
             if(baseByte > 0)
                 readByte += baseByte;
             else
-                break;
+                bNextTag = false;
+            break;
+        }
         }
     }
     Q_ASSERT(m_type==59);
-    update();
     return readByte;
 }
 
+void CMagicTrap::deserializeChildren()
+{
+    if(!m_actZoneData.isEmpty())
+    {
+        util::CMobParser parser(m_actZoneData);
+        uint num;
+        parser.readDword(num); // numbers of area
+        for(uint i(0); i<num; ++i)
+        {
+            CActivationZone* pZone = new CActivationZone(this);
+            pZone->deserialize(parser);
+            QObject::connect(pZone, SIGNAL(changeActZone()), this, SLOT(update()));
+            m_aActZone.append(pZone);
+        }
+        m_actZoneData.clear();
+    }
+    if(!m_castPointData.isEmpty())
+    {
+        util::CMobParser parser(m_castPointData);
+        uint num;
+        parser.readDword(num);
+        for(uint i(0); i<num; ++i)
+        {
+            CTrapCastPoint* pCast = new CTrapCastPoint(this);
+            pCast->deserialize(parser);
+            QObject::connect(pCast, SIGNAL(changeCastPoint()), this, SLOT(update()));
+            m_aCastPoint.append(pCast);
+        }
+        m_castPointData.clear();
+    }
+    update();
+}
+
 void CMagicTrap::serializeJson(QJsonObject& obj)
 {
     CWorldObj::serializeJson(obj);
@@ -308,6 +332,7 @@ void CMagicTrap::collectlogicParams(QList<QSharedPointer<IPropertyBase>>& aProp,
 
 void CMagicTrap::applyLogicParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()){
     case eObjParam_TRAP_DIPLOMACY:
     {
@@ -420,6 +445,7 @@ void CMagicTrap::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propTyp
 
 void CMagicTrap::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()) {
     case eObjParam_TRAP_DIPLOMACY:
     {
@@ -529,7 +555,7 @@ bool CMagicTrap::updatePos(QVector3D &pos)
 
 void CMagicTrap::setDrawPosition(QVector3D pos)
 {
-    m_drawPosition = pos;
+    CNode::setDrawPosition(pos);
     update();
 }
 
@@ -555,6 +581,7 @@ CTrapCastPoint *CMagicTrap::castPointById(int pointId)
 
 CActivationZone *CMagicTrap::createActZone()
 {
+    setModified();
     CActivationZone* pZone = new CActivationZone(this);
     m_aActZone.append(pZone);
     QVector3D pos(m_position.x(), m_position.y(), 0.0f);
@@ -566,6 +593,7 @@ CActivationZone *CMagicTrap::createActZone()
 
 void CMagicTrap::deleteLastActZone()
 {
+    setModified();
     auto pZone = m_aActZone.back();
     delete pZone;
     m_aActZone.pop_back();
@@ -574,6 +602,7 @@ void CMagicTrap::deleteLastActZone()
 
 CTrapCastPoint *CMagicTrap::createCastPoint()
 {
+    setModified();
     CTrapCastPoint* pCast = new CTrapCastPoint(this);
     m_aCastPoint.append(pCast);
     QVector3D pos(m_position.x(), m_position.y(), 0.0f);
@@ -585,6 +614,7 @@ CTrapCastPoint *CMagicTrap::createCastPoint()
 
 void CMagicTrap::deleteLastCastPoint()
 {
+    setModified();
     auto pCast = m_aCastPoint.back();
     delete pCast;
     m_aCastPoint.pop_back();
@@ -643,6 +673,7 @@ CActivationZone::CActivationZone(CMagicTrap* pTrap):
   ,m_radius(2.0f)
   ,m_pParent(pTrap)
 {
+    setParent(pTrap);
     updateFigure(CObjectList::getInstance()->getFigure("trapZone"));
     setTexture(CTextureList::getInstance()->texture("trapZone"));
 }
@@ -652,6 +683,7 @@ CActivationZone::CActivationZone(CMagicTrap* pTrap, const CActivationZone &zone)
   ,m_radius(zone.m_radius)
   ,m_pParent(pTrap)
 {
+    setParent(pTrap);
     updateFigure(CObjectList::getInstance()->getFigure("trapZone"));
     setTexture(CTextureList::getInstance()->texture("trapZone"));
     update();
@@ -718,6 +750,7 @@ void CActivationZone::getLogicParam(QSharedPointer<IPropertyBase>& prop, EObjPar
 
 void CActivationZone::applyLogicParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()){
     case eObjParam_POSITION:
     {
@@ -913,6 +946,7 @@ bool CActivationZone::isOperationAxisAllow(EOperationAxisType type)
 CTrapCastPoint::CTrapCastPoint(CMagicTrap *pTrap):
     m_pParent(pTrap)
 {
+    setParent(pTrap);
     updateFigure(CObjectList::getInstance()->getFigure("trapCast"));
     setTexture(CTextureList::getInstance()->texture("trapCast"));
 }
@@ -921,6 +955,7 @@ CTrapCastPoint::CTrapCastPoint(CMagicTrap *pTrap, const CTrapCastPoint &pCast):
     CObjectBase(pCast)
   ,m_pParent(pTrap)
 {
+    setParent(pTrap);
     updateFigure(CObjectList::getInstance()->getFigure("trapCast"));
     setTexture(CTextureList::getInstance()->texture("trapCast"));
 }
@@ -945,6 +980,7 @@ void CTrapCastPoint::collectlogicParams(QList<QSharedPointer<IPropertyBase>>& aP
 
 void CTrapCastPoint::applyLogicParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()){
     case eObjParam_POSITION:
     {
@@ -81,6 +81,7 @@ public:
     ENodeType nodeType() override {return ENodeType::eMagicTrap; }
     void draw(bool isActive, QOpenGLShaderProgram* program) override;
     uint deserialize(util::CMobParser& parser) override;
+    void deserializeChildren() override;
     void serializeJson(QJsonObject& obj) override;
     uint serialize(util::CMobParser& parser) override;
     void collectlogicParams(QList<QSharedPointer<IPropertyBase>>& aProp, ENodeType paramType) override;
@@ -124,6 +125,8 @@ private:
     bool m_bCastOnce;
     QVector<CActivationZone*> m_aActZone;
     QVector<CTrapCastPoint*> m_aCastPoint;
+    QByteArray m_actZoneData; // raw MT_AREAS and MT_TARGETS data, zones and cast points are created from them in deserializeChildren
+    QByteArray m_castPointData;
 
 
 
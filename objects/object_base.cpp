@@ -7,6 +7,10 @@
 #include "log.h"
 #include "resourcemanager.h"
 #include "property.h"
+#include "math_utils.h"
+
+// half size of box for nodes without model, the same as CSpatialIndex uses
+static const float s_markerHalfSize = 0.5f;
 
 CObjectBase::CObjectBase(): 
   m_modelName("")
@@ -210,6 +214,7 @@ uint CObjectBase::serialize(util::CMobParser &parser)
 bool CObjectBase::updatePos(QVector3D& pos)
 {
     m_position = pos;
+    setModified();
     CLandscape::getInstance()->projectPosition(this);
     return true;
 }
@@ -217,6 +222,7 @@ bool CObjectBase::updatePos(QVector3D& pos)
 void CObjectBase::setConstitution(QVector3D &vec)
 {
     m_complection = vec;
+    setModified();
     recalcFigure();
     CLandscape::getInstance()->projectPosition(this);
 }
@@ -284,15 +290,15 @@ CBox CObjectBase::getBBox()
         auto& arrVert = part->vertData();
         for(int i(0); i < arrVert.size(); ++i)
         {
+            rotatedPos = rtMatrix*arrVert[i].position; //get vector, rotated with matrix
             if(!bInit)
-            {
-                min = arrVert[i].position;
-                max = arrVert[i].position;
+            { // box starts from the first rotated vertex, not from model space one
+                min = rotatedPos;
+                max = rotatedPos;
                 bInit = true;
                 continue;
             }
 
-            rotatedPos = rtMatrix*arrVert[i].position; //get vector, rotated with matrix
             fillPoint(rotatedPos);
         }
     }
@@ -301,6 +307,96 @@ CBox CObjectBase::getBBox()
    return bbox;
 }
 
+// the same objects as drawSelect skips
+bool CObjectBase::isPickable()
+{
+    return !isMarkDeleted() && m_state != ENodeState::eHidden;
+}
+
+///
+/// \brief checks intersection of ray with triangles of visible model parts
+/// \param out. dist - ray parameter (in dir lengths) of the nearest hit
+/// \param in. origin - start point of ray in world space
+/// \param in. dir - direction of ray in world space
+/// \return true if ray hits the model (or marker box of object without model)
+///
+bool CObjectBase::intersectRay(float& dist, const QVector3D& origin, const QVector3D& dir)
+{
+    if(!isPickable())
+        return false;
+
+    // vertices are stored in model space, so the ray is moved there instead of every vertex
+    const QQuaternion invRotation = m_rotation.inverted();
+    const QVector3D localOrigin = invRotation.rotatedVector(origin - m_drawPosition);
+    QVector3D localDir = invRotation.rotatedVector(dir);
+    bool bHasTriangle = false;
+    bool bHit = false;
+    float t(0.0f), u(0.0f), v(0.0f);
+    QVector3D vert0, vert1, vert2;
+    for(auto& part: m_aPart)
+    {
+        if(!part->isVisible())
+            continue;
+
+        const auto& arrVert = part->vertData(); // const access, vertex data can be shared with copied parts
+        for(int i(0); i+2 < arrVert.size(); i+=3) // not indexed, see CPart::update
+        {
+            bHasTriangle = true;
+            vert0 = arrVert[i].position;
+            vert1 = arrVert[i+1].position;
+            vert2 = arrVert[i+2].position;
+            if(!util::ptToTriangle(t, u, v, localOrigin, localDir, vert0, vert1, vert2) || t < 0.0f)
+                continue;
+
+            if(!bHit || t < dist)
+                dist = t;
+            bHit = true;
+        }
+    }
+    if(bHasTriangle)
+        return bHit;
+
+    const QVector3D halfSize(s_markerHalfSize, s_markerHalfSize, s_markerHalfSize);
+    return util::rayToBox(dist, localOrigin, localDir, -halfSize, halfSize);
+}
+
+///
+/// \brief checks if any vertex of visible model parts is inside of frustum
+/// \param in. viewProj - view-projection matrix of frustum
+/// \return true if model (or marker box of object without model) is inside of frustum at least partially
+///
+bool CObjectBase::intersectFrustum(const QMatrix4x4& viewProj)
+{
+    if(!isPickable())
+        return false;
+
+    QMatrix4x4 matrix;
+    matrix.setToIdentity();
+    matrix.translate(m_drawPosition);
+    matrix.rotate(m_rotation);
+    // planes in model space
+    const util::CFrustum frustum(viewProj * matrix);
+    bool bHasTriangle = false;
+    for(auto& part: m_aPart)
+    {
+        if(!part->isVisible())
+            continue;
+
+        const auto& arrVert = part->vertData();
+        for(auto& vert : arrVert)
+        {
+            bHasTriangle = true;
+            if(frustum.isBoxVisible(vert.position, vert.position))
+                return true;
+        }
+    }
+    if(bHasTriangle)
+        return false;
+
+    const QVector3D halfSize(s_markerHalfSize, s_markerHalfSize, s_markerHalfSize);
+    return frustum.isBoxVisible(-halfSize, halfSize);
+}
+
 void CObjectBase::setRot(const QQuaternion& quat)
 {
     CNode::setRot(quat);
@@ -375,6 +471,7 @@ void CObjectBase::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propTy
 
 void CObjectBase::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()) {
     case eObjParam_NID:
     {
@@ -47,13 +47,16 @@ public:
     void setConstitution(QVector3D& vec) override;
     QJsonObject toJson() override;
     CBox getBBox() override final;
-    void markAsDeleted(bool bDeleted = true) override {m_bDeleted = bDeleted;}
+    bool intersectRay(float& dist, const QVector3D& origin, const QVector3D& dir) override final;
+    bool intersectFrustum(const QMatrix4x4& viewProj) override final;
+    void markAsDeleted(bool bDeleted = true) override {m_bDeleted = bDeleted; setModified();}
     bool isMarkDeleted() override {return m_bDeleted;}
     bool isOperationAxisAllow(EOperationAxisType type) override {Q_UNUSED(type); return true;};
 
 protected:
     void recalcFigure();
     void recalcMinPos();
+    bool isPickable();
     //void updateVisibility(QVector<QString>& aPart);
 
 protected:
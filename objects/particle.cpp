@@ -31,40 +31,52 @@ CParticle::CParticle(QJsonObject data):
 uint CParticle::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("PARTICL_ID"))
+        switch (parser.peekTag()) {
+        case util::eTagParticlId:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_mapID);
+            break;
         }
-        else if(parser.isNextTag("PARTICL_POSITION"))
+        case util::eTagParticlPosition:
         {
             readByte += parser.skipHeader();
             readByte += parser.readPlot(m_position);
+            break;
         }
-        else if(parser.isNextTag("PARTICL_COMMENTS"))
+        case util::eTagParticlComments:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_comment, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("PARTICL_NAME"))
+        case util::eTagParticlName:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_name, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("PARTICL_TYPE"))
+        case util::eTagParticlType:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_kind);
+            break;
         }
-        else if(parser.isNextTag("PARTICL_SCALE"))
+        case util::eTagParticlScale:
         {
             readByte += parser.skipHeader();
             readByte += parser.readFloat(m_scale);
+            break;
         }
-        else
+        default:
+        {
+            bNextTag = false;
             break;
+        }
+        }
     }
 
     return readByte;
@@ -145,6 +157,7 @@ void CParticle::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propType
 
 void CParticle::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type())
     {
     case eObjParam_PARTICL_TYPE:
@@ -51,73 +51,89 @@ CSound::CSound(QJsonObject data):
 uint CSound::deserialize(util::CMobParser &parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("SOUND_ID"))
+        switch (parser.peekTag()) {
+        case util::eTagSoundId:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_mapID);
+            break;
         }
-        else if(parser.isNextTag("SOUND_POSITION"))
+        case util::eTagSoundPosition:
         {
             readByte += parser.skipHeader();
             readByte += parser.readPlot(m_position);
+            break;
         }
-        else if(parser.isNextTag("SOUND_RANGE"))
+        case util::eTagSoundRange:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_range);
+            break;
         }
-        else if(parser.isNextTag("SOUND_NAME"))
+        case util::eTagSoundName:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_name, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("SOUND_MIN"))
+        case util::eTagSoundMin:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_min);
+            break;
         }
-        else if(parser.isNextTag("SOUND_MAX"))
+        case util::eTagSoundMax:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_max);
+            break;
         }
-        else if(parser.isNextTag("SOUND_COMMENTS"))
+        case util::eTagSoundComments:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_comment, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("SOUND_VOLUME"))
+        case util::eTagSoundVolume:
         {
             Q_ASSERT("SOUND_VOLUME" && false);
             readByte += parser.skipTag();
             //, eNull};
+            break;
         }
-        else if(parser.isNextTag("SOUND_RESNAME"))
+        case util::eTagSoundResname:
         {
             readByte += parser.skipHeader();
             readByte += parser.readStringArray(m_aResName);
+            break;
         }
-        else if(parser.isNextTag("SOUND_RANGE2"))
+        case util::eTagSoundRange2:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_range2);
+            break;
         }
-        else if(parser.isNextTag("SOUND_AMBIENT"))
+        case util::eTagSoundAmbient:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bAmbient);
+            break;
         }
-        else if(parser.isNextTag("SOUND_IS_MUSIC"))
+        case util::eTagSoundIsMusic:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bMusic);
+            break;
         }
-        else
+        default:
         {
+            bNextTag = false;
             break;
         }
+        }
     }
     return readByte;
 }
@@ -260,6 +276,7 @@ void CSound::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propType)
 
 void CSound::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type())
     {
     case eObjParam_RANGE:
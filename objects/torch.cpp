@@ -33,30 +33,37 @@ CTorch::CTorch(QJsonObject data):
 uint CTorch::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("TORCH_STRENGHT"))
+        switch (parser.peekTag()) {
+        case util::eTagTorchStrenght:
         {
             readByte += parser.skipHeader();
             readByte += parser.readFloat(m_power);
+            break;
         }
-        else if(parser.isNextTag("TORCH_PTLINK"))
+        case util::eTagTorchPtlink:
         {
             readByte += parser.skipHeader();
             readByte += parser.readPlot(m_pointLink);
+            break;
         }
-        else if(parser.isNextTag("TORCH_SOUND"))
+        case util::eTagTorchSound:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_sound, parser.nodeLen());
+            break;
         }
-        else
+        default:
         {
             uint baseByte = CWorldObj::deserialize(parser);
             if(baseByte > 0)
                 readByte += baseByte;
             else
-                break;
+                bNextTag = false;
+            break;
+        }
         }
     }
     if(m_type!=58)
@@ -141,6 +148,7 @@ void CTorch::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propType)
 
 void CTorch::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()) {
     case eObjParam_TORCH_PTLINK:
     {
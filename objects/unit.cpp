@@ -102,76 +102,88 @@ uint CUnit::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
     int logicNum(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("UNIT_R"))
+        switch (parser.peekTag()) {
+        case util::eTagUnitR:
         {
             Q_ASSERT("UNIT_R" && false);
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_type);
+            break;
         }
-        else if(parser.isNextTag("UNIT_PROTOTYPE"))
+        case util::eTagUnitPrototype:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_prototypeName, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("UNIT_ITEMS"))
+        case util::eTagUnitItems:
         {
             Q_ASSERT("UNIT_ITEMS" && false);
+            readByte += parser.skipTag();//, eNull};
+            break;
         }
-        else if(parser.isNextTag("UNIT_STATS"))
+        case util::eTagUnitStats:
         {
             readByte += parser.readHeader();
             readByte += parser.readUnitStats(m_stat, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("UNIT_QUEST_ITEMS"))
+        case util::eTagUnitQuestItems:
         {
             readByte += parser.skipHeader();
             readByte += parser.readStringArray(m_aQuestItem);
+            break;
         }
-        else if(parser.isNextTag("UNIT_QUICK_ITEMS"))
+        case util::eTagUnitQuickItems:
         {
             readByte += parser.skipHeader();
             readByte += parser.readStringArray(m_aQuickItem);
+            break;
         }
-        else if(parser.isNextTag("UNIT_SPELLS"))
+        case util::eTagUnitSpells:
         {
             readByte += parser.skipHeader();
             readByte += parser.readStringArray(m_aSpell);
+            break;
         }
-        else if(parser.isNextTag("UNIT_WEAPONS"))
+        case util::eTagUnitWeapons:
         {
             readByte += parser.skipHeader();
             readByte += parser.readStringArray(m_aWeapon);
+            break;
         }
-        else if(parser.isNextTag("UNIT_ARMORS"))
+        case util::eTagUnitArmors:
         {
             readByte += parser.skipHeader();
             readByte += parser.readStringArray(m_aArmor);
+            break;
         }
-        else if(parser.isNextTag("UNIT_NEED_IMPORT"))
+        case util::eTagUnitNeedImport:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bImport);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC"))
+        case util::eTagUnitLogic:
         {
             readByte += parser.skipHeader();
             CLogic* pLogic = m_aLogic[logicNum];
             readByte += pLogic->deserialize(parser);
             ++logicNum;
+            break;
         }
-        else
+        default:
         {
             uint baseByte = CWorldObj::deserialize(parser);
             if(baseByte > 0)
                 readByte += baseByte;
             else
-            { //debugging branch :)
-                auto tag = parser.nextTag();
-                Q_UNUSED(tag);
-                break;
-            }
+                bNextTag = false;
+            break;
+        }
         }
         //"UNIT_R", eNull};
         //"UNIT_ITEMS", eNull};
@@ -183,6 +195,12 @@ uint CUnit::deserialize(util::CMobParser& parser)
     return readByte;
 }
 
+void CUnit::deserializeChildren()
+{
+    for(auto& pLogic : m_aLogic)
+        pLogic->deserializeChildren();
+}
+
 void CUnit::serializeJson(QJsonObject& obj)
 {
     CWorldObj::serializeJson(obj);
@@ -365,6 +383,7 @@ void CUnit::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propType)
 
 void CUnit::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type())
     {
     case eObjParam_UNIT_NEED_IMPORT:
@@ -420,6 +439,7 @@ void CUnit::getLogicParam(QSharedPointer<IPropertyBase>& prop, EObjParam propTyp
 
 void CUnit::applyLogicParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     m_aLogic.front()->applyLogicParam(prop);
 }
 
@@ -491,6 +511,7 @@ void CUnit::clearLogicSelect()
 
 void CUnit::clearPaths()
 {
+    setModified();
     m_aLogic.front()->clearLogicPaths();
     addFirstPatrolPoint();
 }
@@ -502,6 +523,7 @@ bool CUnit::isChild(CPatrolPoint *pPointIn)
 
 void CUnit::addFirstPatrolPoint()
 {
+    setModified();
     QVector3D pos(m_position);
     CLandscape::getInstance()->projectPt(pos);
     m_aLogic.front()->addFirstPoint(pos);
@@ -509,6 +531,7 @@ void CUnit::addFirstPatrolPoint()
 
 void CUnit::undo_addFirstPatrolPoint()
 {
+    setModified();
     m_aLogic.front()->undo_addFirstPoint();
 }
 
@@ -529,21 +552,25 @@ void CUnit::getViewId(int &parentPatrol, int &parentView, CLookPoint *pPoint)
 
 void CUnit::createPatrolByIndex(int index)
 {
+    setModified();
     m_aLogic.front()->createPatrolByIndex(index);
 }
 
 void CUnit::undo_createPatrolByIndex(int index)
 {
+    setModified();
     m_aLogic.front()->undo_createPatrolByIndex(index);
 }
 
 void CUnit::createViewByIndex(int pointId, int viewId)
 {
+    setModified();
     m_aLogic.front()->createViewByIndex(pointId, viewId);
 }
 
 void CUnit::undo_createViewByIndex(int pointId, int viewId)
 {
+    setModified();
     m_aLogic.front()->undo_createViewByIndex(pointId, viewId);
 }
 
@@ -554,6 +581,7 @@ CPatrolPoint *CUnit::patrolByIndex(int index)
 
 void CUnit::resetLogic()
 {
+    setModified();
     //todo: realise resetting logic instead deleting
     for(auto& pLogic : m_aLogic)
         delete pLogic;
@@ -595,7 +623,11 @@ CLogic::CLogic(CUnit* unit, const CLogic &logic):
     m_alwaysActive = logic.m_alwaysActive;
     m_agressionMode = logic.m_agressionMode;
     for(auto pP: logic.m_aPatrolPt)
-        m_aPatrolPt.append(new CPatrolPoint(*pP));
+    {
+        CPatrolPoint* pPoint = new CPatrolPoint(*pP);
+        pPoint->setParent(m_parent);
+        m_aPatrolPt.append(pPoint);
+    }
 
     m_aDrawPoint = logic.m_aDrawPoint;
     createLogicLines();
@@ -921,6 +953,7 @@ void CLogic::addNewPatrolPoint(CPatrolPoint *base, CPatrolPoint *created)
 {
     int i = m_aPatrolPt.indexOf(base);
     m_aPatrolPt.insert(i+1, created);
+    m_parent->setModified();
     QObject::connect(created, SIGNAL(patrolChanges()), this, SLOT(createLogicLines()));
     QObject::connect(created, SIGNAL(addNewPatrolPoint(CPatrolPoint*,CPatrolPoint*)), this, SLOT(addNewPatrolPoint(CPatrolPoint*,CPatrolPoint*)));
     QObject::connect(created, SIGNAL(undo_addNewPatrolPoint(CPatrolPoint*)), this, SLOT(undo_addNewPatrolPoint(CPatrolPoint*)));
@@ -932,6 +965,7 @@ void CLogic::undo_addNewPatrolPoint(CPatrolPoint *pCreated)
     int index = m_aPatrolPt.indexOf(pCreated);
     m_aPatrolPt.removeAt(index);
     delete pCreated;
+    m_parent->setModified();
     createLogicLines();
 }
 
@@ -1148,6 +1182,7 @@ bool CLogic::isChild(CPatrolPoint *pPointIn)
 void CLogic::addFirstPoint(QVector3D& pos)
 {
     CPatrolPoint* pPoint = new CPatrolPoint();
+    pPoint->setParent(m_parent);
     pPoint->updatePos(pos);
     m_aPatrolPt.push_front(pPoint);
     pPoint->setState(ENodeState::eSelect);
@@ -1189,6 +1224,7 @@ void CLogic::getViewId(int &parentPatrol, int &parentView, CLookPoint *pPoint)
 void CLogic::createPatrolByIndex(int index)
 {
     CPatrolPoint* pPoint = new CPatrolPoint();
+    pPoint->setParent(m_parent);
     if(index >= 0)
     {
         QVector3D pos = m_aPatrolPt[index]->position();
@@ -1226,94 +1262,124 @@ void CLogic::undo_createViewByIndex(int pointId, int viewId)
     pPoint->undo_createViewByIndex(viewId);
 }
 
+// returns nullptr if there is no point with the index (it was removed)
 CPatrolPoint *CLogic::patrolByIndex(int index)
 {
-    Q_ASSERT(index < m_aPatrolPt.size());
+    if(index < 0 || index >= m_aPatrolPt.size())
+        return nullptr;
+
     return m_aPatrolPt[index];
 }
 
 uint CLogic::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("UNIT_LOGIC_CYCLIC"))
+        switch (parser.peekTag()) {
+        case util::eTagUnitLogicCyclic:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bCyclic);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_MODEL"))
+        case util::eTagUnitLogicModel:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_behaviour);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_GUARD_R"))
+        case util::eTagUnitLogicGuardR:
         {
             readByte += parser.skipHeader();
             readByte += parser.readFloat(m_guardRadius);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_GUARD_PT"))
+        case util::eTagUnitLogicGuardPt:
         {
             readByte += parser.skipHeader();
             readByte += parser.readPlot(m_guardPlacement);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_NALARM"))
+        case util::eTagUnitLogicNalarm:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_numAlarm);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_USE"))
+        case util::eTagUnitLogicUse:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_use);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_WAIT"))
+        case util::eTagUnitLogicWait:
         {
             readByte += parser.skipHeader();
             readByte += parser.readFloat(m_wait);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_ALARM_CONDITION"))
+        case util::eTagUnitLogicAlarmCondition:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_alarmCondition);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_HELP"))
+        case util::eTagUnitLogicHelp:
         {
             readByte += parser.skipHeader();
             readByte += parser.readFloat(m_help);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_ALWAYS_ACTIVE"))
+        case util::eTagUnitLogicAlwaysActive:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_alwaysActive);
+            break;
         }
-        else if(parser.isNextTag("UNIT_LOGIC_AGRESSION_MODE"))
+        case util::eTagUnitLogicAgressionMode:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_agressionMode);
+            break;
         }
-        else if(parser.isNextTag("GUARD_PT"))
+        case util::eTagGuardPt:
         {
-            readByte += parser.skipHeader();
-            CPatrolPoint* place = new CPatrolPoint(); //need unit parent?
-            //place->attachMob(m_parent->mob());
-            QObject::connect(place, SIGNAL(patrolChanges()), this, SLOT(recalcPatrolPath()));
-            QObject::connect(place, SIGNAL(addNewPatrolPoint(CPatrolPoint*,CPatrolPoint*)), this, SLOT(addNewPatrolPoint(CPatrolPoint*,CPatrolPoint*)));
-            QObject::connect(place, SIGNAL(undo_addNewPatrolPoint(CPatrolPoint*)), this, SLOT(undo_addNewPatrolPoint(CPatrolPoint*)));
-            readByte += place->deserialize(parser);
-
-            m_aPatrolPt.append(place);
+            readByte += parser.readHeader();
+            QByteArray pointData;
+            readByte += parser.readByteArray(pointData, parser.nodeLen());
+            m_arrPatrolPtData.append(pointData);
+            break;
         }
-        else
+        default:
         {
-            auto a = parser.nextTag();
+            bNextTag = false;
             break;
         }
+        }
     }
-    createLogicLines();
     return readByte;
 }
 
+void CLogic::deserializeChildren()
+{
+    for(auto& pointData : m_arrPatrolPtData)
+    {
+        util::CMobParser parser(pointData);
+        CPatrolPoint* place = new CPatrolPoint();
+        place->setParent(m_parent);
+        QObject::connect(place, SIGNAL(patrolChanges()), this, SLOT(recalcPatrolPath()));
+        QObject::connect(place, SIGNAL(addNewPatrolPoint(CPatrolPoint*,CPatrolPoint*)), this, SLOT(addNewPatrolPoint(CPatrolPoint*,CPatrolPoint*)));
+        QObject::connect(place, SIGNAL(undo_addNewPatrolPoint(CPatrolPoint*)), this, SLOT(undo_addNewPatrolPoint(CPatrolPoint*)));
+        place->deserialize(parser);
+
+        m_aPatrolPt.append(place);
+    }
+    m_arrPatrolPtData.clear();
+    createLogicLines();
+}
+
 void CLogic::serializeJson(QJsonObject& obj)
 {
     obj.insert("Is cyclyc?", m_bCyclic);
@@ -1365,7 +1431,8 @@ void CLogic::deSerializeJson(QJsonObject data)
     QJsonArray arrPP = data["Patrol Points"].toArray();
     for(auto it=arrPP.begin(); it<arrPP.end(); ++it)
     {
-        CPatrolPoint* place = new CPatrolPoint(); //need unit parent?
+        CPatrolPoint* place = new CPatrolPoint();
+        place->setParent(m_parent);
         place->deSerializeJson(it->toObject());
         m_aPatrolPt.append(place);
         QObject::connect(place, SIGNAL(patrolChanges()), this, SLOT(recalcPatrolPath()));
@@ -1451,7 +1518,11 @@ CPatrolPoint::CPatrolPoint(const CPatrolPoint &patrol):
     //m_indexBuf = patrol.m_indexBuf;
     CLookPoint* pPoint = nullptr;
     foreach(pPoint, patrol.m_aLookPt)
-        m_aLookPt.append(new CLookPoint(*pPoint));
+    {
+        CLookPoint* pLook = new CLookPoint(*pPoint);
+        pLook->setParent(this);
+        m_aLookPt.append(pLook);
+    }
 
     m_aDrawingLine = patrol.m_aDrawingLine;
     update();
@@ -1565,6 +1636,7 @@ void CPatrolPoint::addNewLookPoint(CLookPoint *pBase, CLookPoint *pCreated)
 {
     int i = m_aLookPt.indexOf(pBase);
     m_aLookPt.insert(i+1, pCreated);
+    setModified();
     QObject::connect(pCreated, SIGNAL(lookPointChanges()), this, SLOT(update()));
     QObject::connect(pCreated, SIGNAL(addNewLookPoint(CLookPoint*,CLookPoint*)), this, SLOT(addNewLookPoint(CLookPoint*,CLookPoint*)));
     QObject::connect(pCreated, SIGNAL(undo_addNewLookPoint(CLookPoint*)), this, SLOT(undo_addNewLookPoint(CLookPoint*)));
@@ -1576,42 +1648,51 @@ void CPatrolPoint::undo_addNewLookPoint(CLookPoint *pCreated)
     int index = m_aLookPt.indexOf(pCreated);
     m_aLookPt.removeAt(index);
     delete pCreated;
+    setModified();
     update();
 }
 
 uint CPatrolPoint::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("GUARD_PT_POSITION"))
+        switch (parser.peekTag()) {
+        case util::eTagGuardPtPosition:
         {
             QVector3D pos;
             readByte += parser.skipHeader();
             readByte += parser.readPlot(pos);
             setPos(pos);
             setDrawPosition(pos);
+            break;
         }
-        else if(parser.isNextTag("GUARD_PT_ACTION"))
+        case util::eTagGuardPtAction:
         {
             Q_ASSERT("GUARD_PT_ACTION" && false);
+            readByte += parser.skipTag();//, eNull};
+            break;
         }
-        else if(parser.isNextTag("ACTION_PT"))
+        case util::eTagActionPt:
         {
             readByte += parser.skipHeader();
             CLookPoint* pLook = new CLookPoint();
+            pLook->setParent(this);
             readByte += pLook->deserialize(parser);
             QObject::connect(pLook, SIGNAL(lookPointChanges()), this, SLOT(update()));
             QObject::connect(pLook, SIGNAL(addNewLookPoint(CLookPoint*,CLookPoint*)), this, SLOT(addNewLookPoint(CLookPoint*,CLookPoint*)));
             QObject::connect(pLook, SIGNAL(undo_addNewLookPoint(CLookPoint*)), this, SLOT(undo_addNewLookPoint(CLookPoint*)));
 
             m_aLookPt.append(pLook);
+            break;
         }
-        else
+        default:
         {
-            auto a = parser.nextTag();
+            bNextTag = false;
             break;
         }
+        }
     }
     return readByte;
 }
@@ -1647,6 +1728,7 @@ void CPatrolPoint::getLogicParam(QSharedPointer<IPropertyBase>& prop, EObjParam
 
 void CPatrolPoint::applyLogicParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()){
     case eObjParam_POSITION:
     {
@@ -1733,6 +1815,7 @@ void CPatrolPoint::deSerializeJson(QJsonObject data)
     for(auto it=arrLP.begin(); it<arrLP.end(); ++it)
     {
         CLookPoint* pLook = new CLookPoint();
+        pLook->setParent(this);
         pLook->deSerializeJson(it->toObject());
         QObject::connect(pLook, SIGNAL(lookPointChanges()), this, SLOT(update()));
         QObject::connect(pLook, SIGNAL(addNewLookPoint(CLookPoint*,CLookPoint*)), this, SLOT(addNewLookPoint(CLookPoint*,CLookPoint*)));
@@ -1798,6 +1881,7 @@ bool CPatrolPoint::isOperationAxisAllow(EOperationAxisType type)
 CPatrolPoint* CPatrolPoint::createNewPoint()
 {
     CPatrolPoint* pPoint = new CPatrolPoint;
+    pPoint->setParent(m_parent);
     pPoint->updatePos(m_position);
     emit addNewPatrolPoint(this, pPoint);
     return pPoint;
@@ -1811,6 +1895,7 @@ void CPatrolPoint::undo_createNewPoint(CPatrolPoint *pCreatedPoint)
 void CPatrolPoint::addFirstViewPoint()
 {
     CLookPoint* pPoint = new CLookPoint();
+    pPoint->setParent(this);
     pPoint->updatePos(m_position);
     m_aLookPt.push_front(pPoint);
     pPoint->setState(ENodeState::eSelect);
@@ -1825,6 +1910,7 @@ void CPatrolPoint::undo_addFirstViewPoint()
     CLookPoint* pPoint = m_aLookPt.front();
     m_aLookPt.pop_front();
     delete pPoint;
+    setModified();
 }
 
 int CPatrolPoint::getViewId(CLookPoint *pPoint)
@@ -1835,6 +1921,7 @@ int CPatrolPoint::getViewId(CLookPoint *pPoint)
 void CPatrolPoint::createViewByIndex(int index)
 {
     CLookPoint* pPoint = new CLookPoint();
+    pPoint->setParent(this);
     if(index >= 0)
     {
         QVector3D pos = m_aLookPt[index]->position();
@@ -1855,12 +1942,16 @@ void CPatrolPoint::undo_createViewByIndex(int index)
     auto pLook = m_aLookPt.at(index+1);
     m_aLookPt.remove(index+1);
     delete pLook;
+    setModified();
     update();
 }
 
+// returns nullptr if there is no point with the index (it was removed)
 CLookPoint *CPatrolPoint::viewByIndex(int index)
 {
-    Q_ASSERT(index < m_aLookPt.size());
+    if(index < 0 || index >= m_aLookPt.size())
+        return nullptr;
+
     return m_aLookPt[index];
 }
 
@@ -1922,6 +2013,7 @@ void CLookPoint::getLogicParam(QSharedPointer<IPropertyBase>& prop, EObjParam pr
 
 void CLookPoint::applyLogicParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type()){
     case eObjParam_POSITION:
     {
@@ -1989,36 +2081,43 @@ void CLookPoint::collectlogicParams(QList<QSharedPointer<IPropertyBase>>& aProp,
 uint CLookPoint::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("ACTION_PT_LOOK_PT"))
+        switch (parser.peekTag()) {
+        case util::eTagActionPtLookPt:
         {
             QVector3D pos;
             readByte += parser.skipHeader();
             readByte += parser.readPlot(pos);
             setPos(pos);
             setDrawPosition(pos);
+            break;
         }
-        else if(parser.isNextTag("ACTION_PT_WAIT_SEG"))
+        case util::eTagActionPtWaitSeg:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_wait);
+            break;
         }
-        else if(parser.isNextTag("ACTION_PT_TURN_SPEED"))
+        case util::eTagActionPtTurnSpeed:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_turnSpeed);
+            break;
         }
-        else if(parser.isNextTag("ACTION_PT_FLAGS"))
+        case util::eTagActionPtFlags:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_flag);
+            break;
         }
-        else
+        default:
         {
-            auto a = parser.nextTag();
+            bNextTag = false;
             break;
         }
+        }
     }
     return readByte;
 
@@ -2096,6 +2195,7 @@ bool CLookPoint::isOperationAxisAllow(EOperationAxisType type)
 CLookPoint *CLookPoint::createLookPoint()
 {
     CLookPoint* pPoint = new CLookPoint();
+    pPoint->setParent(m_parent);
     pPoint->updatePos(m_position);
     emit addNewLookPoint(this, pPoint);
     return pPoint;
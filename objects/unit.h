@@ -105,6 +105,7 @@ public:
     void draw(bool isActive, QOpenGLShaderProgram* program);
     void drawSelect(QOpenGLShaderProgram* program = nullptr);
     uint deserialize(util::CMobParser& parser);
+    void deserializeChildren();
     void serializeJson(QJsonObject& obj);
     void deSerializeJson(QJsonObject data);
     uint serialize(util::CMobParser& parser);
@@ -162,6 +163,7 @@ private:
     char m_alwaysActive; // true/false. this flag ignore inactive state
     char m_agressionMode; //agressive, revenge, fear, fear player
     QVector<CPatrolPoint*> m_aPatrolPt;
+    QVector<QByteArray> m_arrPatrolPtData; // raw GUARD_PT nodes, patrol points are created from them in deserializeChildren
 
     QVector<QVector3D> m_aDrawPoint; //opengl path lines
     QVector<QVector3D> m_aHelpPoint; //opengl path lines
@@ -177,6 +179,7 @@ public:
     ~CUnit() override;
     ENodeType nodeType() override {return ENodeType::eUnit; }
     uint deserialize(util::CMobParser& parser) override;
+    void deserializeChildren() override;
     void draw(bool isActive, QOpenGLShaderProgram* program) override;
     void drawSelect(QOpenGLShaderProgram* program = nullptr) override;
     void serializeJson(QJsonObject& obj) override;
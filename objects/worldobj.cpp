@@ -63,121 +63,146 @@ CWorldObj::CWorldObj(QJsonObject data):
 uint CWorldObj::deserialize(util::CMobParser& parser)
 {
     uint readByte(0);
-    while(true)
+    bool bNextTag(true);
+    while(bNextTag)
     {
-        if(parser.isNextTag("NID"))
+        switch (parser.peekTag()) {
+        case util::eTagNid:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_mapID);
+            break;
         }
-        else if(parser.isNextTag("OBJ_TYPE"))
+        case util::eTagObjType:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_type);
+            break;
         }
-        else if(parser.isNextTag("OBJ_NAME"))
+        case util::eTagObjName:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_name, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("OBJ_INDEX"))
+        case util::eTagObjIndex:
         {
             Q_ASSERT("OBJ_INDEX" && false);
             readByte += parser.skipTag();//, eNull};
+            break;
         }
-
-        else if(parser.isNextTag("OBJ_TEMPLATE"))
+        case util::eTagObjTemplate:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_modelName, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("OBJ_PRIM_TXTR"))
+        case util::eTagObjPrimTxtr:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_primaryTexture, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("OBJ_SEC_TXTR")){
+        case util::eTagObjSecTxtr:
+        {
             readByte += parser.readHeader();
             readByte += parser.readString(m_secondaryTexture, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("OBJ_POSITION"))
+        case util::eTagObjPosition:
         {
             readByte += parser.skipHeader();
             QVector3D pos;
             readByte += parser.readPlot(pos);
             setPos(pos);
+            break;
         }
-        else if(parser.isNextTag("OBJ_ROTATION"))
+        case util::eTagObjRotation:
         {
             readByte += parser.skipHeader();
             QVector4D rot;
             readByte += parser.readQuaternion(rot);
             CNode::setRot(rot);
+            break;
         }
-        else if(parser.isNextTag("OBJ_TEXTURE"))
+        case util::eTagObjTexture:
         {
             Q_ASSERT("OBJ_TEDXTURE" && false);
             readByte += parser.skipTag();//, eNull};
+            break;
         }
-        else if(parser.isNextTag("OBJ_COMPLECTION"))
+        case util::eTagObjComplection:
         {
             readByte += parser.skipHeader();
             readByte += parser.readPlot(m_complection);
+            break;
         }
-        else if(parser.isNextTag("OBJ_BODYPARTS"))
+        case util::eTagObjBodyparts:
         {
             readByte += parser.skipHeader();
             readByte += parser.readStringArray(m_bodyParts);
+            break;
         }
-        else if(parser.isNextTag("PARENT_TEMPLATE"))
+        case util::eTagParentTemplate:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_parentTemplate, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("OBJ_COMMENTS"))
+        case util::eTagObjComments:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_comment, parser.nodeLen());
+            break;
         }
-        else if(parser.isNextTag("OBJ_DEF_LOGIC"))
+        case util::eTagObjDefLogic:
         {
             Q_ASSERT("OBJ_DEF_LOGIC" && false);
             readByte += parser.skipTag();//, eNull};
+            break;
         }
-        else if(parser.isNextTag("OBJ_PLAYER"))
+        case util::eTagObjPlayer:
         {
             readByte += parser.skipHeader();
             readByte += parser.readByte(m_player);
+            break;
         }
-        else if(parser.isNextTag("OBJ_PARENT_ID"))
+        case util::eTagObjParentId:
         {
             readByte += parser.skipHeader();
             readByte += parser.readDword(m_parentID);
+            break;
         }
-        else if(parser.isNextTag("OBJ_USE_IN_SCRIPT"))
+        case util::eTagObjUseInScript:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bUseInScript);
+            break;
         }
-        else if(parser.isNextTag("OBJ_IS_SHADOW"))
+        case util::eTagObjIsShadow:
         {
             readByte += parser.skipHeader();
             readByte += parser.readBool(m_bShadow);
+            break;
         }
-        else if(parser.isNextTag("OBJ_R"))
+        case util::eTagObjR:
         {
             Q_ASSERT("OBJ_R" && false);
             readByte += parser.skipTag();//, eNull};
+            break;
         }
-        else if(parser.isNextTag("OBJ_QUEST_INFO"))
+        case util::eTagObjQuestInfo:
         {
             readByte += parser.readHeader();
             readByte += parser.readString(m_questInfo, parser.nodeLen());
+            break;
         }
-        else
+        default:
         {
+            bNextTag = false;
             break;
         }
+        }
     }
     return readByte;
 }
@@ -479,6 +504,7 @@ void CWorldObj::getParam(QSharedPointer<IPropertyBase>& prop, EObjParam propType
 
 void CWorldObj::applyParam(const QSharedPointer<IPropertyBase>& prop)
 {
+    setModified();
     switch (prop->type())
     {
     case eObjParam_BODYPARTS:
@@ -1046,9 +1046,11 @@ CTileBrush::CTileBrush(CView* pView)
     :CState(pView)
     ,m_bDrawWater(true)
     ,m_bDrawLand(true)
+    ,m_bArea(false)
+    ,m_areaShape(eTileAreaRect)
 {
     qDebug()<< "CTileBrush init ";
-    CStatusConnector::getInstance()->updateStatus("brush.ico", "Esc - Cancel, LMB - draw selected tile. RMB - pick tile under cursor, Wheel - rotate tile, M/J - draw land/water");
+    CStatusConnector::getInstance()->updateStatus("brush.ico", "Esc - Cancel, LMB - draw selected tile. RMB - pick tile under cursor, Wheel - rotate tile, M/J - draw land/water, Shift+LMB drag - fill rectangle, Ctrl+LMB drag - fill circle, Alt+LMB - flood fill");
     CButtonConnector::getInstance()->pressButton(EButtonOpTilebrush);
     m_pView->setDrawLand(m_bDrawLand);
     m_pView->setDrawWater(m_bDrawWater);
@@ -1117,7 +1119,6 @@ void CTileBrush::keyRelease(COperation* pOp, EKeyCode key)
 
 void CTileBrush::mousePressEvent(COperation* pOp, QMouseEvent* pEvent)
 {
-    Q_UNUSED(pOp);
     m_lastPos = pEvent->pos();
     bool bLand = CScene::getInstance()->isLandTileEditMode();
     m_lastLandPos = m_pView->getTerrainPos(pEvent->x(), pEvent->y(), bLand);
@@ -1126,7 +1127,19 @@ void CTileBrush::mousePressEvent(COperation* pOp, QMouseEvent* pEvent)
     switch (pEvent->buttons()) {
     case Qt::LeftButton:
     {
-        m_pView->setTile(m_pView->getTerrainPos(pEvent->pos().x(), pEvent->pos().y(), bLand), bLand);
+        const QVector3D landPos = m_pView->getTerrainPos(pEvent->pos().x(), pEvent->pos().y(), bLand);
+        if(pOp->keyManager()->isPressed(eKey_Alt))
+        {
+            m_pView->fillTileArea(eTileAreaFlood, landPos, landPos, bLand);
+        }
+        else if(pOp->keyManager()->isPressed(eKey_Shift) || pOp->keyManager()->isPressed(eKey_Ctrl))
+        { // area is filled on release
+            m_bArea = true;
+            m_areaShape = pOp->keyManager()->isPressed(eKey_Shift) ? eTileAreaRect : eTileAreaCircle;
+            m_areaStart = landPos;
+        }
+        else
+            m_pView->setTile(landPos, bLand);
         break;
     }
     case Qt::RightButton:
@@ -1142,6 +1155,12 @@ void CTileBrush::mouseReleaseEvent(COperation* pOp, QMouseEvent* pEvent)
     Q_UNUSED(pOp);
     Q_UNUSED(pEvent);
     if (pEvent->button() == Qt::LeftButton) {
+        if(m_bArea)
+        {
+            bool bLand = CScene::getInstance()->isLandTileEditMode();
+            m_pView->fillTileArea(m_areaShape, m_areaStart, m_pView->getTerrainPos(pEvent->pos().x(), pEvent->pos().y(), bLand), bLand);
+            m_bArea = false;
+        }
         m_pView->endTileBrushGroup();
     }
     if(!m_pView->isPreviewTile()) // if we finished brushing, we will come here
@@ -1166,6 +1185,10 @@ void CTileBrush::mouseMoveEvent(COperation* pOp, QMouseEvent* pEvent)
         rotateAroundPivot(pOp->camera(), dx, dy, senseX, senseY);
         m_lastPos = pEvent->pos();
     }
+    else if ((pEvent->buttons() & Qt::LeftButton) && m_bArea)
+    {
+        // nothing to brush while area is dragged
+    }
     else if (pEvent->buttons() & Qt::LeftButton)
     {
         if(m_pView->isPreviewTile())
@@ -182,6 +182,9 @@ private:
     QVector3D m_lastLandPos;
     bool m_bDrawWater;
     bool m_bDrawLand;
+    bool m_bArea; // rectangle or circle is being dragged
+    ETileAreaShape m_areaShape;
+    QVector3D m_areaStart;
 };
 
 #endif // COPERATIONMANAGER_H
@@ -18,6 +18,7 @@ public:
     QString& name() {return m_name; }
     void setName(QString& name) {m_name = name; }
     void setVisible(bool bShow = true) {m_bShow = bShow;}
+    bool isVisible() {return m_bShow;}
     void update(); //update shader buffers
     void draw(QOpenGLShaderProgram* program);
     void drawSelect(QOpenGLShaderProgram* program);
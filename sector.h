@@ -5,30 +5,11 @@
 #include <QVector>
 #include <QFile>
 #include <QDataStream>
-#include <QOpenGLBuffer>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include "types.h"
 #include "tile.h"
-
-
-struct SSpecificQuad //todo: delete
-{
-    void addVertex(SVertexData* vertex) {m_aVertexPointer.append(vertex);}
-    void rotate(int step = 0);
-    int m_rotateState;
-    QVector<SVertexData*> m_aVertexPointer;
-};
-
-struct STile //todo: delete
-{
-    STile(){}
-    STile(ushort packedData);
-    ushort packData(ushort m_index, ushort m_texture, ushort m_rotation);
-    ushort m_index;
-    ushort m_texture;
-    ushort m_rotation;
-};
+#include "height_tree.h"
 
 
 ///
@@ -40,42 +21,41 @@ public:
     CSector();
     CSector(QDataStream& stream, float maxZ, int texCount);
     ~CSector();
-    QByteArray serializeSector();
-    void draw(QOpenGLShaderProgram* program);
-    void drawWater(QOpenGLShaderProgram* program);
-    void setIndex(UI2& index) {m_index = index; updatePosition(); }
-    const UI2& index() {return m_index;}
-    bool projectPt(QVector3D& origin);
+    QByteArray serializeSector() const;
+    void setIndex(UI2& index) {m_index = index;}
+    const UI2& index() const {return m_index;}
+    bool projectPt(QVector3D& point) const;
+    bool intersectRay(float& t, int& row, int& col, const QVector3D& origin, const QVector3D& dir, bool bLand = true) const;
     bool pickTile(int& row, int& col, QVector3D& point, bool bLand = true);
     void setTile(QVector3D& point, int index, int rotNum, bool bLand = true, int matIndex = 0);
     //void setTile(const STileLocation tileLoc, const STileInfo tileInfo);
     void setTile(const QMap<STileLocation, STileInfo>& arrTileInfo);
+    void setTiles(int row, int col, int count, const STileInfo* arrInfo, bool bLand = true);
     const QVector<QVector<CTile>>& arrTile() const {return m_arrLand;};
     QVector<QVector<CTile>>& arrTileEdit() {return m_arrLand;};
     const QVector<QVector<CTile>>& arrWater() const {return m_arrWater;};
     QVector<QVector<CTile>>& arrWaterEdit() {return m_arrWater;};
     bool existsTileIndices(const QVector<int>& arrInd); // function for find incorrect\coorrupt tile indices
     void updateDrawData();
+    bool hasWater() const {return !m_arrWater.isEmpty();}
+    static int drawVertexCount();
+    static int drawIndexCount(int lod = 0);
+    static void generateIndexData(QVector<uint>& aInd, uint baseVertex, int lod = 0);
 
 private:
-    void updatePosition();
-    void makeVertexData(QVector<QVector<SSecVertex>>& aLandVertex, QVector<STile>& aLandTile, QVector<QVector<SSecVertex>>& aWaterVertex, QVector<STile>& aWaterTile, float maxZ, int texCount);
-    void generateVertexDataFromTile();
+    void collectSecData(SSecData& data) const;
+    void updateHeightTree();
+    bool cellHeight(float& z, float x, float y, int cellX, int cellY) const;
 
 
 private:
     UI2 m_index;
-    QMatrix4x4 m_modelMatrix;
 
     QVector<QVector<CTile>> m_arrLand;
-    QVector<SVertexData> m_arrLandVrtData;
-    QOpenGLBuffer m_vertexBuf;
-    QOpenGLBuffer m_indexBuf;
+    CHeightTree m_landTree;
 
     QVector<QVector<CTile>> m_arrWater;
-    QVector<SVertexData> m_arrWaterVrtData;
-    QOpenGLBuffer m_waterVertexBuf;
-    QOpenGLBuffer m_waterIndexBuf;
+    CHeightTree m_waterTree;
 };
 
 #endif // MAP_SEC_H
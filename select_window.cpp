@@ -48,12 +48,11 @@ void CSelectForm::init()
     m_loc["Model name"] = {eSelectType_Model_name, "Model name", "", false};
     //m_loc["Mob file"] = {eSelectType_Mob_file, "Mob name", ""};
     m_loc["Diplomacy group"] = {eSelectType_Diplomacy_group, "Start group number", "End group number", true};
-    //TODO
-    //m_loc["Position (circle)"] = {eSelectType_Position_circle, "Center point", "Radius"};
-    //m_loc["Position (rectangle)"] = {eSelectType_Position_rectangle, "Left down corner", "Right up corner"};
+    m_loc["Position (circle)"] = {eSelectType_Position_circle, "Center point (x y)", "Radius", true};
+    m_loc["Position (rectangle)"] = {eSelectType_Position_rectangle, "Left down corner (x y)", "Right up corner (x y)", true};
     m_loc["Database name"] = {eSelectType_Database_name, "Database name", "", false};
     m_loc["Template"] = {eSelectType_Template, "Template", "", false};
-    //m_loc["Object type"] = {eSelectType_ObjectType, "Object type", ""};
+    m_loc["Object type"] = {eSelectType_ObjectType, "Object type (Unit, Lever, ...)", "", false};
 
     for (const auto& pair : m_loc.toStdMap())
         ui->combo_SelType->addItem(pair.first);
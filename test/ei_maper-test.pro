@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Standalone test of mob map ID index, see test/main.cpp
+#
+#-------------------------------------------------
+
+# CMapIdIndex is built against stub node.h of this folder (it goes first in INCLUDEPATH), so no GL context, game resources or mob are needed
+QT       += core
+
+TARGET = ei_maper-test
+TEMPLATE = app
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += . ..
+
+SOURCES += \
+    main.cpp \
+    ../mob/map_id_index.cpp \
+    ../mob/id_allocator.cpp
+
+HEADERS += \
+    node.h \
+    ../mob/map_id_index.h \
+    ../mob/id_allocator.h
@@ -0,0 +1,208 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "node.h"
+#include "mob/map_id_index.h"
+
+///
+/// \brief The CMobNodes class is node list of mob with map ID index. Nodes are added, deleted, restored and removed the same way as CMob does it
+///
+class CMobNodes
+{
+public:
+    CMobNodes() {}
+    ~CMobNodes() {qDeleteAll(m_aNode); qDeleteAll(m_aDeletedNode);}
+    QList<CNode*>& nodes() {return m_aNode;}
+    CMapIdIndex& index() {return m_index;}
+
+    void addNode(CNode* pNode)
+    {
+        m_aNode.append(pNode);
+        m_index.insert(pNode);
+    }
+
+    // see CMob::freeMapIds, IDs are taken from a copy of allocator. Returns less IDs if range is full
+    QVector<uint> freeMapIds(int count, uint minId, uint maxId)
+    {
+        QVector<uint> arrId;
+        CIdAllocator allocator(m_index.allocator());
+        for(int i(0); i<count; ++i)
+        {
+            const uint id = allocator.firstFree(minId, maxId);
+            if(id == 0)
+                break;
+
+            allocator.take(id);
+            arrId.append(id);
+        }
+        return arrId;
+    }
+
+    // see CMob::deleteNode, node found by ID is deleted, it can be other one than pNode for duplicated IDs
+    void deleteNode(uint mapId)
+    {
+        CNode* pNode = m_index.nodeById(mapId);
+        if(nullptr == pNode)
+            return;
+
+        m_aDeletedNode.append(pNode);
+        m_aNode.removeOne(pNode);
+        m_index.remove(pNode, mapId);
+    }
+
+    // see CMob::undo_deleteNode
+    void undo_deleteNode(uint mapId)
+    {
+        for(int i(m_aDeletedNode.size()-1); i>=0; --i)
+            if(m_aDeletedNode[i]->mapId() == mapId)
+            {
+                addNode(m_aDeletedNode.takeAt(i));
+                return;
+            }
+    }
+
+    // see CMob::undo_createNodes, all nodes with the ID are removed. Returns removed nodes, they are deleted by caller
+    QList<CNode*> undo_createNode(uint mapId)
+    {
+        QList<CNode*> arrRemoved;
+        for(int i(m_aNode.size()-1); i>=0; --i)
+            if(m_aNode[i]->mapId() == mapId)
+            {
+                m_index.remove(m_aNode[i], mapId);
+                arrRemoved.append(m_aNode.takeAt(i));
+            }
+        return arrRemoved;
+    }
+
+    void changeMapId(CNode* pNode, uint id)
+    {
+        const uint oldId = pNode->mapId();
+        pNode->setMapId(id);
+        m_index.reindex(pNode, oldId);
+    }
+
+private:
+    QList<CNode*> m_aNode;
+    QList<CNode*> m_aDeletedNode;
+    CMapIdIndex m_index;
+};
+
+// Random add, paste, delete, undo and ID change steps. After every step the index is compared with linear scan of node list:
+// nodeById must return one of nodes with the ID, isFree must be true only for IDs without nodes.
+// IDs are taken from small interval, so duplicates appear often
+static bool runSteps(int nStep, quint32 seed, uint maxId, QTextStream& out)
+{
+    QRandomGenerator random(seed);
+    CMobNodes mob;
+    QList<CNode*> arrCreated; // nodes of paste steps, in order of creation
+    QList<uint> arrDeletedId;
+
+    auto randomNode = [&mob, &random]() -> CNode*
+    {
+        return mob.nodes().isEmpty() ? nullptr : mob.nodes()[random.bounded(mob.nodes().size())];
+    };
+
+    for(int step(0); step < nStep; ++step)
+    {
+        switch (random.bounded(6)) {
+        case 0:
+        { // node read from file, ID can be duplicated
+            mob.addNode(new CNode(1 + random.bounded(maxId)));
+            break;
+        }
+        case 1:
+        { // pasted nodes get free IDs at once
+            const QVector<uint> arrId = mob.freeMapIds(1 + random.bounded(3), 1, maxId + 1);
+            for(auto& id : arrId)
+            {
+                CNode* pNode = new CNode(id);
+                mob.addNode(pNode);
+                arrCreated.append(pNode);
+            }
+            break;
+        }
+        case 2:
+        {
+            CNode* pNode = randomNode();
+            if(pNode)
+            {
+                arrDeletedId.append(pNode->mapId());
+                mob.deleteNode(pNode->mapId());
+            }
+            break;
+        }
+        case 3:
+        {
+            if(!arrDeletedId.isEmpty())
+                mob.undo_deleteNode(arrDeletedId.takeLast());
+            break;
+        }
+        case 4:
+        { // undo of paste removes the last created node and other nodes with its ID
+            if(arrCreated.isEmpty())
+                break;
+
+            const QList<CNode*> arrRemoved = mob.undo_createNode(arrCreated.last()->mapId());
+            for(auto& pNode : arrRemoved)
+                arrCreated.removeOne(pNode);
+            qDeleteAll(arrRemoved);
+            break;
+        }
+        case 5:
+        {
+            CNode* pNode = randomNode();
+            if(pNode)
+                mob.changeMapId(pNode, 1 + random.bounded(maxId));
+            break;
+        }
+        }
+        for(int i(arrCreated.size()-1); i>=0; --i)
+            if(!mob.nodes().contains(arrCreated[i])) // deleted, it can be restored by undo
+                arrCreated.removeAt(i);
+
+        bool bOk = mob.index().isValid(mob.nodes());
+        for(uint id(1); id <= maxId + 1 && bOk; ++id)
+        {
+            QList<CNode*> arrNode;
+            for(auto& pNode : mob.nodes())
+                if(pNode->mapId() == id)
+                    arrNode.append(pNode);
+
+            CNode* pFound = mob.index().nodeById(id);
+            bOk = arrNode.isEmpty() ? pFound == nullptr : arrNode.contains(pFound);
+            bOk = bOk && mob.index().isFree(id) == arrNode.isEmpty();
+        }
+        if(!bOk)
+        {
+            out << QString("map ID index differs from node list at step %1 (seed %2)").arg(step).arg(seed) << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns 0 if map ID index is the same as linear scan of nodes after every step
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ei_maper-test");
+
+    QCommandLineParser cmd;
+    cmd.setApplicationDescription("Test of mob map ID index against linear scan of nodes");
+    cmd.addHelpOption();
+    QCommandLineOption stepOption("steps", "count of random steps, 10000 by default", "count");
+    QCommandLineOption seedOption("seed", "seed of random steps, 1 by default", "number");
+    cmd.addOption(stepOption);
+    cmd.addOption(seedOption);
+    cmd.process(app);
+
+    const int nStep = cmd.isSet(stepOption) ? cmd.value(stepOption).toInt() : 10000;
+    const quint32 seed = cmd.isSet(seedOption) ? cmd.value(seedOption).toUInt() : 1;
+
+    QTextStream out(stdout);
+    const bool bOk = runSteps(nStep, seed, 64, out);
+    out << (bOk ? "map ID index: ok" : "map ID index: failed") << endl;
+    return bOk ? 0 : 1;
+}
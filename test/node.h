@@ -0,0 +1,22 @@
+#ifndef NODE_H
+#define NODE_H
+
+#include <QtGlobal>
+
+// Stub of editor node for ei_maper-test. It has only what CMapIdIndex reads, editor node.h needs GL and game resources
+
+///
+/// \brief The CNode class is node with map ID only
+///
+class CNode
+{
+public:
+    CNode(uint id): m_mapID(id) {}
+    const uint& mapId() {return m_mapID;}
+    void setMapId(uint id) {m_mapID = id;}
+
+private:
+    uint m_mapID;
+};
+
+#endif // NODE_H
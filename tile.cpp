@@ -116,11 +116,7 @@ void CTile::generateDrawVertexData(QVector<SVertexData>& outData, int& curIndex)
             outData[curIndex].position.setY(m_y + row + vrt.yOffset/254.0f);
             outData[curIndex].position.setZ(vrt.z * m_maxZ/65535.0f);
             outData[curIndex].normal = vrt.normal;
-            QVector2D test1;
-            calcTexCoord(test1, row, col);
             auto indN = getNewIndex(row, col, m_rotNum);
-            QVector2D test2;
-            calcTexCoord(test2, indN.first, indN.second);
             calcTexCoord(outData[curIndex].texCoord, indN.first, indN.second);
             ++curIndex;
         }
@@ -131,11 +127,11 @@ bool CTile::isProjectPoint(QVector3D& outPoint)
 {
     float u,v,t;
     QVector3D dir(0.0f, 0.0f, 1.0f);
-    QVector<int> arrTriangleId = {0, 1, 3, 3, 1, 4, 1, 2, 4, 4, 2, 5, 3, 4, 6, 6, 4, 7, 4, 5, 7, 7, 5, 8};
+    static const int arrTriangleId[24] = {0, 1, 3, 3, 1, 4, 1, 2, 4, 4, 2, 5, 3, 4, 6, 6, 4, 7, 4, 5, 7, 7, 5, 8};
     QVector3D pt1;
     QVector3D pt2;
     QVector3D pt3;
-    for(int i(0); i<arrTriangleId.size(); i+=3)
+    for(int i(0); i<24; i+=3)
     {
         pt1 = pos(arrTriangleId[(i+0)]/3, arrTriangleId[(i+0)]%3);
         pt2 = pos(arrTriangleId[(i+1)]/3, arrTriangleId[(i+1)]%3);
@@ -184,7 +180,7 @@ void CTile::setTile(int index, int rotNum)
     m_rotNum = rotNum;
 }
 
-ushort CTile::packData()
+ushort CTile::packData() const
 {
     return (m_index & 63) | ((m_atlasTexIndex & 255) << 6) | ((m_rotNum & 3) << 14);
 }
@@ -200,7 +196,7 @@ void CTile::reset()
         m_arrVertex[i].resize(3);
 }
 
-QVector3D CTile::pos(int row, int col)
+QVector3D CTile::pos(int row, int col) const
 {
     const SSecVertex& vrt = m_arrVertex[row][col];
     QVector3D pos;
@@ -242,7 +238,7 @@ void CPreviewTile::updateTile(const CTile& tile, int tIndex, int rotation, int m
     m_vertexBuf.allocate(m_arrLandVrtData.data(), m_arrLandVrtData.count()*int(sizeof(SVertexData)));
     m_vertexBuf.release();
 
-    QVector<ushort> arrTileInd{0,1,4,3, 1,2,5,4, 3,4,7,6, 4,5,8,7}; // indices of quad vertices
+    QVector<ushort> arrTileInd{0, 1, 3, 3, 1, 4, 1, 2, 4, 4, 2, 5, 3, 4, 6, 6, 4, 7, 4, 5, 7, 7, 5, 8}; // triangles of tile, the same as for sectors
     m_indexBuf.bind();
     m_indexBuf.allocate(arrTileInd.data(), arrTileInd.size() * sizeof(ushort));
     m_indexBuf.release();
@@ -271,5 +267,5 @@ void CPreviewTile::draw(QOpenGLShaderProgram* program)
     program->enableAttributeArray(textureLocation);
     program->setAttributeBuffer(textureLocation, GL_FLOAT, offset, 2, int(sizeof(SVertexData)));
     m_indexBuf.bind();
-    glDrawElements(GL_QUADS, 16, GL_UNSIGNED_SHORT, nullptr); // 16 indices for tile
+    glDrawElements(GL_TRIANGLES, 24, GL_UNSIGNED_SHORT, nullptr); // 8 triangles for tile
 }
@@ -5,35 +5,7 @@
 #include <QOpenGLShaderProgram>
 #include <QVector3D>
 #include "types.h"
-
-struct SSecVertex
-{
-    qint8  xOffset;
-    qint8  yOffset;
-    ushort z;
-    uint32_t packedNormal; // temp var to unpack normal
-    QVector3D normal;
-
-    friend QDataStream& operator>> (QDataStream& st, SSecVertex& vert)
-    {
-        st >> vert.xOffset >> vert.yOffset >> vert.z >> vert.packedNormal;
-        vert.normal.setX((((vert.packedNormal >> 11) & 0x7FF) - 1000.0f) / 1000.0f);
-        vert.normal.setY(((vert.packedNormal & 0x7FF) - 1000.0f) / 1000.0f);
-        vert.normal.setZ((vert.packedNormal >> 22) / 1000.0f);
-        return st;
-    }
-
-    friend QDataStream& operator<< (QDataStream& st, SSecVertex& vert)
-    {
-        uint32_t packedX = qBound(0, int((vert.normal.x() * 1000.0f) + 1000.0f), 2047) & 0x7FF;
-        uint32_t packedY = qBound(0, int((vert.normal.y() * 1000.0f) + 1000.0f), 2047) & 0x7FF;
-        uint32_t packedZ = qBound(0, int( vert.normal.z() * 1000.0f), 1023) & 0x3FF;
-
-        // Упаковываем компоненты в одно 32-битное число
-        vert.packedNormal = (packedZ << 22) | (packedX << 11) | packedY;
-        return st << vert.xOffset << vert.yOffset << vert.z << vert.packedNormal;
-    }
-};
+#include "mpr_data.h"
 
 // nine vertices of tile
 /*
@@ -58,13 +30,13 @@ public:
     virtual int tileIndex() const;
     ushort tileRotation() const {return m_rotNum;}
     void setTile(int index, int rotNum);
-    const QVector<QVector<SSecVertex>>& arrVertex(){return m_arrVertex;}
+    const QVector<QVector<SSecVertex>>& arrVertex() const {return m_arrVertex;}
     void setMaterialIndex(short matIndex) {m_materialIndex = matIndex;}
     short materialIndex() const {return m_materialIndex;}
-    ushort packData();
+    ushort packData() const;
+    QVector3D pos(int row, int col) const;
 protected:
     void reset();
-    QVector3D pos(int row, int col);
 protected:
     QVector<QVector<SSecVertex>> m_arrVertex; // matrix 3x3 of x,y offsets, z-altitude and normal
     ushort m_x; // start X (left pos to right). max X tile is 2.0f + m_x for third vertex (m_x + 0.0f, m_x + 1.0f, m_x + 2.0f1)
@@ -0,0 +1,99 @@
+#include <QBitArray>
+#include <cmath>
+
+#include "tile_area.h"
+
+CTileArea::CTileArea(const QSize& mapSize):
+    m_mapSize(mapSize)
+{
+}
+
+void CTileArea::addSpan(int y, int x0, int x1)
+{
+    if(y < 0 || y >= m_mapSize.height())
+        return;
+
+    x0 = qMax(x0, 0);
+    x1 = qMin(x1, m_mapSize.width()-1);
+    if(x0 > x1)
+        return;
+
+    m_arrSpan.append(STileSpan{y, x0, x1});
+}
+
+int CTileArea::tileCount() const
+{
+    int count(0);
+    for(const auto& span: m_arrSpan)
+        count += span.x1 - span.x0 + 1;
+    return count;
+}
+
+void CTileArea::rect(const QPoint& corner1, const QPoint& corner2)
+{
+    const int x0 = qMin(corner1.x(), corner2.x());
+    const int x1 = qMax(corner1.x(), corner2.x());
+    const int y0 = qMin(corner1.y(), corner2.y());
+    const int y1 = qMax(corner1.y(), corner2.y());
+    for(int y(y0); y<=y1; ++y)
+        addSpan(y, x0, x1);
+}
+
+void CTileArea::circle(const QPoint& center, int radius)
+{
+    radius = qMax(radius, 0);
+    for(int dy(-radius); dy<=radius; ++dy)
+    {
+        const int halfWidth = int(std::floor(std::sqrt(float(radius*radius - dy*dy))));
+        addSpan(center.y() + dy, center.x() - halfWidth, center.x() + halfWidth);
+    }
+}
+
+// Scanline fill: each popped seed is expanded to the whole matching run of its row, then runs of neighbour rows are seeded once per run
+void CTileArea::floodFill(const QPoint& start, const std::function<bool(int x, int y)>& isMatch)
+{
+    const int width = m_mapSize.width();
+    const int height = m_mapSize.height();
+    if(start.x() < 0 || start.y() < 0 || start.x() >= width || start.y() >= height)
+        return;
+
+    QBitArray arrVisited(width*height);
+    auto isFree = [&arrVisited, &isMatch, width](int x, int y)
+    {
+        return !arrVisited.testBit(y*width + x) && isMatch(x, y);
+    };
+
+    QVector<QPoint> arrSeed;
+    arrSeed.append(start);
+    while(!arrSeed.isEmpty())
+    {
+        const QPoint seed = arrSeed.takeLast();
+        const int y = seed.y();
+        if(!isFree(seed.x(), y))
+            continue;
+
+        int x0(seed.x()), x1(seed.x());
+        while(x0 > 0 && isFree(x0-1, y))
+            --x0;
+        while(x1 < width-1 && isFree(x1+1, y))
+            ++x1;
+
+        arrVisited.fill(true, y*width + x0, y*width + x1 + 1);
+        m_arrSpan.append(STileSpan{y, x0, x1});
+
+        for(int yNext(y-1); yNext<=y+1; yNext+=2)
+        {
+            if(yNext < 0 || yNext >= height)
+                continue;
+
+            bool bInRun = false;
+            for(int x(x0); x<=x1; ++x)
+            {
+                const bool bFree = isFree(x, yNext);
+                if(bFree && !bInRun)
+                    arrSeed.append(QPoint(x, yNext));
+                bInRun = bFree;
+            }
+        }
+    }
+}
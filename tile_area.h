@@ -0,0 +1,32 @@
+#ifndef TILE_AREA_H
+#define TILE_AREA_H
+
+#include <QVector>
+#include <QPoint>
+#include <QSize>
+#include <functional>
+#include "types.h"
+
+///
+/// \brief The CTileArea class calculates tiles covered by area brush (rectangle, circle, flood fill) as row spans clipped by map size, so big regions are processed without per tile events
+///
+class CTileArea
+{
+public:
+    CTileArea(const QSize& mapSize);
+    void rect(const QPoint& corner1, const QPoint& corner2);
+    void circle(const QPoint& center, int radius);
+    void floodFill(const QPoint& start, const std::function<bool(int x, int y)>& isMatch);
+    const QVector<STileSpan>& spans() const {return m_arrSpan;}
+    bool isEmpty() const {return m_arrSpan.isEmpty();}
+    int tileCount() const;
+
+private:
+    void addSpan(int y, int x0, int x1);
+
+private:
+    QSize m_mapSize; // tiles number by X and Y
+    QVector<STileSpan> m_arrSpan;
+};
+
+#endif // TILE_AREA_H
@@ -47,6 +47,13 @@ enum ETileEditMode
     ,eTileEditModeWater
 };
 
+enum ETileAreaShape
+{
+    eTileAreaRect = 0
+    ,eTileAreaCircle
+    ,eTileAreaFlood
+};
+
 enum EOperationType
 {
     EOperationTypeObjects = 1
@@ -330,6 +337,8 @@ public:
     QVector3D center();
     float radius();
     bool isInit() {return m_bInit;}
+    const QVector3D& minPos() const {return m_minPos;}
+    const QVector3D& maxPos() const {return m_maxPos;}
 
 private:
     bool m_bInit;
@@ -385,6 +394,13 @@ struct STileLocation
     }
 };
 
+struct STileSpan // horizontal run of tiles in one row of map, tile coords
+{
+    int y;
+    int x0; // first tile
+    int x1; // last tile (inclusive)
+};
+
 template <class T> class TValue {
 public:
     TValue(){m_bInit = false;}
@@ -8,6 +8,7 @@
 #include "settings.h"
 #include "log.h"
 #include "property.h"
+#include "landscape.h"
 
 
 COpenCommand::COpenCommand(CView* pView, QFileInfo& path, QUndoCommand *parent) : QUndoCommand(parent)
@@ -95,7 +96,7 @@ void CDeleteNodeCommand::redo()
     m_pView->setDurty();
 }
 
-CCreateNodeCommand::CCreateNodeCommand(CView* pView, QJsonObject nodeData, QUndoCommand *parent):
+CCreateNodeCommand::CCreateNodeCommand(CView* pView, const QByteArray& nodeData, QUndoCommand *parent):
     QUndoCommand(parent)
     ,m_pView(pView)
     ,m_nodeData(nodeData)
@@ -113,49 +114,58 @@ void CCreateNodeCommand::undo()
 
 void CCreateNodeCommand::redo()
 {
-    auto pNode = m_pView->currentMob()->createNode(m_nodeData);
+    const QList<CNode*> arrNode = m_pView->currentMob()->createNodes(m_nodeData);
+    Q_ASSERT(arrNode.size() == 1);
+    CNode* pNode = arrNode.first();
     m_createdNodeId = pNode->mapId();
     setText("Node created ID: " + QString::number(pNode->mapId()));
     m_pView->setDurty();
     emit addNodeSignal(pNode);
 }
 
-CChangeLogicParam::CChangeLogicParam(CView* pView, QString pointHash, const QSharedPointer<IPropertyBase>& prop, QUndoCommand *parent):
+CPasteNodesCommand::CPasteNodesCommand(CView* pView, const QByteArray& nodeData, QUndoCommand *parent):
+    QUndoCommand(parent)
+    ,m_pView(pView)
+    ,m_nodeData(nodeData)
+{
+}
+
+void CPasteNodesCommand::undo()
+{
+    m_pView->currentMob()->undo_createNodes(m_arrCreatedNodeId);
+    m_pView->setDurty();
+    for(auto& id : m_arrCreatedNodeId)
+        emit undo_addNodeSignal(id);
+}
+
+void CPasteNodesCommand::redo()
+{
+    const QList<CNode*> arrNode = m_pView->currentMob()->createNodes(m_nodeData);
+    m_arrCreatedNodeId.clear();
+    for(auto& pNode : arrNode)
+    {
+        m_arrCreatedNodeId.append(pNode->mapId());
+        emit addNodeSignal(pNode);
+    }
+    setText("Nodes pasted: " + QString::number(arrNode.size()));
+    m_pView->setDurty();
+}
+
+CChangeLogicParam::CChangeLogicParam(CView* pView, const SLogicHandle& handle, const QSharedPointer<IPropertyBase>& prop, QUndoCommand *parent):
     QUndoCommand(parent)
   ,m_pView(pView)
-  ,m_pointHash(pointHash)
+  ,m_handle(handle)
 {
     m_newValue.reset(prop->clone());
 }
 
 void CChangeLogicParam::undo()
 {
-    QStringList list = m_pointHash.split(".");
-    if(list.size()==1)
-    {//unit
-        auto pUnit = m_pView->currentMob()->nodeByMapId(list[0].toUInt());
-        pUnit->applyLogicParam(m_oldValue);
-    }
-    else if(list.size()==2)
-    {//patrol point
-        CPatrolPoint* pPoint = m_pView->currentMob()->patrolPointById(list[0].toInt(), list[1].toInt());
-        pPoint->applyLogicParam(m_oldValue);
-    }
-    else if(list.size()==3)
-    {//look point
-        CLookPoint* pPoint = m_pView->currentMob()->viewPointById(list[0].toInt(), list[1].toInt(), list[2].toInt());
-        pPoint->applyLogicParam(m_oldValue);
-    }
-    else if(list.size() == 4) //trap zone
-    {
-        CActivationZone* pZone = m_pView->currentMob()->actZoneById(list[0].toInt(), list[3].toInt());
-        pZone->applyLogicParam(m_oldValue);
-    }
-    else if(list.size() == 5) //trap cast point
-    {
-        CTrapCastPoint* pCast = m_pView->currentMob()->trapCastById(list[0].toInt(), list[4].toInt());
-        pCast->applyLogicParam(m_oldValue);
-    }
+    CNode* pNode = m_pView->currentMob()->nodeByLogicHandle(m_handle); //can be unit, magic trap or their logic point
+    if(!pNode)
+        return;
+
+    pNode->applyLogicParam(m_oldValue);
 
     emit updateParam();
     m_pView->setDurty();
@@ -163,58 +173,33 @@ void CChangeLogicParam::undo()
 
 void CChangeLogicParam::redo()
 {
-    QStringList list = m_pointHash.split(".");
-    if(list.size()==1)
-    {//unit
-        auto pUnit = m_pView->currentMob()->nodeByMapId(list[0].toUInt()); //can be magic trap
-        pUnit->getLogicParam(m_oldValue, m_newValue->type());
-        pUnit->applyLogicParam(m_newValue);
-    }
-    else if(list.size()==2)
-    {//patrol point
-        CPatrolPoint* pPoint = m_pView->currentMob()->patrolPointById(list[0].toInt(), list[1].toInt());
-        pPoint->getLogicParam(m_oldValue, m_newValue->type());
-        pPoint->applyLogicParam(m_newValue);
-    }
-    else if(list.size()==3)
-    {//look point
-        CLookPoint* pPoint = m_pView->currentMob()->viewPointById(list[0].toInt(), list[1].toInt(), list[2].toInt());
-        pPoint->getLogicParam(m_oldValue, m_newValue->type());
-        pPoint->applyLogicParam(m_newValue);
-    }
-    else if(list.size() == 4) //trap zone
-    {
-        CActivationZone* pZone = m_pView->currentMob()->actZoneById(list[0].toInt(), list[3].toInt());
-        pZone->getLogicParam(m_oldValue, m_newValue->type());
-        pZone->applyLogicParam(m_newValue);
-    }
-    else if(list.size() == 5) //trap cast point
-    {
-        CTrapCastPoint* pCast = m_pView->currentMob()->trapCastById(list[0].toInt(), list[4].toInt());
-        pCast->getLogicParam(m_oldValue, m_newValue->type());
-        pCast->applyLogicParam(m_newValue);
-    }
+    CNode* pNode = m_pView->currentMob()->nodeByLogicHandle(m_handle);
+    if(!pNode)
+        return;
+
+    pNode->getLogicParam(m_oldValue, m_newValue->type());
+    pNode->applyLogicParam(m_newValue);
 
     emit updateParam();
     m_pView->setDurty();
     setText("Change value to " + m_newValue->toString());
 }
 
-CCreatePatrolCommand::CCreatePatrolCommand(CView* pView, QString pointHash, QUndoCommand *parent):
+CCreatePatrolCommand::CCreatePatrolCommand(CView* pView, const SLogicHandle& handle, QUndoCommand *parent):
     QUndoCommand(parent)
   ,m_pView(pView)
-  ,m_pointHash(pointHash)
+  ,m_handle(handle)
 {
 }
 
 void CCreatePatrolCommand::undo()
 {
-    m_pView->currentMob()->undo_createPatrolByHash(m_pointHash);
+    m_pView->currentMob()->undo_createPatrolByHandle(m_handle);
 }
 
 void CCreatePatrolCommand::redo()
 {
-    m_pView->currentMob()->createPatrolByHash(m_pointHash);
+    m_pView->currentMob()->createPatrolByHandle(m_handle);
     setText("Created new point");
 }
 
@@ -233,7 +218,7 @@ void CCreateTrapPointCommand::undo()
         pTrap->deleteLastActZone();
     else
         pTrap->deleteLastCastPoint();
-    m_pView->currentMob()->logicNodesUpdate();
+    m_pView->currentMob()->logicNodesUpdate(pTrap);
 }
 
 void CCreateTrapPointCommand::redo()
@@ -249,72 +234,29 @@ void CCreateTrapPointCommand::redo()
         auto pCast = pTrap->createCastPoint();
         pCast->setState(ENodeState::eSelect);
     }
-    m_pView->currentMob()->logicNodesUpdate();
+    m_pView->currentMob()->logicNodesUpdate(pTrap);
 }
 
-CDeleteLogicPoint::CDeleteLogicPoint(CView *pView, QString hash, QUndoCommand *parent):
+CDeleteLogicPoint::CDeleteLogicPoint(CView *pView, const SLogicHandle& handle, QUndoCommand *parent):
     QUndoCommand(parent)
   ,m_pView(pView)
-  ,m_nodeHash(hash)
+  ,m_handle(handle)
 {
+    Q_ASSERT(handle.type != eLogicHandleObject);
 }
 
 void CDeleteLogicPoint::undo()
 {
-    QStringList list = m_nodeHash.split(".");
-    if(list.size()==1)
-    {
-        Q_ASSERT(false);
-    }
-    else if(list.size()==2)
-    {//patrol point
-        CPatrolPoint* pPoint = m_pView->currentMob()->patrolPointById(list[0].toInt(), list[1].toInt());
-        pPoint->markAsDeleted(false);
-    }
-    else if(list.size()==3)
-    {//look point
-        CLookPoint* pPoint = m_pView->currentMob()->viewPointById(list[0].toInt(), list[1].toInt(), list[2].toInt());
-        pPoint->markAsDeleted(false);
-    }
-    else if(list.size() == 4) //trap zone
-    {
-        CActivationZone* pZone = m_pView->currentMob()->actZoneById(list[0].toInt(), list[3].toInt());
-        pZone->markAsDeleted(false);
-    }
-    else if(list.size() == 5) //trap cast point
-    {
-        CTrapCastPoint* pCast = m_pView->currentMob()->trapCastById(list[0].toInt(), list[4].toInt());
-        pCast->markAsDeleted(false);
-    }
+    CNode* pNode = m_pView->currentMob()->nodeByLogicHandle(m_handle);
+    if(pNode)
+        pNode->markAsDeleted(false);
 }
 
 void CDeleteLogicPoint::redo()
 {
-    QStringList list = m_nodeHash.split(".");
-    if(list.size()==1)
-    {
-        Q_ASSERT(false);
-    }
-    else if(list.size()==2)
-    {//patrol point
-        CPatrolPoint* pPoint = m_pView->currentMob()->patrolPointById(list[0].toInt(), list[1].toInt());
-        pPoint->markAsDeleted(true);
-    }
-    else if(list.size()==3)
-    {//look point
-        CLookPoint* pPoint = m_pView->currentMob()->viewPointById(list[0].toInt(), list[1].toInt(), list[2].toInt());
-        pPoint->markAsDeleted(true);
-    }
-    else if(list.size() == 4) //trap zone
-    {
-        CActivationZone* pZone = m_pView->currentMob()->actZoneById(list[0].toInt(), list[3].toInt());
-        pZone->markAsDeleted(true);
-    }
-    else if(list.size() == 5) //trap cast point
-    {
-        CTrapCastPoint* pCast = m_pView->currentMob()->trapCastById(list[0].toInt(), list[4].toInt());
-        pCast->markAsDeleted(true);
-    }
+    CNode* pNode = m_pView->currentMob()->nodeByLogicHandle(m_handle);
+    if(pNode)
+        pNode->markAsDeleted(true);
     setText("Point deleted");
     m_pView->setDurty();
 }
@@ -574,6 +516,7 @@ void CChangeProp::undo()
     pNode->applyParam(m_oldValue);
     if(m_oldValue->type() == eObjParam_NID)
     {
+        m_pView->currentMob()->reindexNode(pNode, m_nodeId);
         m_nodeId = dynamic_cast<propUint*>(m_oldValue.get())->value();
         uint id = dynamic_cast<propUint*>(m_newValue.get())->value();
         emit changeIdSignal(id, m_nodeId);
@@ -599,6 +542,7 @@ void CChangeProp::redo()
         //todo: check if changes allowed
         uint oldNodeId = dynamic_cast<propUint*>(m_oldValue.get())->value();
         m_nodeId = dynamic_cast<propUint*>(m_newValue.get())->value();
+        m_pView->currentMob()->reindexNode(pNode, oldNodeId);
         emit changeIdSignal(oldNodeId, m_nodeId);
         break;
     }
@@ -626,12 +570,18 @@ CResetIdCommand::CResetIdCommand(CView* pView, QMap<uint, uint>& reconnectId, QU
 
 void CResetIdCommand::undo()
 {
+    QHash<uint, uint> aRestoreId; // new ID -> old ID
+    for(auto it = m_reconnectId.constBegin(); it != m_reconnectId.constEnd(); ++it)
+        aRestoreId.insert(it.value(), it.key());
+
     CNode* pNode = nullptr;
     foreach(pNode, m_pView->currentMob()->nodes())
     {
-        if(!m_reconnectId.values().contains(pNode->mapId()))
+        if(!aRestoreId.contains(pNode->mapId()))
             continue;
-        pNode->setMapId(m_reconnectId.key(pNode->mapId()));
+        const uint oldId = pNode->mapId();
+        pNode->setMapId(aRestoreId[oldId]);
+        m_pView->currentMob()->reindexNode(pNode, oldId);
     }
     emit updateParam();
 }
@@ -644,11 +594,31 @@ void CResetIdCommand::redo()
     {
         if(!m_reconnectId.contains(pNode->mapId()))
             continue;
-        pNode->setMapId(m_reconnectId[pNode->mapId()]);
+        const uint oldId = pNode->mapId();
+        pNode->setMapId(m_reconnectId[oldId]);
+        m_pView->currentMob()->reindexNode(pNode, oldId);
     }
     emit updateParam();
 }
 
+// remembers generation of sector touched by tile command
+static void addSectorGeneration(QHash<QPair<int, int>, uint>& aGeneration, int xSec, int ySec)
+{
+    const QPair<int, int> key(xSec, ySec);
+    if(!aGeneration.contains(key))
+        aGeneration.insert(key, CLandscape::getInstance()->sectorGeneration(xSec, ySec));
+}
+
+// sector is re-read from changed file (or landscape is reloaded), old tile data of command must not be written over it
+static bool isSectorReloaded(const QHash<QPair<int, int>, uint>& aGeneration)
+{
+    for(auto it = aGeneration.constBegin(); it != aGeneration.constEnd(); ++it)
+        if(CLandscape::getInstance()->sectorGeneration(it.key().first, it.key().second) != it.value())
+            return true;
+
+    return false;
+}
+
 CBrushTileCommand::CBrushTileCommand(CView* pView, STileInfo tileInfoNew, STileLocation tileLoc, STileInfo tileInfoOld, short tileBrushCommandId, QUndoCommand* parent):
     QUndoCommand(parent)
   ,m_pView(pView)
@@ -659,16 +629,29 @@ CBrushTileCommand::CBrushTileCommand(CView* pView, STileInfo tileInfoNew, STileL
 {
     m_arrTileBrushNew[tileLoc] = tileInfoNew;
     m_arrTileBrushOld[tileLoc] = tileInfoOld;
+    addSectorGeneration(m_aSecGeneration, tileLoc.xSec, tileLoc.ySec);
 }
 
 void CBrushTileCommand::undo()
 {
+    if(isSectorReloaded(m_aSecGeneration))
+    {
+        ei::log(eLogWarning, "Tile brush is not undone: landscape was reloaded from file");
+        setObsolete(true);
+        return;
+    }
     m_pView->setTile(m_arrTileBrushOld);
 }
 
 void CBrushTileCommand::redo()
 {
     setText("Brush tiles ("+QString::number(m_arrTileBrushNew.size())+")");
+    if(isSectorReloaded(m_aSecGeneration))
+    {
+        ei::log(eLogWarning, "Tile brush is not redone: landscape was reloaded from file");
+        setObsolete(true);
+        return;
+    }
     m_pView->setTile(m_arrTileBrushNew);
     m_pView->setDirtyMpr();
 }
@@ -682,9 +665,48 @@ bool CBrushTileCommand::mergeWith(const QUndoCommand* command)
         {
             m_arrTileBrushNew[otherCmd->m_tileLoc] = otherCmd->m_tileInfoNew;
             m_arrTileBrushOld[otherCmd->m_tileLoc] = otherCmd->m_tileInfoOld;
+            addSectorGeneration(m_aSecGeneration, otherCmd->m_tileLoc.xSec, otherCmd->m_tileLoc.ySec);
         }
         setText("Brush tiles ("+QString::number(m_arrTileBrushNew.size())+")");
         return true;
     }
     return false;
 }
+
+CTileAreaCommand::CTileAreaCommand(CView* pView, const QVector<STileSpan>& arrSpan, const QVector<STileInfo>& arrInfoNew, const QVector<STileInfo>& arrInfoOld, bool bLand, QUndoCommand* parent):
+    QUndoCommand(parent)
+  ,m_pView(pView)
+  ,m_arrSpan(arrSpan)
+  ,m_arrInfoNew(arrInfoNew)
+  ,m_arrInfoOld(arrInfoOld)
+  ,m_bLand(bLand)
+{
+    const int tileSide = 16; // tiles count by 1 side of sector
+    for(auto& span : m_arrSpan)
+        for(int xSec(span.x0/tileSide); xSec<=span.x1/tileSide; ++xSec)
+            addSectorGeneration(m_aSecGeneration, xSec, span.y/tileSide);
+}
+
+void CTileAreaCommand::undo()
+{
+    if(isSectorReloaded(m_aSecGeneration))
+    {
+        ei::log(eLogWarning, "Tile fill is not undone: landscape was reloaded from file");
+        setObsolete(true);
+        return;
+    }
+    m_pView->setTileSpans(m_arrSpan, m_arrInfoOld, m_bLand);
+}
+
+void CTileAreaCommand::redo()
+{
+    setText("Fill tiles ("+QString::number(m_arrInfoNew.size())+")");
+    if(isSectorReloaded(m_aSecGeneration))
+    {
+        ei::log(eLogWarning, "Tile fill is not redone: landscape was reloaded from file");
+        setObsolete(true);
+        return;
+    }
+    m_pView->setTileSpans(m_arrSpan, m_arrInfoNew, m_bLand);
+    m_pView->setDirtyMpr();
+}
@@ -1,9 +1,12 @@
 #ifndef UNDO_H
 #define UNDO_H
 #include <QUndoCommand>
+#include <QHash>
+#include <QPair>
 #include <QJsonObject>
 #include <QMessageBox>
 #include "view.h"
+#include "mob\mob.h"
 
 ///
 /// THis file presents types of operations that can be realized with undo\redo mechanism.
@@ -62,7 +65,7 @@ class CDeleteLogicPoint: public QUndoCommand
 public:
     enum { Id = 103 };
     CDeleteLogicPoint() = delete;
-    CDeleteLogicPoint(CView* pView, QString hash, QUndoCommand *parent = nullptr);
+    CDeleteLogicPoint(CView* pView, const SLogicHandle& handle, QUndoCommand *parent = nullptr);
 
     void undo() override;
     void redo() override;
@@ -71,7 +74,7 @@ public:
 
 private:
     CView* m_pView;
-    QString m_nodeHash;
+    SLogicHandle m_handle;
 };
 
 class CCreateNodeCommand: public QObject, public QUndoCommand
@@ -80,7 +83,7 @@ class CCreateNodeCommand: public QObject, public QUndoCommand
 public:
     enum { Id = 106 };
     CCreateNodeCommand() = delete;
-    CCreateNodeCommand(CView* pView, QJsonObject nodeData, QUndoCommand *parent = nullptr);
+    CCreateNodeCommand(CView* pView, const QByteArray& nodeData, QUndoCommand *parent = nullptr);
 
     void undo() override;
     void redo() override;
@@ -93,17 +96,42 @@ signals:
 
 private:
     CView* m_pView;
-    QJsonObject m_nodeData;
+    QByteArray m_nodeData; // see CMob::serializeNodes
     uint m_createdNodeId;
 };
 
+///
+/// \brief The CPasteNodesCommand class creates all nodes of clipboard data (see CMob::serializeNodes) as one undo step
+///
+class CPasteNodesCommand: public QObject, public QUndoCommand
+{
+    Q_OBJECT
+public:
+    enum { Id = 120 };
+    CPasteNodesCommand() = delete;
+    CPasteNodesCommand(CView* pView, const QByteArray& nodeData, QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+    int id() const override { return Id; }
+
+signals:
+    void addNodeSignal(CNode*);
+    void undo_addNodeSignal(uint);
+
+private:
+    CView* m_pView;
+    QByteArray m_nodeData;
+    QVector<uint> m_arrCreatedNodeId;
+};
+
 class CChangeLogicParam : public QObject, public QUndoCommand
 {
     Q_OBJECT
 public:
     enum { Id = 107 };
     CChangeLogicParam() = delete;
-    CChangeLogicParam(CView* pView, QString pointHash, const QSharedPointer<IPropertyBase>& prop, QUndoCommand *parent = nullptr);
+    CChangeLogicParam(CView* pView, const SLogicHandle& handle, const QSharedPointer<IPropertyBase>& prop, QUndoCommand *parent = nullptr);
 
     void undo() override;
     void redo() override;
@@ -116,7 +144,7 @@ signals:
 
 protected:
     CView* m_pView;
-    QString m_pointHash;
+    SLogicHandle m_handle;
     QSharedPointer<IPropertyBase> m_oldValue;
     QSharedPointer<IPropertyBase> m_newValue;
 };
@@ -126,7 +154,7 @@ class CCreatePatrolCommand: public QUndoCommand
 public:
     enum { Id = 108 };
     CCreatePatrolCommand() = delete;
-    CCreatePatrolCommand(CView* pView, QString pointHash, QUndoCommand *parent = nullptr);
+    CCreatePatrolCommand(CView* pView, const SLogicHandle& handle, QUndoCommand *parent = nullptr);
 
     void undo() override;
     void redo() override;
@@ -135,7 +163,7 @@ public:
 
 private:
     CView* m_pView;
-    QString m_pointHash;
+    SLogicHandle m_handle;
 };
 
 class CCreateTrapPointCommand: public QUndoCommand
@@ -375,6 +403,27 @@ private:
     short m_tileBrushCommandId;
     QMap<STileLocation, STileInfo> m_arrTileBrushNew;
     QMap<STileLocation, STileInfo> m_arrTileBrushOld;
+    QHash<QPair<int, int>, uint> m_aSecGeneration; // touched sectors, see CLandscape::sectorGeneration
+};
+
+class CTileAreaCommand: public QUndoCommand
+{
+public:
+    enum { Id = 119 };
+
+    CTileAreaCommand(CView* pView, const QVector<STileSpan>& arrSpan, const QVector<STileInfo>& arrInfoNew, const QVector<STileInfo>& arrInfoOld, bool bLand, QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+    int id() const override { return Id; }
+
+private:
+    CView *m_pView;
+    QVector<STileSpan> m_arrSpan;
+    QVector<STileInfo> m_arrInfoNew; // one item per tile in order of spans
+    QVector<STileInfo> m_arrInfoOld;
+    bool m_bLand;
+    QHash<QPair<int, int>, uint> m_aSecGeneration; // touched sectors, see CLandscape::sectorGeneration
 };
 
 
@@ -8,6 +8,7 @@
 #include <QPair>
 #include <QRandomGenerator>
 #include <QMessageBox>
+#include <QSaveFile>
 
 #include "view.h"
 #include "camera.h"
@@ -33,6 +34,8 @@
 #include "layout_components/tree_view.h"
 #include "property.h"
 #include "tile.h"
+#include "tile_area.h"
+#include "mob/json_stream.h"
 
 class CLogic;
 
@@ -40,6 +43,9 @@ CView::CView(QWidget *parent, const QGLWidget *pShareWidget) : QGLWidget(parent,
   ,m_pSettings(nullptr)
   ,m_pProgress(nullptr)
   ,m_clipboard_buffer_file(QString("%1%2%3").arg(QDir::tempPath()).arg(QDir::separator()).arg("copy_paste_buffer.json"))
+  ,m_clipboardFile(QString("%1%2%3").arg(QDir::tempPath()).arg(QDir::separator()).arg("copy_paste_buffer.bin"))
+  ,m_clipboardCopyId(0)
+  ,m_clipboardTime(0)
   ,m_recentOpenedFile_file(QString("%1%2%3").arg(QDir::tempPath()).arg(QDir::separator()).arg("recent_opened.json"))
   ,m_activeMob(nullptr)
   ,m_pTree(nullptr)
@@ -56,7 +62,12 @@ CView::CView(QWidget *parent, const QGLWidget *pShareWidget) : QGLWidget(parent,
     m_aReadState.resize(eReadCount);
     connect(m_timer, SIGNAL(timeout()), this, SLOT(updateWindow()));
     m_mprModifyTimer = new QTimer;
+    m_mprModifyTimer->setSingleShot(true);
     connect(m_mprModifyTimer, SIGNAL(timeout()), this, SLOT(checkNewLandVersion()));
+    m_pLandWatcher = new QFileSystemWatcher(this);
+    connect(m_pLandWatcher, SIGNAL(fileChanged(QString)), this, SLOT(onLandFileChanged(QString)));
+    m_pLandReloadWatcher = new QFutureWatcher<SLandReload>(this);
+    connect(m_pLandReloadWatcher, SIGNAL(finished()), this, SLOT(onLandReloaded()));
     m_operationBackup.clear();
     m_selectFrame.reset(new CSelectFrame);
     //qDebug() << format();
@@ -146,6 +157,21 @@ void CView::initShaders()
     m_landProgram.setUniformValue("u_lightColor", QVector4D(1.0, 1.0, 1.0, 1.0));
     m_landProgram.setUniformValue("u_highlight", false);
 
+    // Compile terrain shader (vertices of landscape are decoded on GPU). GLSL 3.30 shaders for core profile, GLSL 1.10 for older contexts
+    const bool bModernTerrain = CLandRenderer::isModernContext();
+    if (!m_terrainProgram.addShaderFromSourceFile(QOpenGLShader::Vertex, bModernTerrain ? ":/terrain.vsh" : ":/terrain_legacy.vsh"))
+        close();
+    if (!m_terrainProgram.addShaderFromSourceFile(QOpenGLShader::Fragment, bModernTerrain ? ":/terrain.fsh" : ":/landshader.fsh"))
+        close();
+    if (!m_terrainProgram.link())
+        close();
+
+    m_terrainProgram.bind();
+    m_terrainProgram.setUniformValue("u_lightPosition", QVector4D(0.0, 0.0, 2.0, 1.0));
+    m_terrainProgram.setUniformValue("u_lightPower", 5.0f);
+    m_terrainProgram.setUniformValue("u_lightColor", QVector4D(1.0, 1.0, 1.0, 1.0));
+    m_terrainProgram.setUniformValue("u_highlight", false);
+
 
     // Compile select shader
     if (!m_selectProgram.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/vshader.vsh"))
@@ -226,7 +252,14 @@ void CView::draw()
         drawTilePreview(&m_landProgram);
 
     if (m_pLand && m_pLand->isMprLoad() && m_bDrawLand)
-        m_pLand->draw(&m_landProgram);
+    {
+        if (!m_terrainProgram.bind())
+            close();
+
+        m_terrainProgram.setUniformValue("u_projMmatrix", m_projection);
+        m_terrainProgram.setUniformValue("u_viewMmatrix", camMatrix);
+        m_pLand->draw(&m_terrainProgram, m_projection * camMatrix);
+    }
 
     // Bind shader pipeline for use
     if (!m_program.bind())
@@ -252,13 +285,15 @@ void CView::draw()
 
     if (m_pLand && m_pLand->isMprLoad() && m_bDrawWater)
     {
-        //turn to landshader again
-        if (!m_landProgram.bind())
+        //turn to terrain shader again
+        if (!m_terrainProgram.bind())
             close();
 
-        m_landProgram.setUniformValue("transparency", 0.3f);
-        m_pLand->drawWater(&m_landProgram);
-        m_landProgram.setUniformValue("transparency", 0.0f);
+        m_terrainProgram.setUniformValue("u_projMmatrix", m_projection);
+        m_terrainProgram.setUniformValue("u_viewMmatrix", camMatrix);
+        m_terrainProgram.setUniformValue("transparency", 0.3f);
+        m_pLand->drawWater(&m_terrainProgram, m_projection * camMatrix);
+        m_terrainProgram.setUniformValue("transparency", 0.0f);
     }
 
 
@@ -290,13 +325,12 @@ void CView::loadLandscape(const QFileInfo& filePath)
     emit updateMainWindowTitle(eTitleTypeData::eTitleTypeDataMprDirtyFlag, m_pLand->isDirty() ? "*" : "");
     m_timer->setInterval(15); //"fps" for drawing
     m_timer->start();
-    m_lastModifiedLand = filePath.lastModified();
     connect(m_pTileForm, SIGNAL(applyChangesSignal()), this, SLOT(onMapMaterialUpdate()));
     COptInt* pOpt = dynamic_cast<COptInt*>(settings()->opt("landCheckTime"));
     if (pOpt and pOpt->value() != 0)
-    {
+    { // option value is delay between last file change notification and reload
         m_mprModifyTimer->setInterval(pOpt->value());
-        m_mprModifyTimer->start();
+        m_pLandWatcher->addPath(filePath.absoluteFilePath());
     }
     m_pPreviewTile.reset(new CPreviewTile());
     updateTileForm(true);
@@ -319,6 +353,15 @@ void CView::unloadLand()
     }
 
     m_mprModifyTimer->stop();
+    if(!m_pLandWatcher->files().isEmpty())
+        m_pLandWatcher->removePaths(m_pLandWatcher->files());
+    if(m_pLandReloadWatcher->isRunning())
+    { // drop result of reload which is in progress
+        m_pLandReloadWatcher->waitForFinished();
+        SLandReload reload = m_pLandReloadWatcher->result();
+        qDeleteAll(reload.arrSector);
+        m_pLandReloadWatcher->setFuture(QFuture<SLandReload>());
+    }
     m_pLand->unloadMpr();
     emit updateMainWindowTitle(eTitleTypeData::eTitleTypeDataMpr, "");
     m_pPreviewTile.clear();
@@ -348,171 +391,29 @@ void CView::saveLandAs()
 }
 
 int CView::select(const SSelect &selectParam, bool bAddToSelect)
+{
+    return select(CSelectQuery(selectParam), bAddToSelect);
+}
+
+int CView::select(const CSelectQuery& query, bool bAddToSelect)
 {
     if(nullptr == m_activeMob)
         return 0;
 
-    CNode* pNode = nullptr;
-    foreach (pNode, m_activeMob->nodes())
+    const QSet<CNode*> aFound = query.run(*m_activeMob);
+    if(bAddToSelect)
     {
-        switch (selectParam.type) {
-        case eSelectType_Id_range:
-        {
-            uint id_min = selectParam.param1.toUInt();
-            uint id_max = selectParam.param2.toUInt();
-            // set equal value if only one defined
-            if(id_min!=0 && id_max==0)
-                id_max = id_min;
-            else if(id_max!=0 && id_min==0)
-                id_min = id_max;
-
-            if (id_max < id_min)
-            {
-                uint temp = id_min;
-                id_min = id_max;
-                id_max = temp;
-            }
-            if (pNode->mapId() >= id_min && pNode->mapId() <=id_max)
-            {
-                pNode->setState(eSelect);
-            }
-            else if (!bAddToSelect && (pNode->nodeState() & eSelect)) //deselect
-                pNode->setState(eDraw);
-            break;
-        }
-        case eSelectType_Map_name:
-        {
-            auto pObj = dynamic_cast<CObjectBase*>(pNode);
-            if (!pObj)
-                break;
-            bool bAppropriate = selectParam.exactMatch ? pNode->mapName() == selectParam.param1 : pNode->mapName().toLower().contains(selectParam.param1.toLower());
-            if (bAppropriate)
-            {
-                pNode->setState(eSelect);
-            }
-            else if (!bAddToSelect && (pNode->nodeState() & eSelect)) //deselect
-                pNode->setState(eDraw);
-            break;
-        }
-        case eSelectType_Texture_name:
-        {
-            if (!(pNode->nodeType() & ENodeType::eWorldObject))
-                break;
-            bool bAppropriate = selectParam.exactMatch ? pNode->textureName() == selectParam.param1 : pNode->textureName().toLower().contains(selectParam.param1.toLower());
-            if (bAppropriate)
-            {
-                pNode->setState(eSelect);
-            }
-            else if (!bAddToSelect && (pNode->nodeState() & eSelect)) //deselect
-                pNode->setState(eDraw);
-            break;
-        }
-        case eSelectType_Model_name:
-        {
-            if (!(pNode->nodeType() & ENodeType::eWorldObject))
-                break;
-
-            bool bAppropriate = selectParam.exactMatch ? pNode->modelName() == selectParam.param1 : pNode->modelName().toLower().contains(selectParam.param1.toLower());
-            if (bAppropriate)
-            {
-                pNode->setState(eSelect);
-            }
-            else if (!bAddToSelect && (pNode->nodeState() & eSelect)) //deselect
-                pNode->setState(eDraw);
-            break;
-        }
-        case eSelectType_Position_circle:
-        {
-            //TODO. create 'brush' for selecti by circle
-            break;
-        }
-        case eSelectType_Position_rectangle:
-        {
-            //TODO. create 'brush' for selecti by circle
-            break;
-        }
-        case eSelectType_Diplomacy_group:
-        {
-            auto pObj = dynamic_cast<CWorldObj*>(pNode);
-            if (!pObj)
-            {//deselect if we are trying to object diplomacy group with selected particles(and others)
-                if(!bAddToSelect && (pNode->nodeState() & eSelect))
-                    pNode->setState(eDraw);
-                break;
-            }
-
-            int group_min = selectParam.param1.toUInt();
-            int group_max = selectParam.param2.toUInt();
-            if (group_max < group_min)
-            {
-                uint temp = group_min;
-                group_min = group_max;
-                group_max = temp;
-            }
-            if (pObj->dipGroup() >= group_min && pObj->dipGroup() <= group_max )
-            {
-                pNode->setState(eSelect);
-            }
-            else if (!bAddToSelect && (pNode->nodeState() & eSelect)) //deselect
-            {
-                pNode->setState(eDraw);
-            }
-            break;
-        }
-        case eSelectType_Database_name:
+        for(auto& pNode : aFound)
+            pNode->setState(eSelect);
+    }
+    else
+    {
+        for(auto& pNode : m_activeMob->nodes())
         {
-            auto pObj = dynamic_cast<CUnit*>(pNode);
-            if (!pObj)
-            { //deselect if we are trying to find unit database name with selected world object(and others)
-                if(!bAddToSelect && (pNode->nodeState() & eSelect))
-                    pNode->setState(eDraw);
-                break;
-            }
-
-            bool bAppropriate = selectParam.exactMatch ? pObj->databaseName() == selectParam.param1 : pObj->databaseName().toLower().contains(selectParam.param1.toLower());
-            if (bAppropriate)
-            {
+            if(aFound.contains(pNode))
                 pNode->setState(eSelect);
-            }
-            else if (!bAddToSelect && (pNode->nodeState() & eSelect)) //deselect
-            {
-                pNode->setState(eDraw);
-            }
-            break;
-        }
-        case eSelectType_Template:
-        {
-            auto pWo = dynamic_cast<CWorldObj*>(pNode);
-            if(nullptr == pWo)
-                break;
-
-            QSharedPointer<IPropertyBase> templ;
-            pWo->getParam(templ, eObjParam_PARENT_TEMPLATE);
-            bool bAppropriate = selectParam.exactMatch ? templ->toString() == selectParam.param1 : templ->toString().toLower().contains(selectParam.param1.toLower());
-            if(bAppropriate)
-                pNode->setState(ENodeState::eSelect);
-            else if (!bAddToSelect && (pNode->nodeState() & eSelect)) //deselect
-            {
+            else if(pNode->nodeState() & eSelect) //deselect
                 pNode->setState(eDraw);
-            }
-
-            break;
-        }
-        case eSelectType_all:
-        {
-            if(selectParam.param1.toLower()=="logic")
-            {
-                if(m_activeMob->logicNodes().contains(pNode))
-                    pNode->setState(eSelect);
-                else
-                    pNode->setState(eDraw);
-            }
-            else
-                pNode->setState(eSelect);
-            break;
-        }
-        default:
-            break;
         }
     }
     viewParameters();
@@ -550,32 +451,6 @@ QDebug operator<<(QDebug stream, const SColor& color)
     return stream;
 }
 
-void CView::getColorFromRect(const QRect& rect, QVector<SColor>& aColor)
-{
-    //get colors from rectangle
-    const int component = 3; //rgb
-    //revert Oy for picking
-    const QPoint topLeft (rect.left(), m_height - rect.bottom());
-    const QPoint btmRight(rect.right(), m_height - rect.top());
-    const QRect inversedRect(topLeft, btmRight);
-
-    const int h = inversedRect.height() == 0 ? 1 : qAbs(inversedRect.height());
-    const int w = inversedRect.width() == 0 ? 1 :qAbs(inversedRect.width());
-    uint size = component * w * h;
-    QByteArray* pixel = new QByteArray();
-    pixel->resize(size);
-    glPixelStorei(GL_PACK_ALIGNMENT, 1); // glReadPixels use 4 component by default. for RGB must define pack alignment
-    glReadPixels(inversedRect.left(), inversedRect.bottom(), w, h, GL_RGB, GL_UNSIGNED_BYTE, pixel->data());
-    SColor color;
-    for(int i(0); i<component * w * h; i+=3)
-    {
-        color = SColor(pixel->at(i), pixel->at(i+1), pixel->at(i+2));
-        if (!color.isBlack() && !aColor.contains(color))
-            aColor.append(SColor(color));
-    }
-    delete pixel;
-}
-
 void CView::changeCurrentMob(CMob *pMob)
 {
     m_activeMob = pMob;
@@ -606,69 +481,13 @@ void CView::onParamChangeLogic(CNode *pNode, const QSharedPointer<IPropertyBase>
     switch(type)
     {
     case eMagicTrap:
-    {
-        CChangeLogicParam* pChanger = new CChangeLogicParam(this, QString::number(pNode->mapId()), prop);
-        QObject::connect(pChanger, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-        m_pUndoStack->push(pChanger);
-        break;
-    }
     case eUnit:
-    {
-        CChangeLogicParam* pChanger = new CChangeLogicParam(this, QString::number(pNode->mapId()), prop);
-        QObject::connect(pChanger, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-        m_pUndoStack->push(pChanger);
-        break;
-    }
     case ePatrolPoint:
-    {
-        auto pPoint = dynamic_cast<CPatrolPoint*>(pNode);
-        int unitId(0);
-        int patrolId(0);
-        m_activeMob->getPatrolHash(unitId, patrolId, pPoint);
-        QString hash = QString("%1.%2").arg(unitId).arg(patrolId);
-        CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, prop);
-        QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-        m_pUndoStack->push(pOp);
-        break;
-    }
     case eLookPoint:
-    {
-        auto pPoint = dynamic_cast<CLookPoint*>(pNode);
-        int unitId(0);
-        int patrolId(0);
-        int viewId(0);
-        m_activeMob->getViewHash(unitId, patrolId, viewId, pPoint);
-        QString hash = QString("%1.%2.%3").arg(unitId).arg(patrolId).arg(viewId);
-        CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, prop);
-        QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-        m_pUndoStack->push(pOp);
-        break;
-    }
     case eTrapActZone:
-    {
-        auto pZone = dynamic_cast<CActivationZone*>(pNode);
-        int unitId(0);
-        int patrolId(-2);
-        int viewId(-2);
-        int zoneId(0);
-        m_activeMob->getTrapZoneHash(unitId, zoneId, pZone);
-        QString hash = QString("%1.%2.%3.%4").arg(unitId).arg(patrolId).arg(viewId).arg(zoneId);
-        CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, prop);
-        QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-        m_pUndoStack->push(pOp);
-        break;
-    }
     case eTrapCastPoint:
     {
-        auto pCast = dynamic_cast<CTrapCastPoint*>(pNode);
-        int unitId(0);
-        int patrolId(-2);
-        int viewId(-2);
-        int zoneId(-2);
-        int castPointId(0);
-        m_activeMob->getTrapCastHash(unitId, castPointId, pCast);
-        QString hash = QString("%1.%2.%3.%4.%5").arg(unitId).arg(patrolId).arg(viewId).arg(zoneId).arg(castPointId);
-        CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, prop);
+        CChangeLogicParam* pOp = new CChangeLogicParam(this, m_activeMob->logicHandle(pNode), prop);
         QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
         m_pUndoStack->push(pOp);
         break;
@@ -798,19 +617,56 @@ void CView::onRestoreTileData()
 
 }
 
+// Starts background check of *.mpr. QFileSystemWatcher sends several signals for one save, so it is called by single shot timer after the last one
 void CView::checkNewLandVersion()
 {
-    return; //todo: set option to auto-check changes in mpr. Dont re-upload when save by ourselfes
-    // Dont use QFileSystemWatcher because it spams signals several time for 1 MapEd save
-    QFileInfo landPath(m_pLand->filePath());
-    landPath.refresh();
-    QDateTime lastM = landPath.lastModified();
-    if (lastM > m_lastModifiedLand)
+    if(!m_pLand->isMprLoad())
+        return;
+
+    if(m_pLandReloadWatcher->isRunning())
+    { // check again after current reload
+        m_mprModifyTimer->start();
+        return;
+    }
+    m_pLandReloadWatcher->setFuture(m_pLand->decodeChangedSectorsAsync());
+}
+
+void CView::onLandFileChanged(const QString& path)
+{
+    // some tools replace file instead of writing it, watcher drops such path
+    if(!m_pLandWatcher->files().contains(path) && QFileInfo::exists(path))
+        m_pLandWatcher->addPath(path);
+    m_mprModifyTimer->start();
+}
+
+void CView::onLandReloaded()
+{
+    SLandReload reload = m_pLandReloadWatcher->result();
+    if(reload.bFullReload)
     {
+        ei::log(eLogInfo, "Landscape header is changed, reload whole landscape");
+        QFileInfo landPath(m_pLand->filePath());
+        landPath.refresh();
         unloadLand();
-        loadLandscape(landPath);
-        m_lastModifiedLand = lastM;
+        if(!m_pLand->isMprLoad()) // unloading can be canceled by user
+            loadLandscape(landPath);
+        return;
+    }
+
+    if(!reload.arrSector.isEmpty() && m_pLand->isDirty())
+    { // changed sectors would replace unsaved tile edits
+        QMessageBox::StandardButton reply;
+        reply = QMessageBox::question(this, "Reload MPR", m_pLand->filePath().baseName() + " was changed by another program, but it has unsaved changes.\nReload changed sectors and lose unsaved changes in them?", QMessageBox::Yes|QMessageBox::No);
+        if(reply != QMessageBox::Yes)
+        {
+            ei::log(eLogInfo, "Landscape reload is skipped, file changes will be overwritten on save");
+            qDeleteAll(reload.arrSector);
+            return;
+        }
     }
+
+    makeCurrent();
+    m_pLand->applyReload(reload); // undo of tile edits in replaced sectors is dropped, see CLandscape::sectorGeneration
 }
 
 void CView::drawSelectFrame(QRect &rect)
@@ -825,64 +681,39 @@ void CView::drawSelectFrame(QRect &rect)
     m_selectFrame->updateFrame(bottomLeft, topRight);
 }
 
+// Click picks the nearest object under cursor, frame picks every object inside of it (occluded too)
 void CView::pickObject(const QRect &rect, bool bAddToSelect)
 {
-    //TODO: use different buffer => save picking in image
-    // Bind shader pipeline for use
     if(nullptr == m_activeMob)
     {
         m_selectFrame->reset();
         return;
     }
 
-    if (!m_selectProgram.bind())
-        close();
-
-    m_selectProgram.setUniformValue("u_projMmatrix", m_projection);
-    m_selectProgram.setUniformValue("u_viewMmatrix", m_cam->update());
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    //if(m_operationType == EOperationTypeObjects)
-    //for(const auto& mob : m_aMob)
-    //foreach(const auto& mob, m_aMob)
-    foreach (auto& node, CScene::getInstance()->getMode() == eEditModeLogic ? m_activeMob->logicNodes() : m_activeMob->nodes())
-        node->drawSelect(&m_selectProgram);
-
-    QVector<SColor> aColor;
-    getColorFromRect(rect, aColor);
-
-    //if(m_operationType == EOperationTypeObjects)
+    const QRect area = rect.normalized();
+    QVector<CNode*> arrNode;
+    if(area.width() <= 1 && area.height() <= 1)
+    {
+        if(CNode* pNode = pickObject(area.left(), area.top()))
+            arrNode.append(pNode);
+    }
+    else
+        arrNode = pickObjects(area);
 
     if (!bAddToSelect) // clear selection buffer if we click out of objects in single selection mode
         m_activeMob->clearSelect(true);
 
-    if (!aColor.isEmpty())
-        foreach (auto& node, CScene::getInstance()->getMode() == eEditModeLogic ? m_activeMob->logicNodes() : m_activeMob->nodes())
-            foreach (const auto& color, aColor)
-            {
-                if (node->isColorSuitable(color))
-                {
-                    if (bAddToSelect)
-                    {//shift pressed
-
-                        if (node->nodeState() & ENodeState::eSelect)
-                        {//remove from select
-                            node->setState(ENodeState::eDraw);
-                        }
-                        else
-                        {// add to select
-                            node->setState(ENodeState::eSelect);
-                        }
-                        break;
-                    }
-                    else
-                    {//shift not pressed
-                        node->setState(ENodeState::eSelect);
-                        break;
-                    }
-                    break;
-                }
-            }
+    for(auto& node : arrNode)
+    {
+        if (bAddToSelect && (node->nodeState() & ENodeState::eSelect))
+        {//shift pressed, remove from select
+            node->setState(ENodeState::eDraw);
+        }
+        else
+        {// add to select
+            node->setState(ENodeState::eSelect);
+        }
+    }
 
     m_selectFrame->reset();
 }
@@ -1263,6 +1094,70 @@ void CView::setTile(QVector3D posOnLand, bool bLand)
 //    m_pLand->updateSectorDrawData(tileLoc.xSec, tileLoc.ySec);
 }
 
+// Fills tiles of area by selected tile. If several tiles are selected each tile of area gets random one of them
+void CView::fillTileArea(ETileAreaShape shape, const QVector3D& posStart, const QVector3D& posEnd, bool bLand)
+{
+    if(!m_pLand->isMprLoad())
+        return;
+
+    QVector<int> arrIndex;
+    int rotNum;
+    m_pTileForm->getSelectedTiles(arrIndex, rotNum);
+    if(arrIndex.isEmpty())
+        return;
+
+    const int matIndex = m_pTileForm->activeMaterialindex();
+    const QPoint tileStart(int(posStart.x()/2.0f), int(posStart.y()/2.0f)); // tile is 2x2 units
+    const QPoint tileEnd(int(posEnd.x()/2.0f), int(posEnd.y()/2.0f));
+    CTileArea area(m_pLand->tileMapSize());
+    switch (shape) {
+    case eTileAreaRect:
+    {
+        area.rect(tileStart, tileEnd);
+        break;
+    }
+    case eTileAreaCircle:
+    {
+        area.circle(tileStart, qRound(QVector2D(tileEnd - tileStart).length()));
+        break;
+    }
+    case eTileAreaFlood:
+    {
+        STileInfo startInfo;
+        if(!m_pLand->tileInfo(startInfo, tileStart.x(), tileStart.y(), bLand))
+            return;
+        CLandscape* pLand = m_pLand;
+        area.floodFill(tileStart, [pLand, &startInfo, bLand](int x, int y)
+        {
+            STileInfo info;
+            return pLand->tileInfo(info, x, y, bLand) && info == startInfo;
+        });
+        break;
+    }
+    }
+    if(area.isEmpty())
+        return;
+
+    QVector<STileInfo> arrInfoOld;
+    m_pLand->tileSpanInfo(arrInfoOld, area.spans(), bLand);
+    QVector<STileInfo> arrInfoNew(arrInfoOld.size());
+    for(auto& info: arrInfoNew)
+    {
+        const int index = arrIndex.size() == 1 ? arrIndex.first() : arrIndex[QRandomGenerator::global()->bounded(arrIndex.size())];
+        info = STileInfo{index, rotNum, matIndex};
+    }
+
+    m_pUndoStack->push(new CTileAreaCommand(this, area.spans(), arrInfoNew, arrInfoOld, bLand));
+}
+
+void CView::setTileSpans(const QVector<STileSpan>& arrSpan, const QVector<STileInfo>& arrInfo, bool bLand)
+{
+    if(!m_pLand->isMprLoad())
+        return;
+
+    m_pLand->setTileSpans(arrSpan, arrInfo, bLand);
+}
+
 void CView::setTile(QMap<STileLocation, STileInfo>& arrTileData)
 {
     if(!m_pLand->isMprLoad())
@@ -1614,14 +1509,15 @@ void CView::moveCamToSelectedObjects()
 {
     CNode* pNode = nullptr;
     CBox box;
+    QVector3D minPos, maxPos;
+    const CSpatialIndex& spatialIndex = m_activeMob->spatialIndex(); // world boxes are cached there
     foreach(pNode, m_activeMob->nodes())
     {
         if (pNode->nodeState() != ENodeState::eSelect)
             continue;
-        // calculate world position
-        CBox nodeBox = pNode->getBBox();
-        nodeBox.move(pNode->drawPosition());
-        box.expand(nodeBox);
+
+        if(spatialIndex.bounds(pNode, minPos, maxPos))
+            box.expand(CBox(minPos, maxPos));
     }
 
     if(box.isInit())
@@ -1661,74 +1557,112 @@ void CView::focusOutEvent(QFocusEvent *event)
     }
 }
 
-// draw objects without light and textures, only colored triangles; find suitable object
-// x,y - mouse position
-CNode* CView::pickObject(QList<CNode*>& aNode, int x, int y)
+// ray from camera through the cursor in world space, dir is from near to far plane
+void CView::cursorRay(QVector3D& origin, QVector3D& dir, int cursorPosX, int cursorPosY)
 {
-    // Bind shader pipeline for use
-    if (!m_selectProgram.bind())
-        close();
+    const QMatrix4x4 view = m_cam->viewMatrix();
+    const QRect viewPortRect(0, 0, width(), height());
+    const int posY (height() - cursorPosY);
+    origin = QVector3D(cursorPosX, posY, 0.0f).unproject(view, m_projection, viewPortRect);
+    dir = QVector3D(cursorPosX, posY, 1.0f).unproject(view, m_projection, viewPortRect) - origin;
+}
 
-    m_selectProgram.setUniformValue("u_projMmatrix", m_projection);
-    m_selectProgram.setUniformValue("u_viewMmatrix", m_cam->update());
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+// Nearest object hit by the cursor ray. Candidates come from boxes of spatial index (sorted by distance), then triangles of their models are checked.
+// Logic points are drawn over everything, so in logic mode they go first
+CNode* CView::pickObject(int x, int y)
+{
+    QVector3D origin, dir;
+    cursorRay(origin, dir, x, y);
+    const bool bLogic = CScene::getInstance()->getMode() == eEditModeLogic;
+    CNode* pPicked = nullptr;
+    float minDist(0.0f), dist(0.0f);
+    if(bLogic)
+    {
+        for(auto& node : m_activeMob->logicNodes())
+        {
+            if(m_activeMob->logicHandle(node).type == eLogicHandleObject) // unit or trap
+                continue;
 
-    for (auto node: aNode)
+            if(node->intersectRay(dist, origin, dir) && (nullptr == pPicked || dist < minDist))
+            {
+                pPicked = node;
+                minDist = dist;
+            }
+        }
+        if(pPicked)
+            return pPicked;
+    }
+
+    for(auto& hit : m_activeMob->spatialIndex().queryRay(origin, dir))
     {
-        node->drawSelect(&m_selectProgram);
+        if(pPicked && hit.first > minDist) // the rest boxes are farther than picked triangle
+            break;
+
+        CNode* node = hit.second;
+        if(bLogic && node->nodeType() != ENodeType::eUnit && node->nodeType() != ENodeType::eMagicTrap)
+            continue;
+
+        if(node->intersectRay(dist, origin, dir) && (nullptr == pPicked || dist < minDist))
+        {
+            pPicked = node;
+            minDist = dist;
+        }
     }
+    return pPicked;
+}
 
-    GLubyte pixel[3];
-    glReadPixels(x, m_height-y, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, pixel);
-    SColor pickedColor(pixel[0], pixel[1], pixel[2]);
+// Objects having vertices inside of frame frustum. Object under frame center is added for models larger than frame
+QVector<CNode*> CView::pickObjects(const QRect& rect)
+{
+    // the same as projection with the frame stretched to the whole viewport
+    const float left = 2.0f * rect.left() / width() - 1.0f;
+    const float right = 2.0f * (rect.right() + 1) / width() - 1.0f;
+    const float bottom = 1.0f - 2.0f * (rect.bottom() + 1) / height();
+    const float top = 1.0f - 2.0f * rect.top() / height();
+    QMatrix4x4 frame;
+    frame.setToIdentity();
+    frame.scale(2.0f / (right - left), 2.0f / (top - bottom), 1.0f);
+    frame.translate(-(left + right) / 2.0f, -(bottom + top) / 2.0f, 0.0f);
+    const QMatrix4x4 viewProj = frame * m_projection * m_cam->viewMatrix();
 
-    for (auto& node: aNode)
+    const bool bLogic = CScene::getInstance()->getMode() == eEditModeLogic;
+    QVector<CNode*> arrNode;
+    if(bLogic)
     {
-        if (node->isColorSuitable(pickedColor))
-            return node;
+        for(auto& node : m_activeMob->logicNodes())
+            if(m_activeMob->logicHandle(node).type != eLogicHandleObject && node->intersectFrustum(viewProj))
+                arrNode.append(node);
+    }
+    for(auto& node : m_activeMob->spatialIndex().queryFrustum(viewProj))
+    {
+        if(bLogic && node->nodeType() != ENodeType::eUnit && node->nodeType() != ENodeType::eMagicTrap)
+            continue;
+
+        if(node->intersectFrustum(viewProj))
+            arrNode.append(node);
     }
 
-    return nullptr;
+    CNode* pCenter = pickObject(rect.center().x(), rect.center().y());
+    if(pCenter && !arrNode.contains(pCenter))
+        arrNode.append(pCenter);
+
+    return arrNode;
 }
 
-//clear buffer, draw only landscape, project point and return vector3D
+//cast ray from camera through the cursor and intersect it with landscape heightfield on CPU
 QVector3D CView::getTerrainPos(const int cursorPosX, const int cursorPosY, bool bLand)
 {
     QVector3D point(0,0,0);
     if(!m_pLand || !m_pLand->isMprLoad())
         return point;
 
-    QMatrix4x4 camMatrix = m_cam->viewMatrix();
-    // Set modelview-projection matrix
-
-    // Bind shader pipeline for use
-    if (!m_landProgram.bind())
-        close();
-
-    // Set modelview-projection matrix
-    m_landProgram.setUniformValue("u_projMmatrix", m_projection);
-    m_landProgram.setUniformValue("u_viewMmatrix", camMatrix);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    if(bLand)
-        m_pLand->draw(&m_landProgram);
-    else
-    {
-        m_pLand->drawWater(&m_landProgram);
-    }
-    const int posY (height() - cursorPosY);
-    float z;
-    glReadPixels(cursorPosX, posY, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &z );
-    //QVector3D point (cursorPosX, posY, z);
-    point.setX(cursorPosX);
-    point.setY(posY);
-    point.setZ(z);
+    QVector3D nearPt, dir;
+    cursorRay(nearPt, dir, cursorPosX, cursorPosY);
+    STileLocation tileLoc;
+    if(m_pLand->intersectRay(point, tileLoc, nearPt, dir, bLand))
+        return point;
 
-    QMatrix4x4 view = m_cam->viewMatrix();
-    GLint viewPort[4];
-    glGetIntegerv(GL_VIEWPORT, viewPort);
-    QRect viewPortRect(viewPort[0], viewPort[1], viewPort[2], viewPort[3]);
-    return point.unproject(view, m_projection, viewPortRect); //return Vector3D here
+    return nearPt + dir; // nothing is hit, the same as empty pixel of depth buffer gives
 }
 
 void CView::changeOperation(EButtonOp type)
@@ -1823,62 +1757,12 @@ void CView::operationApply(EOperationAxisType operationType)
                     break;
                 }
                 case ePatrolPoint:
-                {
-                    auto pPoint = dynamic_cast<CPatrolPoint*>(pair.first);
-                    int unitId(0);
-                    int patrolId(0);
-                    m_activeMob->getPatrolHash(unitId, patrolId, pPoint);
-                    QString hash = QString("%1.%2").arg(unitId).arg(patrolId);
-                    QSharedPointer<IPropertyBase> pos (new prop3D(eObjParam_POSITION, pair.first->position()));
-                    CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, pos);
-                    QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-                    pair.first->updatePos(m_operationBackup[pair.first]); //revert position to start (it will apply in 'push' operation
-                    m_pUndoStack->push(pOp);
-                    break;
-                }
                 case eLookPoint:
-                {
-                    auto pPoint = dynamic_cast<CLookPoint*>(pair.first);
-                    int unitId(0);
-                    int patrolId(0);
-                    int viewId(0);
-                    m_activeMob->getViewHash(unitId, patrolId, viewId, pPoint);
-                    QString hash = QString("%1.%2.%3").arg(unitId).arg(patrolId).arg(viewId);
-                    QSharedPointer<IPropertyBase> pos (new prop3D(eObjParam_POSITION, pair.first->position()));
-                    CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, pos);
-                    QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-                    pair.first->updatePos(m_operationBackup[pair.first]); //revert position to start (it will apply in 'push' operation
-                    m_pUndoStack->push(pOp);
-                    break;
-                }
                 case eTrapActZone:
-                {
-                    auto pZone = dynamic_cast<CActivationZone*>(pair.first);
-                    int unitId(0);
-                    int patrolId(-2);
-                    int viewId(-2);
-                    int zoneId(0);
-                    m_activeMob->getTrapZoneHash(unitId, zoneId, pZone);
-                    QString hash = QString("%1.%2.%3.%4").arg(unitId).arg(patrolId).arg(viewId).arg(zoneId);
-                    QSharedPointer<IPropertyBase> pos (new prop3D(eObjParam_POSITION, pair.first->position()));
-                    CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, pos);
-                    QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
-                    pair.first->updatePos(m_operationBackup[pair.first]); //revert position to start (it will apply in 'push' operation
-                    m_pUndoStack->push(pOp);
-                    break;
-                }
                 case eTrapCastPoint:
                 {
-                    auto pCast = dynamic_cast<CTrapCastPoint*>(pair.first);
-                    int unitId(0);
-                    int patrolId(-2);
-                    int viewId(-2);
-                    int zoneId(-2);
-                    int castPointId(0);
-                    m_activeMob->getTrapCastHash(unitId, castPointId, pCast);
-                    QString hash = QString("%1.%2.%3.%4.%5").arg(unitId).arg(patrolId).arg(viewId).arg(zoneId).arg(castPointId);
                     QSharedPointer<IPropertyBase> pos (new prop3D(eObjParam_POSITION, pair.first->position()));
-                    CChangeLogicParam* pOp = new CChangeLogicParam(this, hash, pos);
+                    CChangeLogicParam* pOp = new CChangeLogicParam(this, m_activeMob->logicHandle(pair.first), pos);
                     QObject::connect(pOp, SIGNAL(updateParam()), this, SLOT(viewParameters()));
                     pair.first->updatePos(m_operationBackup[pair.first]); //revert position to start (it will apply in 'push' operation
                     m_pUndoStack->push(pOp);
@@ -2021,8 +1905,8 @@ void CView::resetUnitLogicPaths()
 
         auto pUnit = dynamic_cast<CUnit*>(pNode);
         pUnit->clearPaths();
+        m_activeMob->logicNodesUpdate(pUnit);
     }
-    m_activeMob->logicNodesUpdate();
     m_activeMob->setDirty();
 }
 
@@ -2039,52 +1923,11 @@ void CView::deleteSelectedNodes()
         switch(type)
         {
         case ePatrolPoint:
-        {
-            auto pPoint = dynamic_cast<CPatrolPoint*>(pNode);
-            int unitId(0);
-            int patrolId(0);
-            m_activeMob->getPatrolHash(unitId, patrolId, pPoint);
-            QString hash = QString("%1.%2").arg(unitId).arg(patrolId);
-            CDeleteLogicPoint* pOp = new CDeleteLogicPoint(this, hash);
-            m_pUndoStack->push(pOp);
-            break;
-        }
         case eLookPoint:
-        {
-            auto pPoint = dynamic_cast<CLookPoint*>(pNode);
-            int unitId(0);
-            int patrolId(0);
-            int viewId(0);
-            m_activeMob->getViewHash(unitId, patrolId, viewId, pPoint);
-            QString hash = QString("%1.%2.%3").arg(unitId).arg(patrolId).arg(viewId);
-            CDeleteLogicPoint* pOp = new CDeleteLogicPoint(this, hash);
-            m_pUndoStack->push(pOp);
-            break;
-        }
         case eTrapActZone:
-        {
-            auto pZone = dynamic_cast<CActivationZone*>(pNode);
-            int unitId(0);
-            int patrolId(-2);
-            int viewId(-2);
-            int zoneId(0);
-            m_activeMob->getTrapZoneHash(unitId, zoneId, pZone);
-            QString hash = QString("%1.%2.%3.%4").arg(unitId).arg(patrolId).arg(viewId).arg(zoneId);
-            CDeleteLogicPoint* pOp = new CDeleteLogicPoint(this, hash);
-            m_pUndoStack->push(pOp);
-            break;
-        }
         case eTrapCastPoint:
         {
-            auto pCast = dynamic_cast<CTrapCastPoint*>(pNode);
-            int unitId(0);
-            int patrolId(-2);
-            int viewId(-2);
-            int zoneId(-2);
-            int castPointId(0);
-            m_activeMob->getTrapCastHash(unitId, castPointId, pCast);
-            QString hash = QString("%1.%2.%3.%4.%5").arg(unitId).arg(patrolId).arg(viewId).arg(zoneId).arg(castPointId);
-            CDeleteLogicPoint* pOp = new CDeleteLogicPoint(this, hash);
+            CDeleteLogicPoint* pOp = new CDeleteLogicPoint(this, m_activeMob->logicHandle(pNode));
             m_pUndoStack->push(pOp);
             break;
         }
@@ -2108,81 +1951,142 @@ void CView::deleteSelectedNodes()
     //updateViewTree();
 }
 
+// Selected nodes are kept in memory in MOB object encoding. The same data is written to temp file for other editor instances,
+// its header tells which instance, copy and time it is. The file is replaced at once (QSaveFile), so failed write keeps the previous
+// copy whole, and paste takes the file only when its copy is newer than the last one of this instance
 void CView::selectedObjectToClipboardBuffer()
 {
     if(nullptr == m_activeMob)
         return;
 
-    CNode* pNode;
-
-    QJsonArray arrObj;
-    //for(auto& mob: m_aMob)
-    foreach(pNode, m_activeMob->nodes())
+    QList<CNode*> arrNode;
+    for(auto& pNode : m_activeMob->nodes())
         if (pNode->nodeState() & ENodeState::eSelect)
-            arrObj.append(pNode->toJson());
+            arrNode.append(pNode);
 
-    QJsonObject obj;
-    obj.insert("Version", 2);
     auto pos = QWidget::mapFromGlobal(QCursor::pos());
-    auto posOnLand = getTerrainPos(pos.x(), pos.y());
-    QJsonArray point;
-    point.append(QJsonValue::fromVariant(posOnLand.x()));
-    point.append(QJsonValue::fromVariant(posOnLand.y()));
-    point.append(QJsonValue::fromVariant(posOnLand.z()));
-    obj.insert("Mouse position", point);
-    obj.insert("Data", arrObj);
+    m_clipboardMousePos = getTerrainPos(pos.x(), pos.y());
+    m_clipboardData = m_activeMob->serializeNodes(arrNode);
+    ++m_clipboardCopyId;
+    m_clipboardTime = QDateTime::currentMSecsSinceEpoch();
 
-    QJsonDocument doc(obj);
-
-    if (!m_clipboard_buffer_file.open(QIODevice::WriteOnly))
+    QSaveFile file(m_clipboardFile.fileName());
+    if (!file.open(QIODevice::WriteOnly))
     {
-        Q_ASSERT("Couldn't open option file." && false);
+        ei::log(eLogWarning, "Couldn't open clipboard file " + file.fileName());
+        return;
     }
-    else
+    QDataStream stream(&file);
+    util::formatStream(stream);
+    stream << quint32(4) << QCoreApplication::applicationPid() << m_clipboardCopyId << m_clipboardTime << m_clipboardMousePos << m_clipboardData;
+    if (stream.status() != QDataStream::Ok || !file.commit())
+        ei::log(eLogWarning, "Couldn't write clipboard file " + file.fileName());
+}
+
+// Returns true and data of clipboard file if it was copied by other instance after the last copy of this one
+bool CView::readClipboardFile(QVector3D& mousePos, QByteArray& data)
+{
+    if (!m_clipboardFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&m_clipboardFile);
+    util::formatStream(stream);
+    quint32 version(0);
+    qint64 pid(0);
+    uint copyId(0);
+    qint64 copyTime(0);
+    stream >> version >> pid >> copyId >> copyTime;
+
+    const bool bOwnCopy = pid == QCoreApplication::applicationPid() && copyId == m_clipboardCopyId;
+    const bool bNewer = m_clipboardCopyId == 0 || copyTime > m_clipboardTime || (copyTime == m_clipboardTime && pid != QCoreApplication::applicationPid());
+    if (version != 4 || bOwnCopy || !bNewer)
     {
-        m_clipboard_buffer_file.write(doc.toJson(QJsonDocument::JsonFormat::Indented));
-        m_clipboard_buffer_file.close();
+        m_clipboardFile.close();
+        return false;
     }
 
+    stream >> mousePos >> data;
+    m_clipboardFile.close();
+    return stream.status() == QDataStream::Ok;
 }
 
 void CView::clipboradObjectsToScene()
+{
+    if(nullptr == m_activeMob)
+        return;
+
+    QVector3D oldMousePos;
+    QByteArray data;
+    if(!readClipboardFile(oldMousePos, data))
+    {
+        if(m_clipboardCopyId == 0)
+        {// nothing was copied here, clipboard of older editor versions
+            jsonClipboardObjectsToScene();
+            return;
+        }
+        oldMousePos = m_clipboardMousePos;
+        data = m_clipboardData;
+    }
+
+    if(data.isEmpty())
+    {
+        ei::log(eLogInfo, "clipboard empty");
+        return;
+    }
+
+    m_activeMob->clearSelect();
+    CPasteNodesCommand* pUndo = new CPasteNodesCommand(this, data);
+    QObject::connect(pUndo, SIGNAL(addNodeSignal(CNode*)), m_pTree, SLOT(addNodeToTree(CNode*)));
+    QObject::connect(pUndo, SIGNAL(undo_addNodeSignal(uint)), m_pTree, SLOT(onNodeDelete(uint)));
+    m_pUndoStack->push(pUndo);
+
+    //move copyed nodes to new mouse position
+    auto pos = QWidget::mapFromGlobal(QCursor::pos());
+    auto posOnLand = getTerrainPos(pos.x(), pos.y());
+    auto mouseDif = posOnLand - oldMousePos;
+    mouseDif.setZ(0.0f);
+    m_pOp->changeState(new CMoveAxis(this, EOperateAxisXY));
+    moveTo(mouseDif);
+
+    viewParameters();
+}
+
+// Reads json clipboard file written by previous versions. Objects are streamed to clipboard data and pasted as one undo step
+void CView::jsonClipboardObjectsToScene()
 {
     if (!m_clipboard_buffer_file.open(QIODevice::ReadOnly))
     {
-        Q_ASSERT("Couldn't open option file." && false);
+        ei::log(eLogInfo, "clipboard empty");
         return;
     }
 
     if (m_clipboard_buffer_file.size() == 0)
     {
         qDebug() << "empty copypasteBuffer file";
+        m_clipboard_buffer_file.close();
         return;
     }
 
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(m_clipboard_buffer_file.readAll(), &parseError);
+    CJsonStreamReader reader(&m_clipboard_buffer_file, "Data");
+    int nNode(0);
+    QByteArray data = m_activeMob->jsonNodesToData(reader, nNode);
+    const QJsonObject obj = reader.header();
     m_clipboard_buffer_file.close();
-    //todo: check if has no error
-    QJsonObject obj = doc.object();
-    if (obj["Version"].toInt() != 2)
+    if (reader.hasError() || obj["Version"].toInt() != 2)
         return;
 
-    auto array = obj["Data"].toArray();
-    if(array.isEmpty())
+    if(nNode == 0)
     {
         ei::log(eLogInfo, "clipboard empty");
         return;
     }
 
     m_activeMob->clearSelect();
-    for(auto it = array.begin(); it < array.end(); ++it)
-    {
-        CCreateNodeCommand* pUndo = new CCreateNodeCommand(this, it->toObject());
-        QObject::connect(pUndo, SIGNAL(addNodeSignal(CNode*)), m_pTree, SLOT(addNodeToTree(CNode*)));
-        QObject::connect(pUndo, SIGNAL(undo_addNodeSignal(uint)), m_pTree, SLOT(onNodeDelete(uint)));
-        m_pUndoStack->push(pUndo);
-    }
+    CPasteNodesCommand* pUndo = new CPasteNodesCommand(this, data);
+    QObject::connect(pUndo, SIGNAL(addNodeSignal(CNode*)), m_pTree, SLOT(addNodeToTree(CNode*)));
+    QObject::connect(pUndo, SIGNAL(undo_addNodeSignal(uint)), m_pTree, SLOT(onNodeDelete(uint)));
+    m_pUndoStack->push(pUndo);
+
     //move copyed nodes to new mouse position
     QVector3D oldMousePos;
     QJsonArray arrPoint = obj["Mouse position"].toArray();
@@ -2267,31 +2171,21 @@ void CView::addLogicPoint(bool bLookPoint)
             if(!bLookPoint)
                 break; //dont create patrol point for view point
 
-            int unitId(0); //parent unit map id
-            int patrolId(0); //patrol parent id
-            int viewId(0); //parent view id
-            auto pLook = dynamic_cast<CLookPoint*>(pNode);
-            m_activeMob->getViewHash(unitId, patrolId, viewId, pLook);
-            QString hash = QString("%1.%2.%3").arg(unitId).arg(patrolId).arg(viewId);
-            CCreatePatrolCommand* pUndo = new CCreatePatrolCommand(this, hash);
+            CCreatePatrolCommand* pUndo = new CCreatePatrolCommand(this, m_activeMob->logicHandle(pNode));
             m_pUndoStack->push(pUndo);
             bChangeToMove = true;
             break;
         }
         case ePatrolPoint:
         {
-            int unitId(0); //parent unit map id
-            int patrolId(0); //patrol parent id
-            int viewId(-1); //parent view id
-            auto pPoint = dynamic_cast<CPatrolPoint*>(pNode);
-            QString hash;
-            m_activeMob->getPatrolHash(unitId, patrolId, pPoint);
+            SLogicHandle handle = m_activeMob->logicHandle(pNode);
             if(bLookPoint)
-                hash = QString("%1.%2.%3").arg(unitId).arg(patrolId).arg(viewId); // for creating first looking point
-            else
-                hash = QString("%1.%2").arg(unitId).arg(patrolId); // for creating patrol point
+            {
+                handle.type = eLogicHandleView; // for creating first looking point
+                handle.viewId = -1;
+            }
 
-            CCreatePatrolCommand* pUndo = new CCreatePatrolCommand(this, hash);
+            CCreatePatrolCommand* pUndo = new CCreatePatrolCommand(this, handle);
             m_pUndoStack->push(pUndo);
             bChangeToMove = true;
             break;
@@ -2307,8 +2201,7 @@ void CView::addLogicPoint(bool bLookPoint)
                 break; //skip non-path behaviour
             }
 
-            QString hash = QString("%1.%2").arg(pNode->mapId()).arg(-1);
-            CCreatePatrolCommand* pUndo = new CCreatePatrolCommand(this, hash);
+            CCreatePatrolCommand* pUndo = new CCreatePatrolCommand(this, SLogicHandle{eLogicHandlePatrol, pNode->mapId(), -1, -1});
             m_pUndoStack->push(pUndo);
             bChangeToMove = true;
             break;
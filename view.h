@@ -9,6 +9,8 @@
 #include <QTableWidget>
 #include <QTreeWidgetItem>
 #include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
 
 #include "types.h"
 #include "select_window.h"
@@ -23,6 +25,7 @@ class CSettings;
 class CStringItem;
 class QUndoStack;
 struct SParam;
+struct SLandReload;
 class CComboBoxItem;
 class CProgressView;
 class CTableManager;
@@ -35,6 +38,7 @@ class CRoundMobForm;
 class CTreeView;
 class IPropertyBase;
 class CTileForm;
+class CSelectQuery;
 class CPreviewTile;
 class CLandscape;
 
@@ -65,6 +69,7 @@ public:
     void attach(CSettings* pSettings, QTableWidget* pParam, QUndoStack* pStack, CProgressView* pProgress, QLineEdit* pMouseCoord, CTreeView* pTree, CTileForm* pTileForm);
     CSettings* settings() {Q_ASSERT(m_pSettings); return m_pSettings;}
     int select(const SSelect& selectParam, bool bAddToSelect = false);
+    int select(const CSelectQuery& query, bool bAddToSelect = false);
     CMob* mob(QString mobName);
     const QVector<CMob*> mobs() {return m_aMob;}
     void drawSelectFrame(QRect& rect);
@@ -83,6 +88,8 @@ public:
     void deleteSelectedNodes();
     void selectedObjectToClipboardBuffer();
     void clipboradObjectsToScene();
+    void jsonClipboardObjectsToScene();
+    bool readClipboardFile(QVector3D& mousePos, QByteArray& data);
     void hideSelectedNodes();
     void unHideAll();
     CMob* currentMob() {return m_activeMob;}
@@ -110,6 +117,8 @@ public:
     void openMapParameters();
     void pickTile(QVector3D posOnLand, bool bLand = true);
     void setTile(QVector3D posOnLand, bool bLand = true);
+    void fillTileArea(ETileAreaShape shape, const QVector3D& posStart, const QVector3D& posEnd, bool bLand = true);
+    void setTileSpans(const QVector<STileSpan>& arrSpan, const QVector<STileInfo>& arrInfo, bool bLand = true);
     void updatePreviewTile(QVector3D posOnLand, bool bLand = true);
     void addTileRotation(int step);
     void setDrawWater(bool bDraw = true) {m_bDrawWater = bDraw;}
@@ -137,9 +146,10 @@ protected:
 private:
     void initShaders();
     void draw();
-    CNode* pickObject(QList<CNode*>& aNode, int x, int y);
+    CNode* pickObject(int x, int y);
+    QVector<CNode*> pickObjects(const QRect& rect);
+    void cursorRay(QVector3D& origin, QVector3D& dir, int cursorPosX, int cursorPosY);
     void applyParam(SParam& param);
-    void getColorFromRect(const QRect& rect, QVector<SColor>& aColor);
     void onParamChangeLogic(CNode* pNode, const QSharedPointer<IPropertyBase>& prop);
     void logOpenGlData();
     void checkOpenGlError();
@@ -165,6 +175,8 @@ public slots:
     void clearHistory();
     void onMobParamEditFinished(CMobParameters* pMob);
     void checkNewLandVersion();
+    void onLandFileChanged(const QString& path);
+    void onLandReloaded();
 
 signals:
     void updateMsg(QString msg);
@@ -178,6 +190,7 @@ private:
     QSharedPointer<CCamera> m_cam;
     QOpenGLShaderProgram m_program;
     QOpenGLShaderProgram m_landProgram;
+    QOpenGLShaderProgram m_terrainProgram;
     QOpenGLShaderProgram m_selectProgram;
     QMatrix4x4 m_projection;
     QVector<CMob*> m_aMob;
@@ -191,14 +204,20 @@ private:
     QMap<CNode*, QVector3D> m_operationBackup;
     //EOperationType m_operationType;
     QSharedPointer<CSelectFrame> m_selectFrame;
-    QFile m_clipboard_buffer_file;
+    QFile m_clipboard_buffer_file; // json clipboard of previous versions, read only
+    QFile m_clipboardFile; // binary clipboard shared with other editor instances
+    QByteArray m_clipboardData; // selected nodes of the last copy, see CMob::serializeNodes
+    QVector3D m_clipboardMousePos;
+    uint m_clipboardCopyId; // number of the last copy of this instance
+    qint64 m_clipboardTime; // time of the last copy (ms since epoch). Clipboard file is pasted only if its copy is newer
     QFile m_recentOpenedFile_file;
     CMob* m_activeMob;
     CTreeView* m_pTree;
     QList<CMobParameters*> m_arrParamWindow;
     CRoundMobForm* m_pRoundForm;
-    QTimer* m_mprModifyTimer;
-    QDateTime m_lastModifiedLand;
+    QTimer* m_mprModifyTimer; // delays reload until external tool finishes writing of *.mpr
+    QFileSystemWatcher* m_pLandWatcher;
+    QFutureWatcher<SLandReload>* m_pLandReloadWatcher;
     bool m_bDrawLand;
     bool m_bDrawWater;
     bool m_bPreviewTile;